@@ -14,6 +14,8 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 
+#include <sstream>
+
 #include "lib/json.h"
 #include "JsonObjects.h"
 #include "helpers.h"
@@ -65,14 +67,20 @@ JsonObjects::get_field_list_contents(unsigned id) const {
 
 Util::JsonObject*
 JsonObjects::find_object_by_name(Util::JsonArray* array, const cstring& name) {
-    for (auto e : *array) {
-        auto obj = e->to<Util::JsonObject>();
-        auto val = obj->get("name")->to<Util::JsonValue>();
-        if (val != nullptr && val->isString() && val->getString() == name) {
-            return obj;
-        }
+    auto& index = nameIndex[array];
+    if (index.indexed > array->size())
+        index = NameIndex();
+    for (; index.indexed < array->size(); index.indexed++) {
+        auto obj = array->at(index.indexed)->to<Util::JsonObject>();
+        if (obj == nullptr)
+            continue;
+        auto label = obj->get("name");
+        auto val = label ? label->to<Util::JsonValue>() : nullptr;
+        if (val != nullptr && val->isString())
+            index.byName.emplace(val->getString(), obj);
     }
-    return nullptr;
+    auto it = index.byName.find(name);
+    return it == index.byName.end() ? nullptr : it->second;
 }
 
 /// Insert a json array to a parent object under key 'name'.
@@ -325,6 +333,28 @@ JsonObjects::add_parser(const cstring& name) {
     return id;
 }
 
+void
+JsonObjects::end_parser(unsigned id) {
+    auto it = map_parser.find(id);
+    if (it == map_parser.end())
+        BUG("parser %1% not found.", id);
+    if (!streaming)
+        return;
+    // The parser and its states are not modified any more.
+    auto parser = it->second;
+    for (auto state : *parser->get("parse_states")->to<Util::JsonArray>())
+        map_parser_state.erase(state->to<Util::JsonObject>()->get("id")
+                               ->to<Util::JsonValue>()->getInt());
+    map_parser.erase(it);
+    for (auto& element : *parsers) {
+        if (element == parser) {
+            element = new Util::JsonText(parser);
+            return;
+        }
+    }
+    BUG("parser %1% not in the parsers array", id);
+}
+
 /// insert parser state into a parser identified by parser_id
 /// return the id of the parser state
 unsigned
@@ -400,16 +430,50 @@ unsigned
 JsonObjects::add_action(const cstring& name, Util::JsonArray*& params, Util::JsonArray*& body) {
     CHECK_NULL(params);
     CHECK_NULL(body);
-    auto action = new Util::JsonObject();
-    action->emplace("name", name);
     unsigned id = BMV2::nextId("actions");
-    action->emplace("id", id);
-    action->emplace("runtime_data", params);
-    action->emplace("primitives", body);
-    actions->append(action);
+    if (!streaming) {
+        auto action = new Util::JsonObject();
+        action->emplace("name", name);
+        action->emplace("id", id);
+        action->emplace("runtime_data", params);
+        action->emplace("primitives", body);
+        actions->append(action);
+        return id;
+    }
+    // Actions are never modified once added, so they are rendered right
+    // away and only their text is kept.
+    std::ostringstream text;
+    {
+        Util::JsonWriter writer(text);
+        writer.beginObject()
+              .key("name").value(name)
+              .key("id").value(id)
+              .key("runtime_data").value(params)
+              .key("primitives").value(body)
+              .endObject();
+    }
+    actions->append(new Util::JsonText(text.str()));
     return id;
 }
 
+void
+JsonObjects::add_pipeline(Util::JsonObject* pipeline) {
+    CHECK_NULL(pipeline);
+    if (streaming)
+        pipelines->append(new Util::JsonText(pipeline));
+    else
+        pipelines->append(pipeline);
+}
+
+void
+JsonObjects::add_deparser(Util::JsonObject* deparser) {
+    CHECK_NULL(deparser);
+    if (streaming)
+        deparsers->append(new Util::JsonText(deparser));
+    else
+        deparsers->append(deparser);
+}
+
 void
 JsonObjects::add_extern_attribute(const cstring& name, const cstring& type,
                                   const cstring& value, Util::JsonArray* attributes) {
@@ -18,15 +18,25 @@ limitations under the License.
 #define BACKENDS_BMV2_COMMON_JSONOBJECTS_H_
 
 #include <map>
+#include <unordered_map>
 #include "lib/json.h"
 #include "lib/ordered_map.h"
 
 namespace BMV2 {
 
 class JsonObjects {
+    /// Index of the objects in an array by their "name" field.
+    struct NameIndex {
+        size_t indexed = 0;  // number of array elements in byName
+        std::unordered_map<cstring, Util::JsonObject*> byName;
+    };
+    std::unordered_map<const Util::JsonArray*, NameIndex> nameIndex;
+
  public:
-    static Util::JsonObject* find_object_by_name(Util::JsonArray* array,
-                                                 const cstring& name);
+    /// First object in @p array whose "name" is @p name.  Arrays are only
+    /// appended to during conversion, so each lookup only indexes the
+    /// elements appended since the previous one.
+    Util::JsonObject* find_object_by_name(Util::JsonArray* array, const cstring& name);
 
     void add_program_info(const cstring& name);
     void add_meta_info();
@@ -45,6 +55,8 @@ class JsonObjects {
     void add_enum(const cstring& enum_name, const cstring& entry_name,
                   const unsigned entry_value);
     unsigned add_parser(const cstring& name);
+    /// Called when all the states of the parser @p id have been added.
+    void end_parser(unsigned id);
     unsigned add_parser_state(const unsigned id, const cstring& state_name);
     void add_parser_transition(const unsigned id, Util::IJson* transition);
     void add_parser_op(const unsigned id, Util::IJson* op);
@@ -52,10 +64,17 @@ class JsonObjects {
     void add_parse_vset(const cstring& name, const unsigned bitwidth,
                         const big_int& size);
     unsigned add_action(const cstring& name, Util::JsonArray*& params, Util::JsonArray*& body);
+    void add_pipeline(Util::JsonObject* pipeline);
+    void add_deparser(Util::JsonObject* deparser);
     void add_extern_attribute(const cstring& name, const cstring& type,
                               const cstring& value, Util::JsonArray* attributes);
     void add_extern(const cstring& name, const cstring& type, Util::JsonArray* attributes);
     JsonObjects();
+    /// If true, actions, parsers, pipelines, deparsers and table entries are
+    /// rendered to text as soon as they are complete, so the tree of JSON
+    /// objects for each of them can be collected.  The output is the same
+    /// either way.
+    bool streaming = true;
     Util::JsonArray* insert_array_field(Util::JsonObject* parent, cstring name);
     Util::JsonArray* append_array(Util::JsonArray* parent);
     Util::JsonArray* create_parameters(Util::JsonObject* object);
@@ -196,7 +196,7 @@ void ActionConverter::convertActionBody(const IR::Vector<IR::StatOrDecl>* body,
 void
 ActionConverter::convertActionParams(const IR::ParameterList *parameters,
                                      Util::JsonArray* params) {
-    for (auto p : *parameters->getEnumerator()) {
+    for (auto p : *parameters) {
         if (!ctxt->refMap->isUsed(p))
             warn(ErrorType::WARN_UNUSED, "Unused action parameter %1%", p);
 
@@ -64,6 +64,7 @@ class Backend {
         refMap(refMap), typeMap(typeMap), enumMap(enumMap),
         corelib(P4::P4CoreLibrary::instance), json(new BMV2::JsonObjects()) {
         refMap->setIsV1(options.isv1());
+        json->streaming = !options.jsonTree;
         }
     void serialize(std::ostream& out) const { json->toplevel->serialize(out); }
     virtual void convert(const IR::ToplevelBlock* block) = 0;
@@ -17,6 +17,8 @@ limitations under the License.
 #ifndef BACKENDS_BMV2_COMMON_CONTROL_H_
 #define BACKENDS_BMV2_COMMON_CONTROL_H_
 
+#include <sstream>
+
 #include "ir/ir.h"
 #include "lib/json.h"
 #include "controlFlowGraph.h"
@@ -437,7 +439,42 @@ class ControlConverter : public Inspector {
         auto entriesList = table->getEntries();
         if (entriesList == nullptr) return;
 
-        auto entries = mkArrayField(jsonTable, "entries");
+        // The width and match type of each key, and the values used for
+        // don't care keys, are the same for all entries: compute them once
+        // per table rather than once per entry.
+        struct KeyColumn {
+            int width;
+            int k8;
+            cstring matchType;
+            cstring zero;
+            cstring fullMask;
+            cstring rangeEnd;
+        };
+        std::vector<KeyColumn> keyColumns;
+        for (auto tableKey : table->getKey()->keyElements) {
+            KeyColumn column;
+            column.width = tableKey->expression->type->width_bits();
+            column.k8 = ROUNDUP(column.width, 8);
+            column.matchType = getKeyMatchType(tableKey);
+            column.zero = stringRepr(0, column.k8);
+            if (column.matchType == corelib.ternaryMatch.name || column.matchType == "optional")
+                column.fullMask = stringRepr(Util::mask(column.width), column.k8);
+            if (column.matchType == "range")
+                column.rangeEnd = stringRepr((1 << column.width)-1, column.k8);  // 2^N -1
+            keyColumns.push_back(column);
+        }
+
+        // When streaming, each entry is rendered as soon as it is converted,
+        // so the JSON objects of only one entry exist at any time.
+        Util::JsonArray* entries = nullptr;
+        std::ostringstream text;
+        Util::JsonWriter writer(text);
+        if (ctxt->json->streaming) {
+            writer.beginArray(entriesList->entries.empty());
+        } else {
+            entries = mkArrayField(jsonTable, "entries");
+            entries->reserve(entriesList->entries.size());
+        }
         int entryPriority = 1;  // default priority is defined by index position
         for (auto e : entriesList->entries) {
             auto entry = new Util::JsonObject();
@@ -445,13 +482,14 @@ class ControlConverter : public Inspector {
 
             auto keyset = e->getKeys();
             auto matchKeys = mkArrayField(entry, "match_key");
+            matchKeys->reserve(keyset->components.size());
             int keyIndex = 0;
             for (auto k : keyset->components) {
                 auto key = new Util::JsonObject();
-                auto tableKey = table->getKey()->keyElements.at(keyIndex);
-                auto keyWidth = tableKey->expression->type->width_bits();
-                auto k8 = ROUNDUP(keyWidth, 8);
-                auto matchType = getKeyMatchType(tableKey);
+                auto& column = keyColumns.at(keyIndex);
+                auto keyWidth = column.width;
+                auto k8 = column.k8;
+                auto matchType = column.matchType;
                 // Table key fields with match_kind optional will be
                 // represented in the BMv2 JSON file the same as a ternary
                 // field would be.
@@ -477,10 +515,10 @@ class ControlConverter : public Inspector {
                         key->emplace("mask", stringRepr(km->right->to<IR::Constant>()->value, k8));
                     } else if (k->is<IR::Constant>()) {
                         key->emplace("key", stringRepr(k->to<IR::Constant>()->value, k8));
-                        key->emplace("mask", stringRepr(Util::mask(keyWidth), k8));
+                        key->emplace("mask", column.fullMask);
                     } else if (k->is<IR::DefaultExpression>()) {
-                        key->emplace("key", stringRepr(0, k8));
-                        key->emplace("mask", stringRepr(0, k8));
+                        key->emplace("key", column.zero);
+                        key->emplace("mask", column.zero);
                     } else {
                         ::error(ErrorType::ERR_UNSUPPORTED,
                                 "%1%: unsupported ternary key expression", k);
@@ -504,7 +542,7 @@ class ControlConverter : public Inspector {
                         key->emplace("key", stringRepr(k->to<IR::Constant>()->value, k8));
                         key->emplace("prefix_length", keyWidth);
                     } else if (k->is<IR::DefaultExpression>()) {
-                        key->emplace("key", stringRepr(0, k8));
+                        key->emplace("key", column.zero);
                         key->emplace("prefix_length", 0);
                     } else {
                         ::error(ErrorType::ERR_UNSUPPORTED,
@@ -519,8 +557,8 @@ class ControlConverter : public Inspector {
                         key->emplace("start", stringRepr(k->to<IR::Constant>()->value, k8));
                         key->emplace("end", stringRepr(k->to<IR::Constant>()->value, k8));
                     } else if (k->is<IR::DefaultExpression>()) {
-                        key->emplace("start", stringRepr(0, k8));
-                        key->emplace("end", stringRepr((1 << keyWidth)-1, k8));  // 2^N -1
+                        key->emplace("start", column.zero);
+                        key->emplace("end", column.rangeEnd);
                     } else {
                         ::error(ErrorType::ERR_UNSUPPORTED,
                                 "%1% unsupported range key expression", k);
@@ -535,10 +573,10 @@ class ControlConverter : public Inspector {
                     // default), no &&& expression.
                     if (k->is<IR::Constant>()) {
                         key->emplace("key", stringRepr(k->to<IR::Constant>()->value, k8));
-                        key->emplace("mask", stringRepr(Util::mask(keyWidth), k8));
+                        key->emplace("mask", column.fullMask);
                     } else if (k->is<IR::DefaultExpression>()) {
-                        key->emplace("key", stringRepr(0, k8));
-                        key->emplace("mask", stringRepr(0, k8));
+                        key->emplace("key", column.zero);
+                        key->emplace("mask", column.zero);
                     } else {
                         ::error(ErrorType::ERR_UNSUPPORTED,
                                 "%1%: unsupported optional key expression", k);
@@ -584,7 +622,14 @@ class ControlConverter : public Inspector {
             }
             entryPriority += 1;
 
-            entries->append(entry);
+            if (entries != nullptr)
+                entries->append(entry);
+            else
+                writer.value(entry);
+        }
+        if (entries == nullptr) {
+            writer.endArray().flush();
+            jsonTable->emplace("entries", new Util::JsonText(text.str()));
         }
     }
     cstring getKeyMatchType(const IR::KeyElement *ke) {
@@ -830,7 +875,7 @@ class ControlConverter : public Inspector {
             P4C_UNIMPLEMENTED("%1%: not yet handled", c);
         }
 
-        ctxt->json->pipelines->append(result);
+        ctxt->json->add_pipeline(result);
         return false;
     }
 
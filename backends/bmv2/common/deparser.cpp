@@ -146,7 +146,7 @@ Util::IJson* DeparserConverter::convertDeparser(const IR::P4Control* ctrl) {
 
 bool DeparserConverter::preorder(const IR::P4Control* control) {
     auto deparserJson = convertDeparser(control);
-    ctxt->json->deparsers->append(deparserJson);
+    ctxt->json->add_deparser(deparserJson);
     for (auto c : control->controlLocals) {
         if (c->is<IR::Declaration_Constant>() ||
             c->is<IR::Declaration_Variable>() ||
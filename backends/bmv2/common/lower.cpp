@@ -53,6 +53,7 @@ const IR::Node* LowerExpressions::postorder(IR::Neg* expression) {
     auto zero = new IR::Constant(type, 0);
     auto sub = new IR::Sub(expression->srcInfo, zero, expression->expr);
     typeMap->setType(zero, type);
+    typeMap->setCompileTimeConstant(zero);
     typeMap->setType(sub, type);
     LOG3("Replaced " << expression << " with " << sub);
     return sub;
@@ -67,6 +68,7 @@ const IR::Node* LowerExpressions::postorder(IR::Cast* expression) {
         auto cmp = new IR::Neq(expression->srcInfo, expression->expr, zero);
         typeMap->setType(cmp, destType);
         typeMap->setType(zero, srcType);
+        typeMap->setCompileTimeConstant(zero);
         LOG3("Replaced " << expression << " with " << cmp);
         return cmp;
     } else if (destType->is<IR::Type_Bits>() && srcType->is<IR::Type_Boolean>()) {
@@ -78,6 +80,8 @@ const IR::Node* LowerExpressions::postorder(IR::Cast* expression) {
         typeMap->setType(mux, destType);
         typeMap->setType(one, destType);
         typeMap->setType(zero, destType);
+        typeMap->setCompileTimeConstant(one);
+        typeMap->setCompileTimeConstant(zero);
         LOG3("Replaced " << expression << " with " << mux);
         return mux;
     } else if (destType->width_bits() < srcType->width_bits()) {
@@ -94,6 +98,10 @@ const IR::Node* LowerExpressions::postorder(IR::Cast* expression) {
         typeMap->setType(mask, srcType);
         typeMap->setType(and0, srcType);
         typeMap->setType(cast0, destType);
+        typeMap->setCompileTimeConstant(one);
+        typeMap->setCompileTimeConstant(shift_value);
+        typeMap->setCompileTimeConstant(shl);
+        typeMap->setCompileTimeConstant(mask);
         LOG3("Replaced " << expression << " with " << cast0);
         return cast0;
     }
@@ -30,6 +30,8 @@ class BMV2Options : public CompilerOptions {
     cstring outputFile = nullptr;
     // read from json
     bool loadIRFromJson = false;
+    // keep the whole output JSON as a tree until it is written
+    bool jsonTree = false;
 
     BMV2Options() {
         registerOption("--emit-externs", nullptr,
@@ -41,8 +43,13 @@ class BMV2Options : public CompilerOptions {
                 "Write output to outfile");
         registerOption("--fromJSON", "file",
                 [this](const char* arg) { loadIRFromJson = true; file = arg; return true; },
-                "Use IR representation from JsonFile dumped previously,"\
+                "Use IR representation from JsonFile (or IR snapshot) dumped previously,"\
                 "the compilation starts with reduced midEnd.");
+        registerOption("--json-tree", nullptr,
+                [this](const char*) { jsonTree = true; return true; },
+                "[BMv2 back-end] Keep the JSON objects of the whole output until it is\n"
+                "written, instead of rendering each action, parser and pipeline as soon\n"
+                "as it is converted.  The output is the same.");
     }
 };
 
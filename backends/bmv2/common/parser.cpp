@@ -615,6 +615,7 @@ bool ParserConverter::preorder(const IR::P4Parser* parser) {
         }
         // P4C_UNIMPLEMENTED("%1%: not yet handled", c);
     }
+    ctxt->json->end_parser(parser_id);
     return false;
 }
 
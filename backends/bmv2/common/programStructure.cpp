@@ -21,7 +21,7 @@ namespace BMV2 {
 void DiscoverStructure::postorder(const IR::ParameterList *paramList) {
     bool inAction = findContext<IR::P4Action>() != nullptr;
     unsigned index = 0;
-    for (auto p : *paramList->getEnumerator()) {
+    for (auto p : *paramList) {
         structure->index.emplace(p, index);
         if (!inAction)
             structure->nonActionParameters.emplace(p);
@@ -21,6 +21,7 @@ limitations under the License.
 #include "ir/ir.h"
 #include "control-plane/p4RuntimeSerializer.h"
 #include "frontends/common/applyOptionsPragmas.h"
+#include "frontends/common/compileServer.h"
 #include "frontends/common/parseInput.h"
 #include "frontends/p4/frontend.h"
 #include "lib/error.h"
@@ -36,9 +37,7 @@ limitations under the License.
 #include "ir/json_loader.h"
 #include "fstream"
 
-int main(int argc, char *const argv[]) {
-    setup_gc_logging();
-
+static int compileMain(int argc, char *const argv[]) {
     AutoCompileContext autoPsaSwitchContext(new BMV2::PsaSwitchContext);
     auto& options = BMV2::PsaSwitchContext::get().options();
     options.langVersion = CompilerOptions::FrontendVersion::P4_16;
@@ -107,6 +106,8 @@ int main(int argc, char *const argv[]) {
             return 1;
         if (options.dumpJsonFile)
             JSONGenerator(*openFile(options.dumpJsonFile, true), true) << program << std::endl;
+        if (options.dumpIRSnapshotFile)
+            writeIRSnapshot(*openFile(options.dumpIRSnapshotFile, true), program);
     } catch (const std::exception &bug) {
         std::cerr << bug.what() << std::endl;
         return 1;
@@ -138,3 +139,12 @@ int main(int argc, char *const argv[]) {
 
     return ::errorCount() > 0;
 }
+
+int main(int argc, char *const argv[]) {
+    setup_gc_logging();
+
+    if (P4::CompileServer::requested(argc, argv))
+        return P4::CompileServer::serve(argc, argv, compileMain,
+                                        {{"core.p4", "bmv2/psa.p4"}}, BMV2_PSA_VERSION_STRING);
+    return compileMain(argc, argv);
+}
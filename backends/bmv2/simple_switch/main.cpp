@@ -21,6 +21,7 @@ limitations under the License.
 #include "ir/ir.h"
 #include "control-plane/p4RuntimeSerializer.h"
 #include "frontends/common/applyOptionsPragmas.h"
+#include "frontends/common/compileServer.h"
 #include "frontends/common/parseInput.h"
 #include "frontends/p4/frontend.h"
 #include "lib/error.h"
@@ -36,9 +37,7 @@ limitations under the License.
 #include "ir/json_loader.h"
 #include "fstream"
 
-int main(int argc, char *const argv[]) {
-    setup_gc_logging();
-
+static int compileMain(int argc, char *const argv[]) {
     AutoCompileContext autoBMV2Context(new BMV2::SimpleSwitchContext);
     auto& options = BMV2::SimpleSwitchContext::get().options();
     options.langVersion = CompilerOptions::FrontendVersion::P4_16;
@@ -79,19 +78,11 @@ int main(int argc, char *const argv[]) {
         if (program == nullptr || ::errorCount() > 0)
             return 1;
     } else {
-        std::filebuf fb;
-        if (fb.open(options.file, std::ios::in) == nullptr) {
-            ::error(ErrorType::ERR_IO, "%s: No such file or directory.", options.file);
+        auto json = loadJsonFile(options.file);
+        if (json == nullptr)
             return 1;
-        }
-        std::istream inJson(&fb);
-        JSONLoader jsonFileLoader(inJson);
-        if (jsonFileLoader.json == nullptr) {
-            ::error(ErrorType::ERR_IO, "%s: Not valid json input file", options.file);
-            return 1;
-        }
+        JSONLoader jsonFileLoader(json);
         program = new IR::P4Program(jsonFileLoader);
-        fb.close();
     }
 
     P4::serializeP4RuntimeIfRequired(program, options);
@@ -107,6 +98,8 @@ int main(int argc, char *const argv[]) {
             return 1;
         if (options.dumpJsonFile && !options.loadIRFromJson)
             JSONGenerator(*openFile(options.dumpJsonFile, true), true) << program << std::endl;
+        if (options.dumpIRSnapshotFile && !options.loadIRFromJson)
+            writeIRSnapshot(*openFile(options.dumpIRSnapshotFile, true), program);
     } catch (const std::exception &bug) {
         std::cerr << bug.what() << std::endl;
         return 1;
@@ -138,3 +131,12 @@ int main(int argc, char *const argv[]) {
 
     return ::errorCount() > 0;
 }
+
+int main(int argc, char *const argv[]) {
+    setup_gc_logging();
+
+    if (P4::CompileServer::requested(argc, argv))
+        return P4::CompileServer::serve(argc, argv, compileMain, {{"core.p4", "v1model.p4"}},
+                                        BMV2_SIMPLESWITCH_VERSION_STRING);
+    return compileMain(argc, argv);
+}
@@ -726,7 +726,7 @@ void ExternConverter_action_profile::convertExternInstance(
     cstring name = inst->controlPlaneName();
     // Might call this multiple times if the selector/profile is used more than
     // once in a pipeline, so only add it to the action_profiles once
-    if (BMV2::JsonObjects::find_object_by_name(ctxt->action_profiles, name))
+    if (ctxt->json->find_object_by_name(ctxt->action_profiles, name))
         return;
     auto action_profile = new Util::JsonObject();
     action_profile->emplace("name", name);
@@ -785,7 +785,7 @@ void ExternConverter_action_selector::convertExternInstance(
     cstring name = inst->controlPlaneName();
     // Might call this multiple times if the selector/profile is used more than
     // once in a pipeline, so only add it to the action_profiles once
-    if (BMV2::JsonObjects::find_object_by_name(ctxt->action_profiles, name))
+    if (ctxt->json->find_object_by_name(ctxt->action_profiles, name))
         return;
     auto action_profile = new Util::JsonObject();
     action_profile->emplace("name", name);
@@ -48,6 +48,19 @@ void DpdkBackend::convert(const IR::ToplevelBlock *tlb) {
     auto convertToDpdk = new ConvertToDpdkProgram(refMap, typeMap, &structure, options);
     auto genContextJson = new DpdkContextGenerator(refMap, typeMap, &structure, options);
 
+    // The passes below do not update the type map themselves.  Where they
+    // change the types of existing declarations (typedefs, the metadata and
+    // header structs, action parameters) the map is cleared and the program
+    // type-checked again from scratch.  Only the other rounds are incremental:
+    // TypeChecking keeps the types of the nodes that did not change and infers
+    // the types of the new ones.  --verifyTypeMap compares the map after those
+    // rounds with a full type check; the dpdk-verify-type-map tests run it.
+    auto verifyTypeMap = [this]() -> Visitor* {
+        if (!options.verifyTypeMap)
+            return nullptr;
+        return new P4::VerifyTypeMap(refMap, typeMap);
+    };
+
     PassManager simplify = {
         new DpdkArchFirst(),
         new P4::EliminateTypedef(refMap, typeMap),
@@ -59,6 +72,7 @@ void DpdkBackend::convert(const IR::ToplevelBlock *tlb) {
                 new P4::OrPolicy(new P4::IsValid(refMap, typeMap),
                                  new P4::IsMask())),
         new P4::TypeChecking(refMap, typeMap),
+        verifyTypeMap(),
         // TBD: implement dpdk lowering passes instead of reusing bmv2's lowering pass.
         new PassRepeated({new BMV2::LowerExpressions(typeMap, DPDK_MAX_SHIFT_AMOUNT)}, 2),
         new P4::RemoveComplexExpressions(refMap, typeMap,
@@ -67,6 +81,7 @@ void DpdkBackend::convert(const IR::ToplevelBlock *tlb) {
         new P4::ConstantFolding(refMap, typeMap, false),
         new ElimHeaderCopy(typeMap),
         new P4::TypeChecking(refMap, typeMap),
+        verifyTypeMap(),
         new P4::RemoveAllUnusedDeclarations(refMap),
         new ConvertActionSelectorAndProfile(refMap, typeMap, &structure),
         new CollectTableInfo(&structure),
@@ -77,16 +92,17 @@ void DpdkBackend::convert(const IR::ToplevelBlock *tlb) {
         new CollectMetadataHeaderInfo(&structure),
         new ConvertLookahead(refMap, typeMap, &structure),
         new P4::TypeChecking(refMap, typeMap),
+        verifyTypeMap(),
         new ConvertToDpdkArch(refMap, &structure),
         new InjectJumboStruct(&structure),
         new InjectOutputPortMetadataField(&structure),
         new P4::ClearTypeMap(typeMap),
         new P4::TypeChecking(refMap, typeMap, true),
-        new P4::ResolveReferences(refMap),
+        // Only introduce temporaries of existing types
         new StatementUnroll(refMap, &structure),
         new IfStatementUnroll(refMap, &structure),
-        new P4::ClearTypeMap(typeMap),
         new P4::TypeChecking(refMap, typeMap, true),
+        verifyTypeMap(),
         new ConvertBinaryOperationTo2Params(refMap),
         new CollectProgramStructure(refMap, typeMap, &structure),
         new CopyMatchKeysToSingleStruct(refMap, typeMap, &invokedInKey, &structure),
@@ -106,14 +122,9 @@ void DpdkBackend::convert(const IR::ToplevelBlock *tlb) {
         new TypeWidthValidator(),
         new DpdkArchLast(),
         new VisitFunctor([this, genContextJson] {
-            // Serialize context json object into user specified file
-            if (!options.ctxtFile.isNullOrEmpty()) {
-                std::ostream *out = openFile(options.ctxtFile, false);
-                if (out != nullptr) {
-                    genContextJson->serializeContextJson(out);
-                }
-                out->flush();
-            }
+            // The context json is written once the metadata layout is known
+            if (!options.ctxtFile.isNullOrEmpty())
+                genContextJson->generateContextJson();
         }),
         new ReplaceHdrMetaField(typeMap, refMap, &structure),
         // convert to assembly program
@@ -121,10 +132,23 @@ void DpdkBackend::convert(const IR::ToplevelBlock *tlb) {
     };
     simplify.addDebugHook(hook, true);
     program = program->apply(simplify);
+    auto writeContextJson = [this, genContextJson]() {
+        // Serialize context json object into user specified file
+        if (!options.ctxtFile.isNullOrEmpty() && genContextJson->generated()) {
+            std::ostream *out = openFile(options.ctxtFile, false);
+            if (out != nullptr) {
+                genContextJson->serializeContextJson(out);
+                out->flush();
+            }
+        }
+    };
     ordered_set<cstring> used_fields;
+    MetadataLayout layout;
     dpdk_program = convertToDpdk->getDpdkProgram();
-    if (!dpdk_program)
+    if (!dpdk_program) {
+        writeContextJson();
         return;
+    }
     if (structure.p4arch == "pna") {
         PassManager post_code_gen = {
             new PrependPassRecircId(),
@@ -137,13 +161,19 @@ void DpdkBackend::convert(const IR::ToplevelBlock *tlb) {
         new EliminateUnusedAction(),
         new DpdkAsmOptimization,
         new CopyPropagationAndElimination(typeMap),
+        options.optimizeInstructions ? new GlobalAsmOptimization(&structure) : nullptr,
+        options.optimizeInstructions ? new DpdkAsmOptimization : nullptr,
         new CollectUsedMetadataField(used_fields),
         new RemoveUnusedMetadataFields(used_fields),
+        options.optimizeMetadataLayout ? new OptimizeMetadataLayout(layout) : nullptr,
         new ValidateTableKeys(),
         new ShortenTokenLength(),
     };
 
     dpdk_program = dpdk_program->apply(post_code_gen)->to<IR::DpdkAsmProgram>();
+    if (options.optimizeMetadataLayout)
+        genContextJson->addMetadataLayout(dpdk_program, layout);
+    writeContextJson();
 }
 
 void DpdkBackend::codegen(std::ostream &out) const {
@@ -1396,6 +1396,7 @@ const IR::Node* DismantleMuxExpressions::preorder(IR::Mux* expression) {
     visit(expression->e1);
     auto path1 = addAssignment(expression->srcInfo, tmp, expression->e1);
     typeMap->setType(path1, type);
+    typeMap->setLeftValue(path1);
     auto ifTrue = statements;
 
     statements.clear();
@@ -1408,6 +1409,7 @@ const IR::Node* DismantleMuxExpressions::preorder(IR::Mux* expression) {
         expression->e0, new IR::BlockStatement(ifTrue), new IR::BlockStatement(ifFalse));
     statements.push_back(ifStatement);
     typeMap->setType(path2, type);
+    typeMap->setLeftValue(path2);
     prune();
     return path2;
 }
@@ -14,8 +14,10 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 
+#include <algorithm>
 #include "dpdkAsmOpt.h"
 #include "dpdkUtils.h"
+#include "lib/bitvec.h"
 
 namespace DPDK {
 // The assumption is compiler can only produce forward jumps.
@@ -264,6 +266,248 @@ bool ValidateTableKeys::preorder(const IR::DpdkAsmProgram *p) {
     return false;
 }
 
+namespace {
+// Returns the name of the metadata field @e refers to, or nullptr.
+cstring metadataFieldName(const IR::Expression *e) {
+    if (auto m = e ? e->to<IR::Member>() : nullptr)
+        if (m->expr->toString() == "m")
+            return m->member.name;
+    return nullptr;
+}
+
+// Counts the references to each metadata field in instructions and table keys
+class CountMetadataAccesses : public Inspector {
+    std::map<cstring, unsigned>& accesses;
+ public:
+    explicit CountMetadataAccesses(std::map<cstring, unsigned>& accesses)
+        : accesses(accesses) {}
+    bool preorder(const IR::Member *m) override {
+        if (auto name = metadataFieldName(m))
+            accesses[name]++;
+        return true;
+    }
+};
+
+// Bits spanned by the metadata fields in @keys with the given field offsets,
+// holes included; 0 if there are none.
+int keySpanBits(const IR::Key *keys, const std::map<cstring, int>& offsets,
+                const std::map<cstring, int>& widths) {
+    int min = -1, max = -1;
+    if (keys) {
+        for (auto key : keys->keyElements) {
+            auto name = metadataFieldName(key->expression);
+            if (!name || !offsets.count(name))
+                continue;
+            int start = offsets.at(name), end = start + widths.at(name);
+            if (min == -1 || start < min) min = start;
+            if (max == -1 || end > max) max = end;
+        }
+    }
+    return max - min;
+}
+}  // namespace
+
+const IR::Node* OptimizeMetadataLayout::preorder(IR::DpdkAsmProgram *p) {
+    prune();
+    CountMetadataAccesses countAccesses(layout.accesses);
+    countAccesses.setCalledBy(this);
+    p->apply(countAccesses);
+
+    const IR::DpdkStructType *metaStruct = nullptr;
+    for (auto st : p->structType) {
+        if (isMetadataStruct(st)) {
+            metaStruct = st;
+            break;
+        }
+    }
+    if (!metaStruct)
+        return p;
+    auto& fields = metaStruct->fields;
+
+    std::map<cstring, size_t> position;
+    std::vector<int> width;
+    for (auto field : fields) {
+        int w = ValidateTableKeys::getFieldSizeBits(field->type);
+        if (w < 0) {
+            LOG1("Keeping the metadata layout: unexpected type of " << field);
+            return p;
+        }
+        position.emplace(field->name.name, width.size());
+        width.push_back(w);
+    }
+
+    // Ranges of fields (by position) that must stay contiguous and in order
+    std::vector<std::pair<size_t, size_t>> ranges;
+    forAllMatching<IR::DpdkLearnStatement>(p, [&](const IR::DpdkLearnStatement *l) {
+        auto name = metadataFieldName(l->argument);
+        if (!name || !position.count(name))
+            return;
+        // DPDK copies the arguments of the learned action from the metadata,
+        // starting at the given field, in the layout of the argument struct.
+        int argBits = 0;
+        for (auto action : p->actions) {
+            if (action->name.name != l->action)
+                continue;
+            for (auto param : action->para.parameters) {
+                auto typeName = param->type->to<IR::Type_Name>();
+                if (!typeName)
+                    continue;
+                for (auto st : p->structType)
+                    if (st->name == typeName->path->name)
+                        for (auto f : st->fields)
+                            argBits += ValidateTableKeys::getFieldSizeBits(f->type);
+            }
+        }
+        size_t first = position.at(name), last = first;
+        for (int bits = width[first]; bits < argBits && last + 1 < fields.size(); )
+            bits += width[++last];
+        ranges.emplace_back(first, last);
+    });
+    forAllMatching<IR::DpdkGetHashStatement>(p, [&](const IR::DpdkGetHashStatement *h) {
+        auto list = h->fields->to<IR::ListExpression>();
+        if (!list || list->components.empty())
+            return;
+        auto first = metadataFieldName(list->components.front());
+        auto last = metadataFieldName(list->components.back());
+        if (first && last && position.count(first) && position.count(last))
+            ranges.emplace_back(std::min(position.at(first), position.at(last)),
+                                std::max(position.at(first), position.at(last)));
+    });
+
+    // Group the fields into units that are placed as a whole
+    std::vector<std::vector<size_t>> units;
+    std::vector<int> unitOf(fields.size(), -1);
+    std::sort(ranges.begin(), ranges.end());
+    for (auto range : ranges) {
+        if (!units.empty() && unitOf[range.first] != -1) {
+            // Overlaps the previous range
+            for (auto i = units.back().back() + 1; i <= range.second; i++) {
+                units.back().push_back(i);
+                unitOf[i] = units.size() - 1;
+            }
+            continue;
+        }
+        units.emplace_back();
+        for (auto i = range.first; i <= range.second; i++) {
+            units.back().push_back(i);
+            unitOf[i] = units.size() - 1;
+        }
+    }
+    auto groupKeys = [&](const IR::Key *keys) {
+        if (!keys)
+            return;
+        int current = -1;
+        for (auto key : keys->keyElements) {
+            auto name = metadataFieldName(key->expression);
+            if (!name || !position.count(name))
+                continue;
+            auto pos = position.at(name);
+            if (current == -1) {
+                units.emplace_back();
+                current = units.size() - 1;
+            }
+            if (unitOf[pos] == current)
+                continue;
+            if (unitOf[pos] == -1) {
+                units[current].push_back(pos);
+                unitOf[pos] = current;
+            } else {
+                // Already placed with other keys or in a range: take the whole unit along
+                auto other = unitOf[pos];
+                for (auto i : units[other]) {
+                    units[current].push_back(i);
+                    unitOf[i] = current;
+                }
+                units[other].clear();
+            }
+        }
+    };
+    for (auto tbl : p->tables)
+        groupKeys(tbl->match_keys);
+    for (auto learner : p->learners)
+        groupKeys(learner->match_keys);
+    for (auto sel : p->selectors)
+        groupKeys(sel->selectors);
+    for (size_t i = 0; i < fields.size(); i++) {
+        if (unitOf[i] == -1) {
+            units.push_back({i});
+            unitOf[i] = units.size() - 1;
+        }
+    }
+
+    // Hottest units (in accesses per bit) first; otherwise as they were
+    struct Unit {
+        std::vector<size_t> fields;
+        size_t first;
+        double heat;
+    };
+    std::vector<Unit> sorted;
+    for (auto& unit : units) {
+        if (unit.empty())
+            continue;
+        unsigned accesses = 0;
+        int bits = 0;
+        for (auto i : unit) {
+            accesses += layout.accesses[fields[i]->name.name];
+            bits += width[i];
+        }
+        sorted.push_back({unit, *std::min_element(unit.begin(), unit.end()),
+                          bits ? static_cast<double>(accesses) / bits : 0});
+    }
+    std::sort(sorted.begin(), sorted.end(),
+              [](const Unit& a, const Unit& b) { return a.first < b.first; });
+    std::stable_sort(sorted.begin(), sorted.end(),
+                     [](const Unit& a, const Unit& b) { return a.heat > b.heat; });
+
+    IR::IndexedVector<IR::StructField> newFields;
+    std::map<cstring, int> oldOffsets, newOffsets, widths;
+    int offset = 0;
+    for (size_t i = 0; i < fields.size(); i++) {
+        oldOffsets.emplace(fields[i]->name.name, offset);
+        widths.emplace(fields[i]->name.name, width[i]);
+        offset += width[i];
+    }
+    offset = 0;
+    for (auto& unit : sorted) {
+        for (auto i : unit.fields) {
+            newFields.push_back(fields[i]);
+            newOffsets.emplace(fields[i]->name.name, offset);
+            offset += width[i];
+        }
+    }
+
+    auto fits = [&](const IR::Key *keys) {
+        return keySpanBits(keys, newOffsets, widths) <= DPDK_TABLE_MAX_KEY_SIZE ||
+               keySpanBits(keys, oldOffsets, widths) > DPDK_TABLE_MAX_KEY_SIZE;
+    };
+    for (auto tbl : p->tables) {
+        if (!fits(tbl->match_keys)) {
+            LOG1("Keeping the metadata layout: keys of " << tbl->name << " would not fit");
+            return p;
+        }
+    }
+    for (auto learner : p->learners) {
+        if (!fits(learner->match_keys)) {
+            LOG1("Keeping the metadata layout: keys of " << learner->name << " would not fit");
+            return p;
+        }
+    }
+
+    if (LOGGING(2)) {
+        for (auto field : newFields)
+            LOG2("Metadata field " << field->name << " at bit " << newOffsets[field->name.name]
+                 << ", " << layout.accesses[field->name.name] << " accesses");
+    }
+    IR::IndexedVector<IR::DpdkStructType> structs;
+    for (auto st : p->structType) {
+        if (st == metaStruct)
+            st = new IR::DpdkStructType(st->srcInfo, st->name, st->annotations, newFields);
+        structs.push_back(st);
+    }
+    p->structType = structs;
+    return p;
+}
+
 const IR::Expression* CopyPropagationAndElimination::getIrreplaceableExpr(cstring str,
                                                                         bool allowConst) {
     if (collectUseDef->dontEliminate.count(str) != 0)
@@ -461,5 +705,624 @@ CopyPropagationAndElimination::copyPropAndDeadCodeElim(
     return instrr;
 }
 
+namespace {
+bool isVariable(const IR::Expression *e) {
+    return e != nullptr && !e->is<IR::Constant>() && !e->is<IR::BoolLiteral>();
+}
+
+// Variables (header, metadata and action argument fields) read and written by
+// instructions, as bits indexed by variable.
+class InstructionEffects {
+    std::unordered_map<cstring, size_t> index;
+    bitvec all, nonMetadata;
+    // Effects of applying any table, through its key and its actions
+    bitvec tableUses, tableDefs;
+    // The metadata outlives the packet when it is recirculated or mirrored
+    bool metadataEscapes = false;
+
+ public:
+    struct Effects {
+        bitvec uses;
+        bitvec defs;     // always written
+        bitvec mayDefs;  // possibly written
+    };
+
+    explicit InstructionEffects(const IR::DpdkAsmProgram *p) {
+        forAllMatching<IR::Member>(p, [this](const IR::Member *m) {
+            auto name = m->toString();
+            if (index.count(name))
+                return;
+            auto bit = index.size();
+            index.emplace(name, bit);
+            all.setbit(bit);
+            if (!name.startsWith("m."))
+                nonMetadata.setbit(bit);
+        });
+        forAllMatching<IR::DpdkRecirculateStatement>(p,
+                [this](const IR::DpdkRecirculateStatement *) {
+            metadataEscapes = true;
+        });
+        forAllMatching<IR::DpdkMirrorStatement>(p, [this](const IR::DpdkMirrorStatement *) {
+            metadataEscapes = true;
+        });
+        // Any action may run when a table is applied
+        for (auto action : p->actions) {
+            for (auto stmt : action->statements) {
+                auto e = get(stmt);
+                tableUses |= e.uses;
+                tableDefs |= e.defs;
+                tableDefs |= e.mayDefs;
+            }
+        }
+        auto addUses = [this](const IR::Node *n) {
+            if (n)
+                forAllMatching<IR::Member>(n, [this](const IR::Member *m) {
+                    tableUses.setbit(index.at(m->toString()));
+                });
+        };
+        for (auto tbl : p->tables)
+            addUses(tbl->match_keys);
+        for (auto learner : p->learners)
+            addUses(learner->match_keys);
+        for (auto sel : p->selectors) {
+            addUses(sel->group_id);
+            addUses(sel->selectors);
+            if (bit(sel->member_id) >= 0)
+                tableDefs.setbit(bit(sel->member_id));
+        }
+    }
+
+    /// Bit of variable @e, or -1 if @e is not a variable
+    int bit(const IR::Expression *e) const {
+        if (!isVariable(e))
+            return -1;
+        auto it = index.find(e->toString());
+        return it == index.end() ? -1 : it->second;
+    }
+
+    size_t size() const { return index.size(); }
+
+    const bitvec& allVariables() const { return all; }
+
+    /// Variables read after the last instruction of the apply block or of an action
+    bitvec liveAtExit(bool inAction) const {
+        return inAction || metadataEscapes ? all : nonMetadata;
+    }
+
+    Effects get(const IR::DpdkAsmStatement *s) const {
+        Effects e;
+        auto use = [&](const IR::Expression *x) {
+            if (bit(x) >= 0) e.uses.setbit(bit(x));
+        };
+        auto def = [&](const IR::Expression *x) {
+            if (bit(x) >= 0) e.defs.setbit(bit(x));
+        };
+        if (s->is<IR::DpdkLabelStatement>() || s->is<IR::DpdkReturnStatement>()) {
+        } else if (auto j = s->to<IR::DpdkJmpCondStatement>()) {
+            use(j->src1);
+            use(j->src2);
+        } else if (s->is<IR::DpdkJmpStatement>()) {
+        } else if (auto u = s->to<IR::DpdkUnaryStatement>()) {
+            use(u->src);
+            def(u->dst);
+        } else if (auto b = s->to<IR::DpdkBinaryStatement>()) {
+            use(b->src1);
+            use(b->src2);
+            def(b->dst);
+        } else if (auto c = s->to<IR::DpdkCastStatement>()) {
+            use(c->src);
+            def(c->dst);
+        } else if (auto r = s->to<IR::DpdkRegisterReadStatement>()) {
+            use(r->index);
+            def(r->dst);
+        } else if (auto r = s->to<IR::DpdkRegisterWriteStatement>()) {
+            use(r->index);
+            use(r->src);
+        } else if (auto c = s->to<IR::DpdkCounterCountStatement>()) {
+            use(c->index);
+            if (c->incr) use(c->incr);
+        } else if (auto m = s->to<IR::DpdkMeterExecuteStatement>()) {
+            use(m->index);
+            if (m->length) use(m->length);
+            use(m->color_in);
+            def(m->color_out);
+        } else if (s->is<IR::DpdkApplyStatement>()) {
+            e.uses = tableUses;
+            e.mayDefs = tableDefs;
+        } else if (s->is<IR::DpdkEmitStatement>()) {
+            e.uses = nonMetadata;
+        } else if (auto tx = s->to<IR::DpdkTxStatement>()) {
+            if (metadataEscapes) e.uses = all;
+            use(tx->port);
+        } else if (s->is<IR::DpdkDropStatement>()) {
+            if (metadataEscapes) e.uses = all;
+        } else {
+            // Instructions reading ranges of fields, headers or extern state
+            e.uses = all;
+            e.mayDefs = all;
+        }
+        return e;
+    }
+};
+
+// Control flow graph of an instruction list: a block ends at a jump or before
+// a label.
+struct InstructionCfg {
+    static constexpr int exit = -1;         // after the last instruction
+    static constexpr int unknownExit = -2;  // jump to a label outside of the list
+    struct Block {
+        size_t begin, end;
+        std::vector<int> succs;
+        std::vector<size_t> preds;
+    };
+    std::vector<Block> blocks;
+
+    explicit InstructionCfg(const IR::IndexedVector<IR::DpdkAsmStatement>& stmts) {
+        size_t begin = 0;
+        for (size_t i = 0; i < stmts.size(); i++) {
+            if (stmts[i]->is<IR::DpdkLabelStatement>() && i > begin) {
+                blocks.push_back({begin, i, {}, {}});
+                begin = i;
+            }
+            if (stmts[i]->is<IR::DpdkJmpStatement>() || stmts[i]->is<IR::DpdkReturnStatement>()) {
+                blocks.push_back({begin, i + 1, {}, {}});
+                begin = i + 1;
+            }
+        }
+        if (begin < stmts.size())
+            blocks.push_back({begin, stmts.size(), {}, {}});
+
+        std::map<cstring, int> labelBlock;
+        for (size_t b = 0; b < blocks.size(); b++)
+            if (auto label = stmts[blocks[b].begin]->to<IR::DpdkLabelStatement>())
+                labelBlock.emplace(label->label, b);
+        for (size_t b = 0; b < blocks.size(); b++) {
+            auto last = stmts[blocks[b].end - 1];
+            int next = b + 1 < blocks.size() ? static_cast<int>(b + 1) : exit;
+            if (auto jmp = last->to<IR::DpdkJmpStatement>()) {
+                auto target = labelBlock.find(jmp->label);
+                blocks[b].succs.push_back(target != labelBlock.end() ? target->second
+                                                                     : unknownExit);
+                if (!last->is<IR::DpdkJmpLabelStatement>())
+                    blocks[b].succs.push_back(next);
+            } else if (last->is<IR::DpdkReturnStatement>()) {
+                blocks[b].succs.push_back(exit);
+            } else {
+                blocks[b].succs.push_back(next);
+            }
+            for (auto s : blocks[b].succs)
+                if (s >= 0)
+                    blocks[s].preds.push_back(b);
+        }
+    }
+};
+
+/// Conditional jump to @label, taken when @jmp is not; nullptr for unconditional jumps.
+const IR::DpdkJmpStatement *invertJump(const IR::DpdkJmpStatement *jmp, cstring label) {
+    if (auto j = jmp->to<IR::DpdkJmpEqualStatement>())
+        return new IR::DpdkJmpNotEqualStatement(label, j->src1, j->src2);
+    if (auto j = jmp->to<IR::DpdkJmpNotEqualStatement>())
+        return new IR::DpdkJmpEqualStatement(label, j->src1, j->src2);
+    if (auto j = jmp->to<IR::DpdkJmpLessStatement>())
+        return new IR::DpdkJmpGreaterEqualStatement(label, j->src1, j->src2);
+    if (auto j = jmp->to<IR::DpdkJmpGreaterEqualStatement>())
+        return new IR::DpdkJmpLessStatement(label, j->src1, j->src2);
+    if (auto j = jmp->to<IR::DpdkJmpGreaterStatement>())
+        return new IR::DpdkJmpLessOrEqualStatement(label, j->src1, j->src2);
+    if (auto j = jmp->to<IR::DpdkJmpLessOrEqualStatement>())
+        return new IR::DpdkJmpGreaterStatement(label, j->src1, j->src2);
+    if (jmp->is<IR::DpdkJmpHitStatement>())
+        return new IR::DpdkJmpMissStatement(label);
+    if (jmp->is<IR::DpdkJmpMissStatement>())
+        return new IR::DpdkJmpHitStatement(label);
+    if (auto j = jmp->to<IR::DpdkJmpIfValidStatement>())
+        return new IR::DpdkJmpIfInvalidStatement(label, j->header);
+    if (auto j = jmp->to<IR::DpdkJmpIfInvalidStatement>())
+        return new IR::DpdkJmpIfValidStatement(label, j->header);
+    if (auto j = jmp->to<IR::DpdkJmpIfActionRunStatement>())
+        return new IR::DpdkJmpIfActionNotRunStatement(label, j->action);
+    if (auto j = jmp->to<IR::DpdkJmpIfActionNotRunStatement>())
+        return new IR::DpdkJmpIfActionRunStatement(label, j->action);
+    return nullptr;
+}
+
+/// True if a use of @dst can be replaced by @src: both hold the same value
+/// whatever the width of @dst.
+bool isExactCopy(const IR::Expression *dst, const IR::Expression *src) {
+    auto dstType = dst->type ? dst->type->to<IR::Type_Bits>() : nullptr;
+    if (auto c = src->to<IR::Constant>())
+        return dstType && c->value >= 0 && c->value < (big_int(1) << dstType->width_bits());
+    if (!isVariable(src) || !dst->type || !src->type)
+        return false;
+    if (dst->type->is<IR::Type_Boolean>())
+        return src->type->is<IR::Type_Boolean>();
+    auto srcType = src->type->to<IR::Type_Bits>();
+    return dstType && srcType && dstType->width_bits() == srcType->width_bits() &&
+           dstType->isSigned == srcType->isSigned;
+}
+
+class InstructionListOptimizer {
+    const InstructionEffects& effects;
+    bool inAction;
+    IR::IndexedVector<IR::DpdkAsmStatement> stmts;
+    // The P4 block of each statement, kept in step with stmts
+    std::vector<cstring> origin;
+
+    std::vector<InstructionEffects::Effects> statementEffects() const {
+        std::vector<InstructionEffects::Effects> result;
+        for (auto s : stmts)
+            result.push_back(effects.get(s));
+        return result;
+    }
+
+    bool propagateCopies();
+    bool eliminateDeadStores();
+    bool simplifyJumps();
+
+ public:
+    /// @origin is the P4 block of each statement of @stmts, if known.
+    InstructionListOptimizer(const InstructionEffects& effects, bool inAction,
+                             const IR::IndexedVector<IR::DpdkAsmStatement>& stmts,
+                             std::vector<cstring> origin = {})
+        : effects(effects), inAction(inAction), stmts(stmts), origin(std::move(origin)) {
+        this->origin.resize(stmts.size());
+    }
+
+    /// The P4 block of each statement returned by run()
+    const std::vector<cstring>& getOrigin() const { return origin; }
+
+    IR::IndexedVector<IR::DpdkAsmStatement> run() {
+        for (auto s : stmts)
+            if (s->is<IR::DpdkListStatement>())
+                return stmts;
+        for (int round = 0; round < 16; round++) {
+            bool changed = propagateCopies();
+            changed |= eliminateDeadStores();
+            changed |= simplifyJumps();
+            if (!changed)
+                break;
+        }
+        return stmts;
+    }
+};
+
+// Replaces the variables that hold a copy of another variable or of a constant
+// on all paths by the original, where the instruction accepts it.
+bool InstructionListOptimizer::propagateCopies() {
+    InstructionCfg cfg(stmts);
+    auto eff = statementEffects();
+
+    // Candidate copies: `mov m.x src`, numbered by (destination, source)
+    struct Copy {
+        int dst, src;  // bits of the variables; src is -1 for a constant
+        const IR::Expression *value;
+    };
+    std::vector<Copy> copies;
+    std::map<std::pair<cstring, cstring>, size_t> copyIndex;
+    std::vector<int> copyOf(stmts.size(), -1);
+    for (size_t i = 0; i < stmts.size(); i++) {
+        auto mov = stmts[i]->to<IR::DpdkMovStatement>();
+        if (!mov || !mov->dst->toString().startsWith("m."))
+            continue;
+        int dst = effects.bit(mov->dst), src = effects.bit(mov->src);
+        if (dst < 0 || dst == src || (src < 0 && !mov->src->is<IR::Constant>()) ||
+            !isExactCopy(mov->dst, mov->src))
+            continue;
+        auto key = std::make_pair(mov->dst->toString(), mov->src->toString());
+        auto it = copyIndex.find(key);
+        if (it == copyIndex.end()) {
+            it = copyIndex.emplace(key, copies.size()).first;
+            copies.push_back({dst, src, mov->src});
+        }
+        copyOf[i] = it->second;
+    }
+    if (copies.empty())
+        return false;
+
+    bitvec allCopies(0, copies.size());
+    std::vector<bitvec> kills;
+    for (auto& e : eff) {
+        bitvec written = e.defs;
+        written |= e.mayDefs;
+        bitvec kill;
+        for (size_t c = 0; c < copies.size(); c++)
+            if (written.getbit(copies[c].dst) ||
+                (copies[c].src >= 0 && written.getbit(copies[c].src)))
+                kill.setbit(c);
+        kills.push_back(kill);
+    }
+    auto transfer = [&](size_t b, bitvec avail) {
+        for (auto i = cfg.blocks[b].begin; i < cfg.blocks[b].end; i++) {
+            avail -= kills[i];
+            if (copyOf[i] >= 0)
+                avail.setbit(copyOf[i]);
+        }
+        return avail;
+    };
+
+    // Copies available on all paths
+    std::vector<bitvec> in(cfg.blocks.size()), out(cfg.blocks.size(), allCopies);
+    for (bool changed = true; changed; ) {
+        changed = false;
+        for (size_t b = 0; b < cfg.blocks.size(); b++) {
+            bitvec avail;
+            if (b != 0 && !cfg.blocks[b].preds.empty()) {
+                avail = allCopies;
+                for (auto p : cfg.blocks[b].preds)
+                    avail &= out[p];
+            }
+            in[b] = avail;
+            auto newOut = transfer(b, avail);
+            if (!(newOut == out[b])) {
+                out[b] = newOut;
+                changed = true;
+            }
+        }
+    }
+
+    bool changed = false;
+    for (size_t b = 0; b < cfg.blocks.size(); b++) {
+        bitvec avail = in[b];
+        auto replace = [&](const IR::Expression *e, bool allowConst) {
+            int v = effects.bit(e);
+            if (v < 0)
+                return e;
+            for (auto c : avail) {
+                if (copies[c].dst == v && (allowConst || copies[c].src >= 0)) {
+                    changed = true;
+                    return copies[c].value;
+                }
+            }
+            return e;
+        };
+        for (auto i = cfg.blocks[b].begin; i < cfg.blocks[b].end; i++) {
+            auto s = stmts[i];
+            if (auto mov = s->to<IR::DpdkMovStatement>()) {
+                auto src = replace(mov->src, true);
+                if (src != mov->src)
+                    s = new IR::DpdkMovStatement(mov->dst, src);
+            } else if (auto bin = s->to<IR::DpdkBinaryStatement>()) {
+                // src1 is the destination
+                auto src2 = replace(bin->src2, true);
+                if (src2 != bin->src2) {
+                    auto clone = bin->clone();
+                    clone->src2 = src2;
+                    s = clone;
+                }
+            } else if (auto jc = s->to<IR::DpdkJmpCondStatement>()) {
+                // src1 of a conditional jump cannot be a constant
+                auto src1 = replace(jc->src1, false);
+                auto src2 = replace(jc->src2, true);
+                if (src1 != jc->src1 || src2 != jc->src2) {
+                    auto clone = jc->clone();
+                    clone->src1 = src1;
+                    clone->src2 = src2;
+                    s = clone;
+                }
+            }
+            stmts[i] = s;
+            avail -= kills[i];
+            if (copyOf[i] >= 0)
+                avail.setbit(copyOf[i]);
+        }
+    }
+    return changed;
+}
+
+// Removes the instructions that only write a metadata field which is not read
+// afterwards on any path.
+bool InstructionListOptimizer::eliminateDeadStores() {
+    InstructionCfg cfg(stmts);
+    auto eff = statementEffects();
+    auto transfer = [&](size_t b, bitvec live) {
+        for (auto i = cfg.blocks[b].end; i-- > cfg.blocks[b].begin; ) {
+            live -= eff[i].defs;
+            live |= eff[i].uses;
+        }
+        return live;
+    };
+    auto liveOut = [&](size_t b, const std::vector<bitvec>& in) {
+        bitvec live;
+        for (auto s : cfg.blocks[b].succs) {
+            if (s == InstructionCfg::exit)
+                live |= effects.liveAtExit(inAction);
+            else if (s == InstructionCfg::unknownExit)
+                live |= effects.allVariables();
+            else
+                live |= in[s];
+        }
+        return live;
+    };
+    std::vector<bitvec> in(cfg.blocks.size());
+    for (bool changed = true; changed; ) {
+        changed = false;
+        for (size_t b = cfg.blocks.size(); b-- > 0; ) {
+            auto newIn = transfer(b, liveOut(b, in));
+            if (!(newIn == in[b])) {
+                in[b] = newIn;
+                changed = true;
+            }
+        }
+    }
+
+    std::vector<bool> dead(stmts.size(), false);
+    bool changed = false;
+    for (size_t b = 0; b < cfg.blocks.size(); b++) {
+        auto live = liveOut(b, in);
+        for (auto i = cfg.blocks[b].end; i-- > cfg.blocks[b].begin; ) {
+            const IR::Expression *dst = nullptr;
+            if (auto u = stmts[i]->to<IR::DpdkUnaryStatement>())
+                dst = u->dst;
+            else if (auto bin = stmts[i]->to<IR::DpdkBinaryStatement>())
+                dst = bin->dst;
+            else if (auto c = stmts[i]->to<IR::DpdkCastStatement>())
+                dst = c->dst;
+            auto mov = stmts[i]->to<IR::DpdkMovStatement>();
+            int d = effects.bit(dst);
+            if (d >= 0 && dst->toString().startsWith("m.") &&
+                (!live.getbit(d) || (mov && effects.bit(mov->src) == d))) {
+                dead[i] = changed = true;
+                continue;
+            }
+            live -= eff[i].defs;
+            live |= eff[i].uses;
+        }
+    }
+    if (changed) {
+        IR::IndexedVector<IR::DpdkAsmStatement> result;
+        std::vector<cstring> resultOrigin;
+        for (size_t i = 0; i < stmts.size(); i++) {
+            if (!dead[i]) {
+                result.push_back(stmts[i]);
+                resultOrigin.push_back(origin[i]);
+            }
+        }
+        stmts = result;
+        origin = resultOrigin;
+    }
+    return changed;
+}
+
+// Removes unreachable instructions and jumps to the next instruction, and
+// turns a conditional jump over an unconditional one into the inverse jump.
+bool InstructionListOptimizer::simplifyJumps() {
+    bool changed = false;
+    InstructionCfg cfg(stmts);
+    std::vector<bool> reachable(cfg.blocks.size(), false);
+    std::vector<size_t> work;
+    if (!cfg.blocks.empty()) {
+        reachable[0] = true;
+        work.push_back(0);
+    }
+    while (!work.empty()) {
+        auto b = work.back();
+        work.pop_back();
+        for (auto s : cfg.blocks[b].succs) {
+            if (s >= 0 && !reachable[s]) {
+                reachable[s] = true;
+                work.push_back(s);
+            }
+        }
+    }
+
+    IR::IndexedVector<IR::DpdkAsmStatement> result;
+    std::vector<cstring> resultOrigin;
+    for (size_t b = 0; b < cfg.blocks.size(); b++) {
+        if (!reachable[b]) {
+            changed = true;
+            continue;
+        }
+        for (auto i = cfg.blocks[b].begin; i < cfg.blocks[b].end; i++) {
+            result.push_back(stmts[i]);
+            resultOrigin.push_back(origin[i]);
+        }
+    }
+
+    // True if the instructions following @i are labels including @label
+    auto fallsThroughTo = [&](size_t i, cstring label) {
+        for (auto j = i + 1; j < result.size(); j++) {
+            auto l = result[j]->to<IR::DpdkLabelStatement>();
+            if (!l)
+                return false;
+            if (l->label == label)
+                return true;
+        }
+        return false;
+    };
+    IR::IndexedVector<IR::DpdkAsmStatement> simplified;
+    origin.clear();
+    for (size_t i = 0; i < result.size(); i++) {
+        auto jmp = result[i]->to<IR::DpdkJmpStatement>();
+        if (jmp && fallsThroughTo(i, jmp->label)) {
+            changed = true;
+            continue;
+        }
+        if (jmp && i + 1 < result.size()) {
+            auto next = result[i + 1]->to<IR::DpdkJmpLabelStatement>();
+            if (next && fallsThroughTo(i + 1, jmp->label)) {
+                if (auto inverse = invertJump(jmp, next->label)) {
+                    simplified.push_back(inverse);
+                    origin.push_back(resultOrigin[i]);
+                    i++;
+                    changed = true;
+                    continue;
+                }
+            }
+        }
+        simplified.push_back(result[i]);
+        origin.push_back(resultOrigin[i]);
+    }
+    stmts = simplified;
+    return changed;
+}
+
+size_t countInstructions(const IR::IndexedVector<IR::DpdkAsmStatement>& stmts) {
+    size_t count = 0;
+    for (auto s : stmts)
+        if (!s->is<IR::DpdkLabelStatement>())
+            count++;
+    return count;
+}
+}  // namespace
+
+const IR::Node* GlobalAsmOptimization::preorder(IR::DpdkAsmProgram *p) {
+    prune();
+    InstructionEffects effects(p);
+    // Instructions before and after optimization, by P4 block
+    ordered_map<cstring, std::pair<size_t, size_t>> counts;
+    auto count = [&counts](const IR::IndexedVector<IR::DpdkAsmStatement>& stmts,
+                           const std::vector<cstring>& origin, bool before) {
+        for (size_t i = 0; i < stmts.size(); i++) {
+            if (stmts[i]->is<IR::DpdkLabelStatement>())
+                continue;
+            auto& c = counts[origin[i]];
+            (before ? c.first : c.second)++;
+        }
+    };
+
+    IR::IndexedVector<IR::DpdkAsmStatement> statements;
+    for (auto stmt : p->statements) {
+        if (auto list = stmt->to<IR::DpdkListStatement>()) {
+            // Statements made by earlier passes belong to the block of the
+            // statement before them.
+            std::vector<cstring> origin;
+            cstring block = "apply";
+            for (auto s : list->statements) {
+                auto it = structure->instruction_blocks.find(s);
+                if (it != structure->instruction_blocks.end())
+                    block = it->second;
+                origin.push_back(block);
+            }
+            count(list->statements, origin, true);
+            InstructionListOptimizer optimizer(effects, false, list->statements, origin);
+            auto optimized = optimizer.run();
+            count(optimized, optimizer.getOrigin(), false);
+            stmt = new IR::DpdkListStatement(optimized);
+        }
+        statements.push_back(stmt);
+    }
+    p->statements = statements;
+
+    IR::IndexedVector<IR::DpdkAction> actions;
+    for (auto action : p->actions) {
+        auto optimized = InstructionListOptimizer(effects, true, action->statements).run();
+        LOG2("action " << action->name << ": " << countInstructions(action->statements)
+             << " instructions, " << countInstructions(optimized) << " after optimization");
+        auto it = structure->action_blocks.find(action->name.name);
+        auto block = it != structure->action_blocks.end() ? it->second : cstring("actions");
+        counts[block].first += countInstructions(action->statements);
+        counts[block].second += countInstructions(optimized);
+        auto newAction = action->clone();
+        newAction->statements = optimized;
+        actions.push_back(newAction);
+    }
+    p->actions = actions;
+
+    for (auto& c : counts)
+        LOG1(c.first << ": removed " << c.second.first - c.second.second << " of "
+             << c.second.first << " instructions");
+    return p;
+}
+
 size_t ShortenTokenLength::count = 0;
 }  // namespace DPDK
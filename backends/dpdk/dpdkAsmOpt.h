@@ -29,6 +29,7 @@ limitations under the License.
 #include "ir/ir.h"
 #include "lib/gmputil.h"
 #include "lib/json.h"
+#include "dpdkProgramStructure.h"
 #include "dpdkUtils.h"
 
 #define DPDK_TABLE_MAX_KEY_SIZE 64*8
@@ -170,7 +171,29 @@ class ValidateTableKeys : public Inspector {
  public:
     ValidateTableKeys() {}
     bool preorder(const IR::DpdkAsmProgram *p) override;
-    int getFieldSizeBits(const IR::Type *field_type);
+    static int getFieldSizeBits(const IR::Type *field_type);
+};
+
+// Number of instructions and table keys referring to each metadata field, as
+// collected by OptimizeMetadataLayout.
+struct MetadataLayout {
+    std::map<cstring, unsigned> accesses;
+};
+
+// This pass reorders the fields of the metadata struct so that the fields most
+// often referred to per byte come first, in the first cache lines of the packet
+// metadata, and so that the key fields of a table (or learner, or selector) are
+// next to each other, which keeps them within the 64 bytes a table key may span.
+// Fields that DPDK reads as one range (the arguments of a learn instruction,
+// the fields of a hash instruction) are kept together and in order.  The
+// layout is left as it is if it would make the keys of a table span more than
+// 64 bytes where they did not before.
+class OptimizeMetadataLayout : public Transform {
+    MetadataLayout& layout;
+ public:
+    static const int cacheLineBits = 64 * 8;
+    explicit OptimizeMetadataLayout(MetadataLayout& layout) : layout(layout) {}
+    const IR::Node* preorder(IR::DpdkAsmProgram *p) override;
 };
 
 // This pass shorten the Identifier length
@@ -567,6 +590,24 @@ class CopyPropagationAndElimination : public Transform {
     }
 };
 
+// This pass optimizes the instructions of the apply block and of each action
+// over their control flow graph, where the passes above only look at a window
+// of instructions: copies are propagated along all paths, instructions writing
+// a metadata field that is not read afterwards on any path are removed,
+// unreachable instructions and jumps to the next instruction are removed, and
+// a conditional jump over an unconditional jump becomes the inverse conditional
+// jump.  Applying a table is assumed to read its key and whatever the actions
+// read.  The number of removed instructions is logged for each parser, control
+// and deparser, including their actions (see
+// DpdkProgramStructure::instruction_blocks).
+class GlobalAsmOptimization : public Transform {
+    const DpdkProgramStructure *structure;
+
+ public:
+    explicit GlobalAsmOptimization(const DpdkProgramStructure *structure)
+        : structure(structure) { CHECK_NULL(structure); }
+    const IR::Node* preorder(IR::DpdkAsmProgram *p) override;
+};
 
 // Instructions can only appear in actions and apply block of .spec file.
 // All these individual passes work on the actions and apply block of .spec file.
@@ -508,7 +508,7 @@ void DpdkContextGenerator::addExternInfo(Util::JsonArray* externsJson) {
     }
 }
 
-const Util::JsonObject* DpdkContextGenerator::genContextJsonObject() {
+Util::JsonObject* DpdkContextGenerator::genContextJsonObject() {
     auto* json = new Util::JsonObject();
     auto* tablesJson = new Util::JsonArray();
     auto* externsJson = new Util::JsonArray();
@@ -527,10 +527,49 @@ const Util::JsonObject* DpdkContextGenerator::genContextJsonObject() {
     return json;
 }
 
-void DpdkContextGenerator::serializeContextJson(std::ostream* destination) {
+void DpdkContextGenerator::generateContextJson() {
     CollectTablesAndSetAttributes();
-    auto* json = genContextJsonObject();
-    json->serialize(*destination);
+    contextJson = genContextJsonObject();
+}
+
+// Adds the layout of the metadata struct of the assembly program, with the
+// number of instructions and table keys referring to each field.
+void DpdkContextGenerator::addMetadataLayout(const IR::DpdkAsmProgram *program,
+                                             const MetadataLayout& layout) {
+    if (!contextJson)
+        return;
+    auto* layoutJson = new Util::JsonObject();
+    auto* fieldsJson = new Util::JsonArray();
+    layoutJson->emplace("cache_line_size", OptimizeMetadataLayout::cacheLineBits / 8);
+    layoutJson->emplace("fields", fieldsJson);
+    for (auto st : program->structType) {
+        if (!isMetadataStruct(st))
+            continue;
+        int offset = 0;
+        for (auto field : st->fields) {
+            int width = ValidateTableKeys::getFieldSizeBits(field->type);
+            // Field names may have been shortened after the layout was computed
+            cstring name = field->name.name;
+            auto orig = ShortenTokenLength::origNameMap.find(name);
+            auto accesses = layout.accesses.find(
+                orig != ShortenTokenLength::origNameMap.end() ? orig->second : name);
+            auto* fieldJson = new Util::JsonObject();
+            fieldJson->emplace("name", name);
+            fieldJson->emplace("bit_offset", offset);
+            fieldJson->emplace("bit_width", width);
+            fieldJson->emplace("cache_line", offset / OptimizeMetadataLayout::cacheLineBits);
+            fieldJson->emplace("accesses",
+                               accesses != layout.accesses.end() ? accesses->second : 0u);
+            fieldsJson->append(fieldJson);
+            offset += width;
+        }
+    }
+    contextJson->emplace("metadata_layout", layoutJson);
+}
+
+void DpdkContextGenerator::serializeContextJson(std::ostream* destination) {
+    CHECK_NULL(contextJson);
+    contextJson->serialize(*destination);
     destination->flush();
 }
 
@@ -17,6 +17,7 @@ limitations under the License.
 #ifndef BACKENDS_DPDK_DPDKCONTEXT_H_
 #define BACKENDS_DPDK_DPDKCONTEXT_H_
 
+#include "dpdkAsmOpt.h"
 #include "dpdkProgramStructure.h"
 #include "options.h"
 #include "constants.h"
@@ -139,6 +140,8 @@ class DpdkContextGenerator : public Inspector {
     // Running unique ID for tables and actions
     static unsigned newTableHandle;
     static unsigned newActionHandle;
+    // Context JSON object, generated before the program is converted to assembly
+    Util::JsonObject* contextJson = nullptr;
 
  public:
     DpdkContextGenerator(P4::ReferenceMap *refmap, P4::TypeMap *typemap,
@@ -148,8 +151,11 @@ class DpdkContextGenerator : public Inspector {
 
     unsigned int getNewTableHandle();
     unsigned int getNewActionHandle();
+    void generateContextJson();
+    bool generated() const { return contextJson != nullptr; }
+    void addMetadataLayout(const IR::DpdkAsmProgram *program, const MetadataLayout& layout);
     void serializeContextJson(std::ostream* destination);
-    const Util::JsonObject* genContextJsonObject();
+    Util::JsonObject* genContextJsonObject();
     void addMatchTables(Util::JsonArray* tablesJson);
     void addExternInfo(Util::JsonArray* externsJson);
     Util::JsonObject* initTableCommonJson(const cstring name, const struct TableAttributes & attr);
@@ -106,18 +106,43 @@ const IR::DpdkAsmProgram *ConvertToDpdkProgram::create(IR::P4Program *prog) {
 
     IR::IndexedVector<IR::DpdkAsmStatement> statements;
 
+    // Records the block which the instructions and actions added by a
+    // converter since @instructions and @actions were counted come from.
+    auto recordBlock = [this](cstring block,
+                              const IR::IndexedVector<IR::DpdkAsmStatement>& instructions,
+                              size_t fromInstruction,
+                              const IR::IndexedVector<IR::DpdkAction>* actions = nullptr,
+                              size_t fromAction = 0) {
+        for (auto i = fromInstruction; i < instructions.size(); i++)
+            structure->instruction_blocks.emplace(instructions[i], block);
+        for (auto i = fromAction; actions && i < actions->size(); i++)
+            structure->action_blocks.emplace(actions->at(i)->name.name, block);
+    };
+    auto applyParser = [&](const IR::P4Parser* parser, ConvertToDpdkParser* converter) {
+        auto instructions = converter->getInstructions().size();
+        parser->apply(*converter);
+        recordBlock(parser->name, converter->getInstructions(), instructions);
+    };
+    auto applyControl = [&](const IR::P4Control* control, ConvertToDpdkControl* converter) {
+        auto instructions = converter->getInstructions().size();
+        auto actions = converter->getActions().size();
+        control->apply(*converter);
+        recordBlock(control->name, converter->getInstructions(), instructions,
+                    &converter->getActions(), actions);
+    };
+
     auto ingress_parser_converter =
         new ConvertToDpdkParser(refmap, typemap, structure, metadataStruct);
     auto egress_parser_converter =
         new ConvertToDpdkParser(refmap, typemap, structure, metadataStruct);
     for (auto kv : structure->parsers) {
         if (kv.first == "IngressParser")
-            kv.second->apply(*ingress_parser_converter);
+            applyParser(kv.second, ingress_parser_converter);
         else if (kv.first == "EgressParser") {
             if (options.enableEgress)
-                kv.second->apply(*egress_parser_converter);
+                applyParser(kv.second, egress_parser_converter);
         } else if (kv.first == "MainParserT")
-            kv.second->apply(*ingress_parser_converter);
+            applyParser(kv.second, ingress_parser_converter);
         else
             BUG("Unknown parser %s", kv.second->name);
     }
@@ -127,14 +152,14 @@ const IR::DpdkAsmProgram *ConvertToDpdkProgram::create(IR::P4Program *prog) {
         new ConvertToDpdkControl(refmap, typemap, structure, metadataStruct);
     for (auto kv : structure->pipelines) {
         if (kv.first == "Ingress")
-            kv.second->apply(*ingress_converter);
+            applyControl(kv.second, ingress_converter);
         else if (kv.first == "Egress") {
             if (options.enableEgress)
-                kv.second->apply(*egress_converter);
+                applyControl(kv.second, egress_converter);
         } else if (kv.first == "PreControlT")
-            kv.second->apply(*ingress_converter);
+            applyControl(kv.second, ingress_converter);
         else if (kv.first == "MainControlT")
-            kv.second->apply(*ingress_converter);
+            applyControl(kv.second, ingress_converter);
         else
             BUG("Unknown control block %s", kv.second->name);
     }
@@ -144,12 +169,12 @@ const IR::DpdkAsmProgram *ConvertToDpdkProgram::create(IR::P4Program *prog) {
         new ConvertToDpdkControl(refmap, typemap, structure, metadataStruct);
     for (auto kv : structure->deparsers) {
         if (kv.first == "IngressDeparser")
-            kv.second->apply(*ingress_deparser_converter);
+            applyControl(kv.second, ingress_deparser_converter);
         else if (kv.first == "EgressDeparser") {
             if (options.enableEgress)
-                kv.second->apply(*egress_deparser_converter);
+                applyControl(kv.second, egress_deparser_converter);
         } else if (kv.first == "MainDeparserT")
-            kv.second->apply(*ingress_deparser_converter);
+            applyControl(kv.second, ingress_deparser_converter);
         else
             BUG("Unknown deparser block %s", kv.second->name);
     }
@@ -48,6 +48,11 @@ struct DpdkProgramStructure {
     std::set<cstring> pipeline_controls;
     std::set<cstring> non_pipeline_controls;
 
+    // The parser, control or deparser which each instruction of the apply
+    // block and each action of the assembly program were converted from
+    std::map<const IR::DpdkAsmStatement *, cstring> instruction_blocks;
+    std::map<cstring, cstring> action_blocks;
+
     IR::Type_Struct * metadataStruct;
     cstring local_metadata_type;
     cstring header_type;
@@ -27,6 +27,7 @@ limitations under the License.
 #include "control-plane/p4RuntimeSerializer.h"
 #include "control-plane/bfruntime_ext.h"
 #include "frontends/common/applyOptionsPragmas.h"
+#include "frontends/common/compileServer.h"
 #include "frontends/common/parseInput.h"
 #include "frontends/common/parser_options.h"
 #include "frontends/p4/frontend.h"
@@ -60,9 +61,7 @@ void generateTDIBfrtJson(bool isTDI, const IR::P4Program *program, DPDK::DpdkOpt
     p4rt->serializeBFRuntimeSchema(out);
 }
 
-int main(int argc, char *const argv[]) {
-    setup_gc_logging();
-
+static int compileMain(int argc, char *const argv[]) {
     AutoCompileContext autoDpdkContext(new DPDK::DpdkContext);
     auto &options = DPDK::DpdkContext::get().options();
     options.langVersion = CompilerOptions::FrontendVersion::P4_16;
@@ -163,3 +162,13 @@ int main(int argc, char *const argv[]) {
 
     return ::errorCount() > 0;
 }
+
+int main(int argc, char *const argv[]) {
+    setup_gc_logging();
+
+    if (P4::CompileServer::requested(argc, argv))
+        return P4::CompileServer::serve(argc, argv, compileMain,
+                                        {{"core.p4", "dpdk/psa.p4"}, {"core.p4", "pna.p4"}},
+                                        DPDK_VERSION_STRING);
+    return compileMain(argc, argv);
+}
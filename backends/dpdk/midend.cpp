@@ -211,7 +211,7 @@ DpdkMidEnd::DpdkMidEnd(CompilerOptions &options,
             new P4::FlattenHeaderUnion(&refMap, &typeMap),
             new P4::SimplifyControlFlow(&refMap, &typeMap),
             new P4::HSIndexSimplifier(&refMap, &typeMap),
-            new P4::ParsersUnroll(true, &refMap, &typeMap),
+            new P4::ParsersUnroll(true, &refMap, &typeMap, options.loopsUnrollingMaxStates),
             new P4::ReplaceSelectRange(&refMap, &typeMap),
             new P4::MoveDeclarations(),  // more may have been introduced
             new P4::ConstantFolding(&refMap, &typeMap),
@@ -34,6 +34,12 @@ class DpdkOptions : public CompilerOptions {
     bool loadIRFromJson = false;
     // Enable/Disable Egress pipeline in psa
     bool enableEgress = false;
+    // Check the type map maintained by the back-end against full type checks
+    bool verifyTypeMap = false;
+    // Reorder the metadata struct fields by access frequency and table keys
+    bool optimizeMetadataLayout = false;
+    // Optimize instructions across basic blocks
+    bool optimizeInstructions = false;
 
     DpdkOptions() {
         registerOption(
@@ -52,6 +58,32 @@ class DpdkOptions : public CompilerOptions {
                 return true;
             },
             "[Dpdk back-end] Enable egress pipeline's codegen\n", OptionFlags::Hide);
+        registerOption(
+            "--verifyTypeMap", nullptr,
+            [this](const char *) {
+                verifyTypeMap = true;
+                return true;
+            },
+            "[Dpdk back-end] Check the type information after each incremental\n"
+            "type-checking round of the back-end against a full type check of\n"
+            "the program (slow, for debugging the compiler)", OptionFlags::Hide);
+        registerOption(
+            "--optimizeInstructions", nullptr,
+            [this](const char *) {
+                optimizeInstructions = true;
+                return true;
+            },
+            "[Dpdk back-end] Propagate copies and remove dead instructions and\n"
+            "jumps across the basic blocks of the apply block and actions");
+        registerOption(
+            "--optimizeMetadataLayout", nullptr,
+            [this](const char *) {
+                optimizeMetadataLayout = true;
+                return true;
+            },
+            "[Dpdk back-end] Order the metadata fields by access frequency, hottest\n"
+            "first, keeping the key fields of each table together; the layout is\n"
+            "reported in the context JSON");
 
         registerOption("--bf-rt-schema", "file",
                 [this](const char *arg) { bfRtSchema = arg; return true; },
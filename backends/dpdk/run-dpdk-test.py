@@ -29,6 +29,7 @@ import shutil
 import difflib
 import subprocess
 import glob
+import json
 
 SUCCESS = 0
 FAILURE = 1
@@ -47,6 +48,8 @@ class Options(object):
         self.runDebugger_skip = 0
         self.generateP4Runtime = False
         self.generateBfRt = False
+        self.generateContext = False
+        self.outputsSubdir = None       # expected outputs in this subdirectory
 
 def usage(options):
     name = options.binary
@@ -61,6 +64,10 @@ def usage(options):
     print("          -a \"args\": pass args to the compiler")
     print("          --p4runtime: generate P4Info message in text format")
     print("          --bfrt: generate BfRt message in text format")
+    print("          --context: generate the context JSON and validate it against")
+    print("                     DPDK_context_schema.json")
+    print("          --outputs-subdir dir: expected outputs are in the dir subdirectory")
+    print("                     of the outputs of the sample (for non-default options)")
 
 def isError(p4filename):
     # True if the filename represents a p4 program that should fail
@@ -143,6 +150,34 @@ def compare_files(options, produced, expected, ignore_case):
     else:
         return FAILURE
 
+def check_context_schema(options, contextFile):
+    """Validates the context JSON against the schema of the DPDK back-end,
+    and removes the parts which are different in each run."""
+    try:
+        import jsonschema
+    except ImportError:
+        print("The jsonschema module is needed to validate", contextFile, file=sys.stderr)
+        return FAILURE
+    schemaFile = os.path.join(options.compilerSrcdir, "backends", "dpdk",
+                              "DPDK_context_schema.json")
+    with open(schemaFile) as f:
+        schema = json.load(f)
+    with open(contextFile) as f:
+        context = json.load(f)
+    try:
+        jsonschema.validate(instance=context, schema=schema)
+    except jsonschema.ValidationError as e:
+        print(contextFile, "does not match", schemaFile, ":", e.message, file=sys.stderr)
+        return FAILURE
+    # The date and the command line (with the temporary folder) change from
+    # one run to the next.
+    context["build_date"] = ""
+    context["compile_command"] = ""
+    with open(contextFile, "w") as f:
+        json.dump(context, f, indent=4)
+        f.write("\n")
+    return SUCCESS
+
 def check_generated_files(options, tmpdir, expecteddir):
     files = os.listdir(tmpdir)
     for file in files:
@@ -231,6 +266,8 @@ def process_file(options, argv):
         expected_dirname = dirname.replace("p4_16/", "p4_16_outputs/", 1)
     else:
         expected_dirname = dirname + "_outputs"  # expected outputs are here
+    if options.outputsSubdir is not None:
+        expected_dirname = os.path.join(expected_dirname, options.outputsSubdir)
     if not os.path.exists(expected_dirname):
         os.makedirs(expected_dirname)
 
@@ -241,6 +278,7 @@ def process_file(options, argv):
     p4runtimeFile = os.path.join(tmpdir, basename + ".p4info.txt")
     p4runtimeEntriesFile = os.path.join(tmpdir, basename + ".entries.txt")
     bfRtSchemaFile = os.path.join(tmpdir, basename + ".bfrt.json")
+    contextFile = os.path.join(tmpdir, basename + ".context.json")
     def getArch(path):
         v1Pattern = re.compile('include.*v1model\.p4')
         pnaPattern = re.compile('include.*pna\.p4')
@@ -269,6 +307,8 @@ def process_file(options, argv):
             args.extend(["--p4runtime-entries-files", p4runtimeEntriesFile])
         if options.generateBfRt:
             args.extend(["--bf-rt-schema", bfRtSchemaFile])
+        if options.generateContext:
+            args.extend(["--context", contextFile])
 
     if "p4_14" in options.p4filename or "v1_samples" in options.p4filename:
         args.extend(["--std", "p4-14"])
@@ -293,6 +333,8 @@ def process_file(options, argv):
     if expected_error and result == SUCCESS:
         result = FAILURE
 
+    if result == SUCCESS and options.generateContext and os.path.isfile(contextFile):
+        result = check_context_schema(options, contextFile)
     if result == SUCCESS:
         result = check_generated_files(options, tmpdir, expected_dirname)
 
@@ -352,6 +394,15 @@ def main(argv):
             options.generateP4Runtime = True
         elif argv[0] == "--bfrt":
             options.generateBfRt = True
+        elif argv[0] == "--context":
+            options.generateContext = True
+        elif argv[0] == "--outputs-subdir":
+            if len(argv) == 1:
+                print("Missing argument for --outputs-subdir option")
+                usage(options)
+                sys.exit(FAILURE)
+            options.outputsSubdir = argv[1]
+            argv = argv[1:]
         else:
             print("Unknown option ", argv[0], file=sys.stderr)
             usage(options)
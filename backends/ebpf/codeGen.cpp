@@ -297,7 +297,7 @@ bool CodeGenInspector::preorder(const IR::MethodCallExpression* expression) {
     visit(expression->method);
     builder->append("(");
     bool first = true;
-    for (auto p : *mi->substitution.getParametersInArgumentOrder()) {
+    for (auto p : mi->substitution.getParametersInArgumentOrder()) {
         if (!first)
             builder->append(", ");
         expressionPrecedence = DBPrint::Prec_Low;
@@ -59,8 +59,8 @@ void emitFilterModel(const EbpfOptions& options, Target* target, const IR::Tople
 
     ebpfprog->emitH(&h, hfile);
     ebpfprog->emitC(&c, hfile);
-    *cstream << c.toString();
-    *hstream << h.toString();
+    *cstream << c.release();
+    *hstream << h.release();
     cstream->flush();
     hstream->flush();
 }
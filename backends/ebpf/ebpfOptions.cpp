@@ -50,6 +50,13 @@ EbpfOptions::EbpfOptions() {
                    return true;
                 }, "Set number of maximum possible masks for a ternary key"
                   " in a single table");
+        registerOption("--sorted-ternary-tuples", nullptr,
+                [this](const char*) { sortedTernaryTuples = true; return true; },
+                "Stop a ternary table lookup when no remaining tuple can match with a higher"
+                " priority; requires the control plane to keep tuples sorted by priority");
+        registerOption("--ternary-lookup-stats", nullptr,
+                [this](const char*) { ternaryLookupStats = true; return true; },
+                "Count lookups and tuple probes of ternary tables in a debug map");
         registerOption("--xdp2tc", "MODE",
                 [this](const char* arg) {
                    if (!strcmp(arg, "meta")) {
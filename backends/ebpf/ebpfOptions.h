@@ -41,6 +41,10 @@ class EbpfOptions : public CompilerOptions {
     enum XDP2TC xdp2tcMode = XDP2TC_NONE;
     // maximum number of unique ternary masks
     unsigned int maxTernaryMasks = 128;
+    // tuples of ternary tables are sorted by their highest priority
+    bool sortedTernaryTuples = false;
+    // count lookups into ternary tables
+    bool ternaryLookupStats = false;
 
     EbpfOptions();
 
@@ -244,7 +244,7 @@ void EBPFTable::emitActionArguments(CodeBuilder* builder,
     builder->append("struct ");
     builder->blockStart();
 
-    for (auto p : *action->parameters->getEnumerator()) {
+    for (auto p : *action->parameters) {
         builder->emitIndent();
         auto type = EBPFTypeFactory::instance->create(p->type);
         type->declare(builder, p->externalName(), false);
@@ -284,8 +284,29 @@ void EBPFTable::emitValueType(CodeBuilder* builder) {
         builder->newline();
         builder->emitIndent();
         builder->appendLine("__u8 has_next;");
+        if (program->options.sortedTernaryTuples) {
+            // highest priority of the entries in the tuple
+            builder->emitIndent();
+            builder->appendLine("__u32 max_priority;");
+            // set in the head of the list by a control plane which keeps
+            // the tuples sorted by max_priority
+            builder->emitIndent();
+            builder->appendLine("__u8 sorted_tuples;");
+        }
         builder->blockEnd(false);
         builder->endOfStatement(true);
+
+        if (program->options.ternaryLookupStats) {
+            builder->emitIndent();
+            builder->appendFormat("struct %s_lookup_stats ", valueTypeName.c_str());
+            builder->blockStart();
+            builder->emitIndent();
+            builder->appendLine("__u64 lookups;");
+            builder->emitIndent();
+            builder->appendLine("__u64 tuple_lookups;");
+            builder->blockEnd(false);
+            builder->endOfStatement(true);
+        }
     }
 }
 
@@ -359,6 +380,11 @@ void EBPFTable::emitTernaryInstance(CodeBuilder *builder) {
                                       TableHash, "struct " + keyTypeName,
                                       "struct " + valueTypeName, size,
                                       instanceName + "_tuples_map", TableArray, "__u32", size);
+    if (program->options.ternaryLookupStats) {
+        builder->target->emitTableDecl(builder, instanceName + "_lookup_stats",
+                                       TablePerCPUArray, "u32",
+                                       "struct " + valueTypeName + "_lookup_stats", 1);
+    }
 }
 
 void EBPFTable::emitInstance(CodeBuilder* builder) {
@@ -651,7 +677,7 @@ void EBPFTable::emitInitializer(CodeBuilder* builder) {
 
     builder->emitIndent();
     builder->appendFormat(".u = {.%s = {", name.c_str());
-    for (auto p : *mi->substitution.getParametersInArgumentOrder()) {
+    for (auto p : mi->substitution.getParametersInArgumentOrder()) {
         auto arg = mi->substitution.lookup(p);
         arg->apply(cg);
         builder->append(",");
@@ -724,7 +750,7 @@ void EBPFTable::emitInitializer(CodeBuilder* builder) {
 
         builder->emitIndent();
         builder->appendFormat(".u = {.%s = {", name.c_str());
-        for (auto p : *mi->substitution.getParametersInArgumentOrder()) {
+        for (auto p : mi->substitution.getParametersInArgumentOrder()) {
             auto arg = mi->substitution.lookup(p);
             arg->apply(cg);
             builder->append(",");
@@ -763,12 +789,20 @@ void EBPFTable::emitLookup(CodeBuilder* builder, cstring key, cstring value) {
     builder->appendFormat("struct %s_mask *", valueTypeName);
     builder->target->emitTableLookup(builder, instanceName + "_prefixes", "head", "val");
     builder->endOfStatement(true);
+    if (program->options.ternaryLookupStats) {
+        builder->emitIndent();
+        builder->appendLine("__u64 nr_tuple_lookups = 0;");
+    }
     builder->emitIndent();
     builder->append("if (val && val->has_next != 0) ");
     builder->blockStart();
     builder->emitIndent();
     builder->appendFormat("struct %s_mask next = val->next_tuple_mask;", keyTypeName);
     builder->newline();
+    if (program->options.sortedTernaryTuples) {
+        builder->emitIndent();
+        builder->appendLine("__u8 sorted_tuples = val->sorted_tuples;");
+    }
     builder->emitIndent();
     builder->appendLine("#pragma clang loop unroll(disable)");
     builder->emitIndent();
@@ -786,6 +820,20 @@ void EBPFTable::emitLookup(CodeBuilder* builder, cstring key, cstring value) {
     builder->emitIndent();
     builder->appendLine("break;");
     builder->blockEnd(true);
+    if (program->options.sortedTernaryTuples) {
+        // If tuples are sorted by their highest priority, none of the remaining
+        // ones can have a better match. A control plane which does not know
+        // about the ordering leaves sorted_tuples unset, so all tuples are searched.
+        builder->emitIndent();
+        builder->appendFormat("if (sorted_tuples && %s != NULL && "
+                              "v->max_priority <= %s->priority) ", value, value);
+        builder->blockStart();
+        builder->target->emitTraceMessage(builder,
+                                          "Control: No tuple left with a higher priority");
+        builder->emitIndent();
+        builder->appendLine("break;");
+        builder->blockEnd(true);
+    }
     builder->emitIndent();
     cstring new_key = "k";
     builder->appendFormat("struct %s %s = {};", keyTypeName, new_key);
@@ -831,6 +879,10 @@ void EBPFTable::emitLookup(CodeBuilder* builder, cstring key, cstring value) {
     builder->newline();
     builder->blockEnd(true);
 
+    if (program->options.ternaryLookupStats) {
+        builder->emitIndent();
+        builder->appendLine("nr_tuple_lookups++;");
+    }
     builder->emitIndent();
     builder->appendFormat("struct %s *tuple_entry = "
                           "bpf_map_lookup_elem(%s, &%s)",
@@ -870,6 +922,22 @@ void EBPFTable::emitLookup(CodeBuilder* builder, cstring key, cstring value) {
     builder->blockEnd(true);
     builder->blockEnd(true);
     builder->blockEnd(true);
+
+    if (program->options.ternaryLookupStats) {
+        builder->emitIndent();
+        builder->appendFormat("struct %s_lookup_stats *", valueTypeName);
+        builder->target->emitTableLookup(builder, instanceName + "_lookup_stats",
+                                         program->zeroKey, "stats");
+        builder->endOfStatement(true);
+        builder->emitIndent();
+        builder->append("if (stats) ");
+        builder->blockStart();
+        builder->emitIndent();
+        builder->appendLine("stats->lookups++;");
+        builder->emitIndent();
+        builder->appendLine("stats->tuple_lookups += nr_tuple_lookups;");
+        builder->blockEnd(true);
+    }
 }
 
 cstring EBPFTable::p4ActionToActionIDName(const IR::P4Action * action) const {
@@ -104,7 +104,7 @@ const IR::ToplevelBlock* MidEnd::run(EbpfOptions& options,
             new P4::TableHit(&refMap, &typeMap),
             new P4::RemoveLeftSlices(&refMap, &typeMap),
             new EBPF::Lower(&refMap, &typeMap),
-            new P4::ParsersUnroll(true, &refMap, &typeMap),
+            new P4::ParsersUnroll(true, &refMap, &typeMap, options.loopsUnrollingMaxStates),
             evaluator,
             new P4::MidEndLast()
         });
@@ -30,6 +30,7 @@ limitations under the License.
 #include "ebpfOptions.h"
 #include "ebpfBackend.h"
 #include "frontends/common/applyOptionsPragmas.h"
+#include "frontends/common/compileServer.h"
 #include "frontends/common/parseInput.h"
 #include "frontends/p4/frontend.h"
 #include "ir/json_loader.h"
@@ -85,10 +86,7 @@ void compile(EbpfOptions& options) {
     EBPF::run_ebpf_backend(options, toplevel, &midend.refMap, &midend.typeMap);
 }
 
-int main(int argc, char *const argv[]) {
-    setup_gc_logging();
-    setup_signals();
-
+static int compileMain(int argc, char *const argv[]) {
     AutoCompileContext autoEbpfContext(new EbpfContext);
     auto& options = EbpfContext::get().options();
     options.compilerVersion = P4C_EBPF_VERSION_STRING;
@@ -112,3 +110,13 @@ int main(int argc, char *const argv[]) {
         std::cerr << "Done." << std::endl;
     return ::errorCount() > 0;
 }
+
+int main(int argc, char *const argv[]) {
+    setup_gc_logging();
+    setup_signals();
+
+    if (P4::CompileServer::requested(argc, argv))
+        return P4::CompileServer::serve(argc, argv, compileMain,
+                                        {{"core.p4", "ebpf_model.p4"}}, P4C_EBPF_VERSION_STRING);
+    return compileMain(argc, argv);
+}
@@ -46,7 +46,7 @@ class PSASwitchBackend {
         CodeBuilder c(target);
         // instead of generating two files, put all the code in a single file
         ebpf_program->emit(&c);
-        cstream << c.toString();
+        c.writeTo(cstream);
     }
 };
 
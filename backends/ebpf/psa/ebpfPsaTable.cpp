@@ -233,6 +233,7 @@ EBPFTablePSA::EBPFTablePSA(const EBPFProgram* program, const IR::TableBlock* tab
     initDirectCounters();
     initDirectMeters();
     initImplementation();
+    initCache();
 }
 
 EBPFTablePSA::EBPFTablePSA(const EBPFProgram* program, CodeGenInspector* codeGen, cstring name) :
@@ -286,6 +287,27 @@ void EBPFTablePSA::initImplementation() {
     }
 }
 
+void EBPFTablePSA::initCache() {
+    auto annotation = table->container->getAnnotation("psa_ebpf_cache");
+    if (annotation == nullptr)
+        return;
+
+    if (!isTernaryTable() && !isLPMTable()) {
+        ::warning(ErrorType::WARN_IGNORE,
+                  "%1%: cache only supported for ternary and lpm tables", annotation);
+        return;
+    }
+    // A cached value is a copy of the table entry, so direct externs would update the copy
+    // and a reference to an action profile member would be cached with a stale selector.
+    if (implementation != nullptr || !counters.empty() || !meters.empty()) {
+        ::warning(ErrorType::WARN_IGNORE,
+                  "%1%: cache not supported for tables with an implementation "
+                  "or direct externs", annotation);
+        return;
+    }
+    cacheEnabled = true;
+}
+
 ActionTranslationVisitor* EBPFTablePSA::createActionTranslationVisitor(
         cstring valueName, const EBPFProgram* program) const {
     return new ActionTranslationVisitorPSA(program->to<EBPFPipeline>(), valueName, this);
@@ -325,6 +347,14 @@ void EBPFTablePSA::emitInstance(CodeBuilder *builder) {
                       cstring("struct ") + valueTypeName, size);
     }
 
+    if (cacheEnabled) {
+        builder->target->emitTableDecl(builder, cacheTableName, TableHashLRU,
+                                       cstring("struct ") + keyTypeName,
+                                       cstring("struct ") + cacheValueTypeName, size);
+        builder->target->emitTableDecl(builder, cacheVersionMapName, TableArray,
+                                       program->arrayIndexType, "__u32", 1);
+    }
+
     if (implementation == nullptr) {
         // Default action is up to implementation, define it when no implementation provided
         builder->target->emitTableDecl(builder, defaultActionMapName, TableArray,
@@ -333,8 +363,81 @@ void EBPFTablePSA::emitInstance(CodeBuilder *builder) {
     }
 }
 
+/**
+ * With a cache, a lookup first tries the exact-match cache, and only on a miss performs
+ * the lookup into the table itself; a hit is then inserted into the cache. Misses are
+ * not cached, as they run the default action, which the control plane may change.
+ * A cached value is only used if it was inserted with the current version of the table
+ * entries, which the control plane increments after each change of the table.
+ */
+void EBPFTablePSA::emitLookup(CodeBuilder* builder, cstring key, cstring value) {
+    if (!cacheEnabled) {
+        EBPFTable::emitLookup(builder, key, value);
+        return;
+    }
+
+    builder->blockStart();
+    builder->emitIndent();
+    builder->append("__u32 *cache_version = ");
+    builder->target->emitTableLookup(builder, cacheVersionMapName, program->zeroKey, "");
+    builder->endOfStatement(true);
+    builder->emitIndent();
+    builder->appendFormat("struct %s *cached = ", cacheValueTypeName.c_str());
+    builder->target->emitTableLookup(builder, cacheTableName, key, "");
+    builder->endOfStatement(true);
+    builder->emitIndent();
+    builder->append("if (cached != NULL && cache_version != NULL && "
+                    "cached->version == *cache_version) ");
+    builder->blockStart();
+    builder->emitIndent();
+    builder->appendFormat("%s = &cached->value", value.c_str());
+    builder->endOfStatement(true);
+    builder->blockEnd(false);
+    builder->append(" else ");
+    builder->blockStart();
+    builder->target->emitTraceMessage(builder, "Control: cache miss, performing table lookup");
+    builder->emitIndent();
+    EBPFTable::emitLookup(builder, key, value);
+
+    builder->emitIndent();
+    builder->appendFormat("if (%s != NULL && cache_version != NULL) ", value.c_str());
+    builder->blockStart();
+    builder->emitIndent();
+    // The entry is copied, since the value points into the table
+    builder->appendFormat("struct %s cache_entry = {", cacheValueTypeName.c_str());
+    builder->newline();
+    builder->increaseIndent();
+    builder->emitIndent();
+    builder->appendLine(".version = *cache_version,");
+    builder->emitIndent();
+    builder->appendFormat(".value = *%s,", value.c_str());
+    builder->newline();
+    builder->decreaseIndent();
+    builder->emitIndent();
+    builder->append("}");
+    builder->endOfStatement(true);
+    builder->emitIndent();
+    builder->target->emitTableUpdate(builder, cacheTableName, key, "cache_entry");
+    builder->newline();
+    builder->blockEnd(true);
+    builder->blockEnd(true);
+    builder->blockEnd(true);
+}
+
 void EBPFTablePSA::emitTypes(CodeBuilder* builder) {
     EBPFTable::emitTypes(builder);
+    if (cacheEnabled) {
+        builder->emitIndent();
+        builder->appendFormat("struct %s ", cacheValueTypeName.c_str());
+        builder->blockStart();
+        builder->emitIndent();
+        builder->appendLine("__u32 version;");
+        builder->emitIndent();
+        builder->appendFormat("struct %s value;", valueTypeName.c_str());
+        builder->newline();
+        builder->blockEnd(false);
+        builder->endOfStatement(true);
+    }
     // TODO: placeholder for handling PSA-specific types
 }
 
@@ -546,7 +649,7 @@ void EBPFTablePSA::emitTableValue(CodeBuilder* builder, const IR::MethodCallExpr
 
     builder->emitIndent();
     builder->appendFormat(".u = {.%s = {", actionName.c_str());
-    for (auto p : *mi->substitution.getParametersInArgumentOrder()) {
+    for (auto p : mi->substitution.getParametersInArgumentOrder()) {
         auto arg = mi->substitution.lookup(p);
         arg->apply(cg);
         builder->append(",");
@@ -606,7 +709,7 @@ void EBPFTablePSA::emitTernaryConstEntriesInitializer(CodeBuilder *builder) {
     cstring valueMask = program->refMap->newName("value_mask");
     cstring nextMask = keyMasksNames[0];
     int noTupleId = -1;
-    emitValueMask(builder, valueMask, nextMask, noTupleId);
+    emitValueMask(builder, valueMask, nextMask, noTupleId, 0);
     builder->newline();
 
     builder->emitIndent();
@@ -628,8 +731,13 @@ void EBPFTablePSA::emitTernaryConstEntriesInitializer(CodeBuilder *builder) {
 
         if (entriesGroupedByPrefix.size() > i + 1) {
             nextMask = keyMasksNames[i + 1];
+        } else {
+            nextMask = nullptr;
         }
-        emitValueMask(builder, valueMask, nextMask, tuple_id);
+        // Groups are ordered by their first entry, which has the highest priority
+        // of the group, so the tuples are also sorted by priority.
+        emitValueMask(builder, valueMask, nextMask, tuple_id,
+                      constEntryPriority(samePrefixEntries.front()));
         builder->newline();
         emitKeysAndValues(builder, samePrefixEntries, keyNames, valueNames);
 
@@ -707,6 +815,10 @@ void EBPFTablePSA::emitKeysAndValues(CodeBuilder *builder,
         // construct value
         auto *mce = entry->action->to<IR::MethodCallExpression>();
         emitTableValue(builder, mce, valueName.c_str());
+        // Entries of different tuples may overlap; the one listed first wins
+        builder->emitIndent();
+        builder->appendFormat("%s.priority = %u", valueName, constEntryPriority(entry));
+        builder->endOfStatement(true);
     }
 }
 
@@ -788,7 +900,8 @@ void EBPFTablePSA::emitMaskForExactMatch(CodeBuilder *builder,
 }
 
 void EBPFTablePSA::emitValueMask(CodeBuilder *builder, const cstring valueMask,
-                                        const cstring nextMask, int tupleId) const {
+                                        const cstring nextMask, int tupleId,
+                                        unsigned maxPriority) const {
     builder->emitIndent();
     builder->appendFormat("struct %s_mask %s = {0}", valueTypeName, valueMask);
     builder->endOfStatement(true);
@@ -807,6 +920,30 @@ void EBPFTablePSA::emitValueMask(CodeBuilder *builder, const cstring valueMask,
         builder->appendFormat("%s.has_next = 1", valueMask);
         builder->endOfStatement(true);
     }
+    if (program->options.sortedTernaryTuples) {
+        builder->emitIndent();
+        builder->appendFormat("%s.max_priority = %u", valueMask, maxPriority);
+        builder->endOfStatement(true);
+        // Const entries cannot be changed, so their tuples stay sorted
+        if (tupleId < 0) {
+            builder->emitIndent();
+            builder->appendFormat("%s.sorted_tuples = 1", valueMask);
+            builder->endOfStatement(true);
+        }
+    }
+}
+
+/**
+ * Const entries are matched in the order they are listed, so the first entry
+ * gets the highest priority.
+ */
+unsigned EBPFTablePSA::constEntryPriority(const IR::Entry* entry) const {
+    auto entries = table->container->getEntries();
+    CHECK_NULL(entries);
+    auto it = std::find(entries->entries.begin(), entries->entries.end(), entry);
+    BUG_CHECK(it != entries->entries.end(), "%1%: not a const entry of %2%",
+              entry, table->container);
+    return entries->entries.size() - (it - entries->entries.begin());
 }
 
 /**
@@ -31,9 +31,19 @@ class EBPFTablePSA : public EBPFTable {
     std::vector<std::vector<const IR::Entry*>> getConstEntriesGroupedByPrefix();
     bool hasConstEntries();
     void emitMaskForExactMatch(CodeBuilder *builder, cstring &fieldName, EBPFType *ebpfType) const;
+    unsigned constEntryPriority(const IR::Entry* entry) const;
     const cstring addPrefixFunctionName = "add_prefix_and_entries";
     const cstring tuplesMapName = instanceName + "_tuples_map";
     const cstring prefixesMapName = instanceName + "_prefixes";
+    /// Exact-match LRU cache of the results of a ternary or LPM table,
+    /// enabled with the @psa_ebpf_cache annotation.
+    const cstring cacheTableName = instanceName + "_cache";
+    /// Single-entry map with the version of the table entries; cached values
+    /// of an older version are ignored, so that the control plane invalidates
+    /// the whole cache by incrementing it.
+    const cstring cacheVersionMapName = instanceName + "_cache_version";
+    const cstring cacheValueTypeName = valueTypeName + "_cache";
+    bool cacheEnabled = false;
 
  protected:
     ActionTranslationVisitor* createActionTranslationVisitor(
@@ -42,6 +52,7 @@ class EBPFTablePSA : public EBPFTable {
     void initDirectCounters();
     void initDirectMeters();
     void initImplementation();
+    void initCache();
 
     void emitTableValue(CodeBuilder* builder, const IR::MethodCallExpression* actionMce,
                         cstring valueName);
@@ -51,7 +62,7 @@ class EBPFTablePSA : public EBPFTable {
     void emitMapUpdateTraceMsg(CodeBuilder *builder, cstring mapName,
                                cstring returnCode) const;
     void emitValueMask(CodeBuilder *builder, cstring valueMask,
-                       cstring nextMask, int tupleId) const;
+                       cstring nextMask, int tupleId, unsigned maxPriority) const;
     void emitKeyMasks(CodeBuilder *builder,
                       std::vector<std::vector<const IR::Entry *>> &entriesGrpedByPrefix,
                       std::vector<cstring> &keyMasksNames);
@@ -79,6 +90,7 @@ class EBPFTablePSA : public EBPFTable {
     void emitAction(CodeBuilder* builder, cstring valueName, cstring actionRunVariable) override;
     void emitInitializer(CodeBuilder* builder) override;
     void emitDirectValueTypes(CodeBuilder* builder) override;
+    void emitLookup(CodeBuilder* builder, cstring key, cstring value) override;
     void emitLookupDefault(CodeBuilder* builder, cstring key, cstring value,
                            cstring actionRunVariable) override;
     bool dropOnNoMatchingEntryFound() const override;
@@ -51,6 +51,12 @@ PARSER.add_argument("-t", "--target", dest="target", default="test",
                     "default is test")
 PARSER.add_argument("-e", "--extern-file", dest="extern", default="",
                     help="Specify path additional file with C extern function definition")
+PARSER.add_argument("-s", "--stf", dest="stf", default="",
+                    help="Specify the stf file to run, "
+                    "default is the one with the name of the p4 file")
+PARSER.add_argument("-j", "--threads", dest="threads", type=int, default=1,
+                    help="Number of threads feeding packets to the program, "
+                    "only supported by the test target")
 
 
 def import_from(module, name):
@@ -89,6 +95,8 @@ class Options(object):
         # Actual location of the test framework
         self.testdir = os.path.dirname(os.path.realpath(__file__))
         self.extern = ""                # Path to C file with extern definition
+        self.stf = ""                   # Path to the stf file, if not the default one
+        self.threads = 1                # Number of threads running the test target
 
 
 def run_model(ebpf, stffile):
@@ -122,7 +130,7 @@ def run_test(options, argv):
     dirname = os.path.dirname(options.p4filename)    # Directory of the file
 
     # We can do this if an *.stf file is present
-    stffile = dirname + "/" + base + ".stf"
+    stffile = options.stf if options.stf else dirname + "/" + base + ".stf"
     if options.verbose:
         print("Checking for ", stffile)
     if not os.path.isfile(stffile):
@@ -180,6 +188,9 @@ if __name__ == '__main__':
     options.cleanupTmp = args.nocleanup
     options.target = args.target
     options.extern = args.extern
+    if args.stf:
+        options.stf = check_if_file(args.stf)
+    options.threads = args.threads
 
     # All args after '--' are intended for the p4 compiler
     argv = argv[1:]
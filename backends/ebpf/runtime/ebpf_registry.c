@@ -19,6 +19,7 @@ Implementation of ebpf registry. Intended to provide a common access interface b
 */
 
 #include <stdio.h>
+#include <pthread.h>
 #include "ebpf_registry.h"
 
 /**
@@ -40,6 +41,21 @@ static int table_indexer = 0;
 static registry_entry *reg_tables_name = NULL;
 static registry_entry *reg_tables_id = NULL;
 
+/* Protects the tables when the registry is used by several threads */
+static int reg_concurrent = 0;
+static pthread_rwlock_t reg_lock = PTHREAD_RWLOCK_INITIALIZER;
+
+#define READ_LOCK() \
+    do { if (reg_concurrent) pthread_rwlock_rdlock(&reg_lock); } while (0)
+#define WRITE_LOCK() \
+    do { if (reg_concurrent) pthread_rwlock_wrlock(&reg_lock); } while (0)
+#define UNLOCK() \
+    do { if (reg_concurrent) pthread_rwlock_unlock(&reg_lock); } while (0)
+
+void registry_set_concurrent(int concurrent) {
+    reg_concurrent = concurrent;
+}
+
 static registry_entry *find_register(const char *name) {
     if (strlen(name) > MAX_TABLE_NAME_LENGTH){
         fprintf(stderr, "Error: Key name %s exceeds maximum size %d", name, MAX_TABLE_NAME_LENGTH);
@@ -125,7 +141,10 @@ int registry_update_table(const char *name, void *key, void *value, unsigned lon
     if (tmp_tbl == NULL)
         /* not found, return */
         return EXIT_FAILURE;
-    return bpf_map_update_elem(&tmp_tbl->bpf_map, key, tmp_tbl->key_size, value, tmp_tbl->value_size, flags);
+    WRITE_LOCK();
+    int ret = bpf_map_update_elem(&tmp_tbl->bpf_map, key, tmp_tbl->key_size, value, tmp_tbl->value_size, flags);
+    UNLOCK();
+    return ret;
 }
 
 int registry_update_table_id(int tbl_id, void *key, void *value, unsigned long long flags) {
@@ -133,7 +152,10 @@ int registry_update_table_id(int tbl_id, void *key, void *value, unsigned long l
     if (tmp_tbl == NULL)
         /* not found, return */
         return EXIT_FAILURE;
-    return bpf_map_update_elem(&tmp_tbl->bpf_map, key, tmp_tbl->key_size, value, tmp_tbl->value_size, flags);
+    WRITE_LOCK();
+    int ret = bpf_map_update_elem(&tmp_tbl->bpf_map, key, tmp_tbl->key_size, value, tmp_tbl->value_size, flags);
+    UNLOCK();
+    return ret;
 }
 
 int registry_delete_table_elem(const char *name, void *key) {
@@ -141,7 +163,10 @@ int registry_delete_table_elem(const char *name, void *key) {
     if (tmp_tbl == NULL)
         /* not found, return */
         return EXIT_FAILURE;
-    return bpf_map_delete_elem(tmp_tbl->bpf_map, key, tmp_tbl->key_size);;
+    WRITE_LOCK();
+    int ret = bpf_map_delete_elem(tmp_tbl->bpf_map, key, tmp_tbl->key_size);
+    UNLOCK();
+    return ret;
 }
 
 int registry_delete_table_elem_id(int tbl_id, void *key) {
@@ -149,7 +174,10 @@ int registry_delete_table_elem_id(int tbl_id, void *key) {
     if (tmp_tbl == NULL)
         /* not found, return */
         return EXIT_FAILURE;
-    return bpf_map_delete_elem(tmp_tbl->bpf_map, key, tmp_tbl->key_size);;
+    WRITE_LOCK();
+    int ret = bpf_map_delete_elem(tmp_tbl->bpf_map, key, tmp_tbl->key_size);
+    UNLOCK();
+    return ret;
 }
 
 void *registry_lookup_table_elem(const char *name, void *key) {
@@ -157,7 +185,10 @@ void *registry_lookup_table_elem(const char *name, void *key) {
     if (tmp_tbl == NULL)
         /* not found, return */
         return NULL;
-    return bpf_map_lookup_elem(tmp_tbl->bpf_map, key, tmp_tbl->key_size);
+    READ_LOCK();
+    void *value = bpf_map_lookup_elem(tmp_tbl->bpf_map, key, tmp_tbl->key_size);
+    UNLOCK();
+    return value;
 }
 
 void *registry_lookup_table_elem_id(int tbl_id, void *key) {
@@ -165,7 +196,10 @@ void *registry_lookup_table_elem_id(int tbl_id, void *key) {
     if (tmp_tbl == NULL)
         /* not found, return */
         return NULL;
-    return bpf_map_lookup_elem(tmp_tbl->bpf_map, key, tmp_tbl->key_size);
+    READ_LOCK();
+    void *value = bpf_map_lookup_elem(tmp_tbl->bpf_map, key, tmp_tbl->key_size);
+    UNLOCK();
+    return value;
 }
 
 int registry_get_id(const char *name) {
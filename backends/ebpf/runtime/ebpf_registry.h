@@ -18,7 +18,8 @@ limitations under the License.
  * This file defines a shared registry. It is required by the p4c-ebpf test framework
  * and acts as an interface between the emulated control and data plane. It provides
  * a mechanism to access shared tables by name or id and is intended to approximate the
- * kernel ebpf object API as closely as possible. This library is currently not thread-safe.
+ * kernel ebpf object API as closely as possible. This library is only thread-safe
+ * once registry_set_concurrent() has been called.
  */
 
 #ifndef BACKENDS_EBPF_RUNTIME_EBPF_REGISTRY_H_
@@ -47,6 +48,16 @@ struct bpf_table {
     struct bpf_map *bpf_map;    // Pointer to the actual hash map
 };
 
+/**
+ * @brief Makes accesses to the registry and its tables thread-safe.
+ * @details Once enabled, lookups take a shared lock, and updates and
+ * deletions an exclusive lock. As in the kernel, a value returned by a
+ * lookup stays valid when its key is updated, but not when it is deleted,
+ * and concurrent writes to the value itself are not synchronized.
+ * Tables must not be added or removed while other threads use the registry.
+ */
+void registry_set_concurrent(int concurrent);
+
 /**
  * @brief Adds a new table to the registry.
  * @details Adds a new table to the shared registry and assigns
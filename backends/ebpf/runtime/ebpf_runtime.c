@@ -34,6 +34,7 @@ limitations under the License.
 #define DELIM   '_'
 
 static int debug = 0;
+static int stats = 0;
 
 void usage(char *name) {
     fprintf(stderr, "This program expects a pcap file pattern, "
@@ -41,11 +42,14 @@ void usage(char *name) {
             "in the order given by the packet time,"
             "then feeds the individual packets into a filter function, "
             "and returns the output.\n");
-    fprintf(stderr, "Usage: %s [-d] -f file.pcap -n num_pcaps\n", name);
+    fprintf(stderr, "Usage: %s [-d] [-s] [-j threads] -f file.pcap -n num_pcaps\n", name);
     fprintf(stderr, "Options:\n");
     fprintf(stderr, "\t-d: Turn on debug messages\n");
     fprintf(stderr, "\t-f: The input pcap file\n");
     fprintf(stderr, "\t-n: Specifies the number of input pcap files\n");
+    fprintf(stderr, "\t-j: Number of threads feeding packets to the program "
+            "(test target only, default 1)\n");
+    fprintf(stderr, "\t-s: Report packets per second of each stage\n");
     exit(EXIT_FAILURE);
 }
 
@@ -81,10 +85,17 @@ void launch_runtime(const char *pcap_name, uint16_t num_pcaps) {
     char pcap_base[baselen + 1];
     snprintf(pcap_base, baselen + 1 , "%s", pcap_name);
 
+    struct timespec start;
     /* Open all matching pcap files retrieve a merged list of packets */
+    clock_gettime(CLOCK_MONOTONIC, &start);
     input_list = get_packets(pcap_base, num_pcaps, input_list);
+    if (stats)
+        report_stage_rate("read", get_pkt_list_length(input_list), &start);
     /* Sort the list */
+    clock_gettime(CLOCK_MONOTONIC, &start);
     sort_pcap_list(input_list);
+    if (stats)
+        report_stage_rate("sort", get_pkt_list_length(input_list), &start);
     /* Run the "program" and retrieve output lists */
     RUN(ebpf_filter, pcap_base, num_pcaps, input_list, debug);
     /* Delete the list of input packets */
@@ -94,14 +105,25 @@ void launch_runtime(const char *pcap_name, uint16_t num_pcaps) {
 int main(int argc, char **argv) {
     const char *pcap_name = NULL;
     int num_pcaps = -1;
+    int num_workers = 1;
     int c;
     opterr = 0;
 
-    while ((c = getopt (argc, argv, "dn:f:")) != -1) {
+    while ((c = getopt (argc, argv, "dsj:n:f:")) != -1) {
         switch (c) {
             case 'd':
             debug = 1;
             break;
+            case 's':
+            stats = 1;
+            break;
+            case 'j':
+                num_workers = (int)strtol(optarg, (char **)NULL, 10);
+                if (num_workers < 1 || num_workers > 1024) {
+                    fprintf(stderr, "Number of threads out of bounds!\n");
+                    return EXIT_FAILURE;
+                }
+            break;
             case 'n':
                 num_pcaps = (int)strtol(optarg, (char **)NULL, 10);
                 if (num_pcaps < 0 || num_pcaps > UINT16_MAX) {
@@ -135,6 +157,7 @@ int main(int argc, char **argv) {
         usage(argv[0]);
 
     INIT_EBPF_TABLES(debug);
+    CONFIGURE_RUNTIME(num_workers, stats);
 #ifdef CONTROL_PLANE
     /* Set the default action for the userspace hash tables */
     init_tables();
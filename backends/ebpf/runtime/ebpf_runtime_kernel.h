@@ -32,6 +32,7 @@ void run_and_record_output(pcap_list_t *pkt_list, char *pcap_base, uint16_t num_
 #define RUN(ebpf_filter, pcap_base, num_pcaps, input_list, debug) \
     run_and_record_output(input_list, pcap_base, num_pcaps, debug)
 #define INIT_EBPF_TABLES(debug)
+#define CONFIGURE_RUNTIME(workers, stats)
 #define DELETE_EBPF_TABLES(debug)
 
 #endif  // BACKENDS_EBPF_RUNTIME_EBPF_RUNTIME_KERNEL_H_
@@ -18,10 +18,48 @@ limitations under the License.
 #include <ctype.h>      // isprint()
 #include <string.h>     // memcpy()
 #include <stdlib.h>     // malloc()
+#include <pthread.h>    // pthread_create()
 #include "ebpf_test.h"
 #include "ebpf_runtime_test.h"
 
 #define PCAPOUT "_out.pcap"
+/* Number of consecutive packets a worker thread takes at once */
+#define BATCH_SIZE 256
+
+static int num_workers = 1;
+static int report_stats = 0;
+
+void configure_runtime(int workers, int stats) {
+    num_workers = workers > 0 ? workers : 1;
+    report_stats = stats;
+}
+
+/* Shared state of the worker threads feeding packets into the filter */
+typedef struct {
+    packet_filter ebpf_filter;
+    pcap_list_t *pkt_list;
+    uint32_t list_len;
+    int *results;
+    uint32_t next_batch;    // index of the next packet to process
+} feed_context;
+
+static void *feed_batches(void *arg) {
+    feed_context *ctx = arg;
+    while (1) {
+        uint32_t start = __atomic_fetch_add(&ctx->next_batch, BATCH_SIZE, __ATOMIC_RELAXED);
+        if (start >= ctx->list_len)
+            break;
+        uint32_t end = start + BATCH_SIZE < ctx->list_len ? start + BATCH_SIZE : ctx->list_len;
+        for (uint32_t i = start; i < end; i++) {
+            struct sk_buff skb;
+            pcap_pkt *input_pkt = get_packet(ctx->pkt_list, i);
+            skb.data = (void *) input_pkt->data;
+            skb.len = input_pkt->pcap_hdr.len;
+            ctx->results[i] = ctx->ebpf_filter(&skb);
+        }
+    }
+    return NULL;
+}
 
 /**
  * @brief Feed a list packets into an eBPF program.
@@ -30,6 +68,11 @@ limitations under the License.
  * using the given imported ebpf_filter function. The output defines whether
  * or not the packet is "dropped." If the packet is not dropped, its content is
  * copied and appended to an output packet list.
+ * With several worker threads, batches of consecutive packets are processed
+ * concurrently, and the output list keeps the order of the input list.
+ * Packets then see the table updates made by other packets in no particular
+ * order, so this is only deterministic for programs whose result does not
+ * depend on such updates.
  *
  * @param pkt_list A list of input packets running through the filter.
  * @return The list of packets "surviving" the filter function
@@ -37,21 +80,40 @@ limitations under the License.
 pcap_list_t *feed_packets(packet_filter ebpf_filter, pcap_list_t *pkt_list, int debug) {
     pcap_list_t *output_pkts = allocate_pkt_list();
     uint32_t list_len = get_pkt_list_length(pkt_list);
+    feed_context ctx = { ebpf_filter, pkt_list, list_len, NULL, 0 };
+    ctx.results = malloc(list_len * sizeof(*ctx.results));
+    if (ctx.results == NULL && list_len > 0) {
+        perror("Fatal: Could not allocate memory\n");
+        exit(EXIT_FAILURE);
+    }
+
+    if (num_workers == 1) {
+        feed_batches(&ctx);
+    } else {
+        registry_set_concurrent(1);
+        pthread_t workers[num_workers];
+        for (int w = 0; w < num_workers; w++) {
+            if (pthread_create(&workers[w], NULL, feed_batches, &ctx) != 0) {
+                perror("Fatal: Could not create worker thread");
+                exit(EXIT_FAILURE);
+            }
+        }
+        for (int w = 0; w < num_workers; w++)
+            pthread_join(workers[w], NULL);
+        registry_set_concurrent(0);
+    }
+
     for (uint32_t i = 0; i < list_len; i++) {
-        /* Parse each packet in the list and check the result */
-        struct sk_buff skb;
-        pcap_pkt *input_pkt = get_packet(pkt_list, i);
-        skb.data = (void *) input_pkt->data;
-        skb.len = input_pkt->pcap_hdr.len;
-        int result = ebpf_filter(&skb);
-        if (result != 0) {
+        /* Check the result of each packet in the list */
+        if (ctx.results[i] != 0) {
             /* We copy the entire content to emulate an outgoing packet */
-            pcap_pkt *out_pkt = copy_pkt(input_pkt);
+            pcap_pkt *out_pkt = copy_pkt(get_packet(pkt_list, i));
             output_pkts = append_packet(output_pkts, out_pkt);
         }
         if (debug)
-            printf("Result of the eBPF parsing is: %d\n", result);
+            printf("Result of the eBPF parsing is: %d\n", ctx.results[i]);
     }
+    free(ctx.results);
     return output_pkts;
 }
 
@@ -68,14 +130,22 @@ void write_pkts_to_pcaps(const char *pcap_base, pcap_list_array_t *output_array,
 }
 
 void *run_and_record_output(packet_filter ebpf_filter, const char *pcap_base, pcap_list_t *pkt_list, int debug) {
+    struct timespec start;
     /* Create an array of packet lists */
     pcap_list_array_t *output_array = allocate_pkt_list_array();
     /* Feed the packets into our "loaded" program */
+    clock_gettime(CLOCK_MONOTONIC, &start);
     pcap_list_t *output_pkts = feed_packets(ebpf_filter, pkt_list, debug);
+    uint32_t num_output = get_pkt_list_length(output_pkts);
+    if (report_stats)
+        report_stage_rate("filter", get_pkt_list_length(pkt_list), &start);
     /* Split the output packet list by interface. This destroys the list. */
     output_array = split_and_delete_list(output_pkts, output_array);
     /* Write each list to a separate pcap output file */
+    clock_gettime(CLOCK_MONOTONIC, &start);
     write_pkts_to_pcaps(pcap_base, output_array, debug);
+    if (report_stats)
+        report_stage_rate("write", num_output, &start);
     /* Delete the array, including the data it is holding */
     delete_array(output_array);
 }
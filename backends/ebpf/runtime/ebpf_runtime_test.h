@@ -30,11 +30,13 @@ typedef int (*packet_filter)(SK_BUFF* s);
 
 void *run_and_record_output(packet_filter ebpf_filter, const char *pcap_base, pcap_list_t *pkt_list, int debug);
 void init_ebpf_tables(int debug);
+void configure_runtime(int workers, int stats);
 void delete_ebpf_tables(int debug);
 
 #define RUN(ebpf_filter, pcap_base, num_pcaps, input_list, debug) \
     run_and_record_output(ebpf_filter, pcap_base, input_list, debug)
 #define INIT_EBPF_TABLES(debug) init_ebpf_tables(debug)
+#define CONFIGURE_RUNTIME(workers, stats) configure_runtime(workers, stats)
 #define DELETE_EBPF_TABLES(debug) delete_ebpf_tables(debug)
 
 #endif  // BACKENDS_EBPF_RUNTIME_EBPF_RUNTIME_TEST_H_
@@ -16,10 +16,38 @@ limitations under the License.
 
 #include <stdlib.h>     // EXIT_SUCCESS, EXIT_FAILURE
 #include <string.h>     // memcpy()
+#include <fcntl.h>      // open()
+#include <unistd.h>     // close()
+#include <sys/mman.h>   // mmap()
+#include <sys/stat.h>   // fstat()
 #include "pcap_util.h"
 
 #define DLT_EN10MB 1        // Ethernet Link Type, see also 'man pcap-linktype'
 
+/* Magic numbers of the classic pcap format, with micro or nanosecond
+   timestamps, see also 'man pcap-savefile' */
+#define PCAP_MAGIC_USEC 0xa1b2c3d4
+#define PCAP_MAGIC_NSEC 0xa1b23c4d
+#define PCAP_MAGIC_USEC_SWAPPED 0xd4c3b2a1
+#define PCAP_MAGIC_NSEC_SWAPPED 0x4d3cb2a1
+
+struct pcap_file_hdr {
+    uint32_t magic;
+    uint16_t version_major;
+    uint16_t version_minor;
+    int32_t thiszone;
+    uint32_t sigfigs;
+    uint32_t snaplen;
+    uint32_t linktype;
+};
+
+struct pcap_record_hdr {
+    uint32_t ts_sec;
+    uint32_t ts_frac;
+    uint32_t incl_len;
+    uint32_t orig_len;
+};
+
 
 /* Dynamically-allocated list of packets.
  */
@@ -124,7 +152,84 @@ void delete_array(pcap_list_array_t *pkt_list_array) {
     free(pkt_list_array);
 }
 
+/* Append a copy of a packet to the list. The data buffer has the original
+   length of the packet, zero-filled beyond the captured bytes. */
+static pcap_list_t *append_pkt_copy(pcap_list_t *pkt_list, const struct pcap_pkthdr *pcap_hdr,
+                                    const unsigned char *data, iface_index index) {
+    pcap_pkt *pkt = calloc(1, sizeof(pcap_pkt));
+    uint32_t datalen = pcap_hdr->len > pcap_hdr->caplen ? pcap_hdr->len : pcap_hdr->caplen;
+    pkt->data = calloc(datalen, 1);
+    memcpy(pkt->data, data, pcap_hdr->caplen);
+    pkt->pcap_hdr = *pcap_hdr;
+    pkt->ifindex = index;
+    return append_packet(pkt_list, pkt);
+}
+
+/* Read a classic pcap file through a memory mapping, which saves the
+   per-packet buffering of libpcap on large captures. Returns NULL without
+   printing anything if the file is not a classic pcap file (e.g., pcapng),
+   so that the caller can fall back to libpcap. */
+static pcap_list_t *read_pkts_from_mmap(const char *pcap_file_name, iface_index index) {
+    int fd = open(pcap_file_name, O_RDONLY);
+    if (fd < 0)
+        return NULL;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t) st.st_size < sizeof(struct pcap_file_hdr)) {
+        close(fd);
+        return NULL;
+    }
+    size_t size = st.st_size;
+    const unsigned char *file = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (file == MAP_FAILED)
+        return NULL;
+    madvise((void *) file, size, MADV_SEQUENTIAL);
+
+    struct pcap_file_hdr file_hdr;
+    memcpy(&file_hdr, file, sizeof(file_hdr));
+    int swapped = 0, nsec = 0;
+    switch (file_hdr.magic) {
+        case PCAP_MAGIC_USEC: break;
+        case PCAP_MAGIC_NSEC: nsec = 1; break;
+        case PCAP_MAGIC_USEC_SWAPPED: swapped = 1; break;
+        case PCAP_MAGIC_NSEC_SWAPPED: swapped = 1; nsec = 1; break;
+        default:
+            munmap((void *) file, size);
+            return NULL;
+    }
+#define FIELD(x) (swapped ? __builtin_bswap32(x) : (x))
+    pcap_list_t *pkt_list = allocate_pkt_list();
+    size_t offset = sizeof(struct pcap_file_hdr);
+    while (offset < size) {
+        struct pcap_record_hdr rec;
+        if (size - offset < sizeof(rec)) {
+            fprintf(stderr, "Error: Truncated record header in %s\n", pcap_file_name);
+            break;
+        }
+        memcpy(&rec, file + offset, sizeof(rec));
+        offset += sizeof(rec);
+        struct pcap_pkthdr pcap_hdr;
+        pcap_hdr.ts.tv_sec = FIELD(rec.ts_sec);
+        pcap_hdr.ts.tv_usec = nsec ? FIELD(rec.ts_frac) / 1000 : FIELD(rec.ts_frac);
+        pcap_hdr.caplen = FIELD(rec.incl_len);
+        pcap_hdr.len = FIELD(rec.orig_len);
+        if (size - offset < pcap_hdr.caplen) {
+            fprintf(stderr, "Error: Truncated packet in %s\n", pcap_file_name);
+            break;
+        }
+        pkt_list = append_pkt_copy(pkt_list, &pcap_hdr, file + offset, index);
+        offset += pcap_hdr.caplen;
+    }
+#undef FIELD
+    munmap((void *) file, size);
+    return pkt_list;
+}
+
 pcap_list_t *read_pkts_from_pcap(const char *pcap_file_name, iface_index index) {
+    pcap_list_t *mapped_list = read_pkts_from_mmap(pcap_file_name, index);
+    if (mapped_list != NULL)
+        return mapped_list;
+
     struct pcap_pkthdr *pcap_hdr;
     const unsigned char *tmp_pkt;
     char errbuf[PCAP_ERRBUF_SIZE];
@@ -139,14 +244,9 @@ pcap_list_t *read_pkts_from_pcap(const char *pcap_file_name, iface_index index)
     pcap_list_t *pkt_list = allocate_pkt_list();
     /* Fill the packet list with packets */
     while ((ret = pcap_next_ex(in_handle, &pcap_hdr, &tmp_pkt)) == 1) {
-        /* Save the data we extracted from the pcap buffer */
-        pcap_pkt *pkt = calloc(1, sizeof(pcap_pkt));
-        pkt->data = calloc(pcap_hdr->len, 1);
-        memcpy(pkt->data, tmp_pkt, pcap_hdr->len);
-        /* Also save the header and the interface "index" */
-        pkt->pcap_hdr = *pcap_hdr;
-        pkt->ifindex = index;
-        pkt_list = append_packet(pkt_list, pkt);
+        /* Save the data we extracted from the pcap buffer, together with
+           the header and the interface "index" */
+        pkt_list = append_pkt_copy(pkt_list, pcap_hdr, tmp_pkt, index);
     }
     if (ret == -1)
         pcap_perror(in_handle, "Error: Failed to parse data");
@@ -253,4 +353,14 @@ char *generate_pcap_name(const char *pcap_base, int index, const char *suffix) {
         exit(EXIT_FAILURE);
     }
     return pcap_name;
-}
\ No newline at end of file
+}
+
+void report_stage_rate(const char *stage, uint32_t num_pkts, const struct timespec *start) {
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double secs = (end.tv_sec - start->tv_sec) + (end.tv_nsec - start->tv_nsec) / 1e9;
+    fprintf(stderr, "%-8s %10u packets in %9.3f s", stage, num_pkts, secs);
+    if (secs > 0)
+        fprintf(stderr, ", %12.0f packets/s", num_pkts / secs);
+    fprintf(stderr, "\n");
+}
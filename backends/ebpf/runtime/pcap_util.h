@@ -25,6 +25,7 @@ limitations under the License.
 #define PCAP_DONT_INCLUDE_PCAP_BPF_H
 #include <pcap/pcap.h>
 #include <stdint.h>     // uint32_t, uint16_t
+#include <time.h>       // struct timespec
 
 /* Interfaces are named by integers */
 typedef uint16_t iface_index;
@@ -50,6 +51,8 @@ typedef struct pcap_list_array pcap_list_array_t;
  * Allocates a packet list and fills it with the packets from the
  * supplied pcap file. All data in the capture file is copied to the new list.
  * Each packet is assigned the given interface index as meta-information.
+ * Classic pcap files are read through a memory mapping; other formats
+ * supported by libpcap (e.g., pcapng) are read with libpcap.
  * A list allocated by this function should subsequently be freed by
  * delete_list().
  *
@@ -224,4 +227,14 @@ void sort_pcap_list(pcap_list_t *pkt_list);
  */
 char *generate_pcap_name(const char *pcap_base, int index, const char *suffix);
 
+/**
+ * @brief Report the throughput of a stage of the runtime.
+ * @details Prints the number of packets handled by the stage, the time
+ * elapsed since it started, and the resulting packets per second to stderr.
+ * @param stage Name of the stage.
+ * @param num_pkts Number of packets handled by the stage.
+ * @param start Start time of the stage, as given by clock_gettime(CLOCK_MONOTONIC).
+ */
+void report_stage_rate(const char *stage, uint32_t num_pkts, const struct timespec *start);
+
 #endif  // BACKENDS_EBPF_RUNTIME_EBPF_PCAP_UTIL_H_
\ No newline at end of file
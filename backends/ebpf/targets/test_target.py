@@ -63,6 +63,9 @@ class Target(EBPFTarget):
         args += "-f " + pcap_pattern + " "
         # Number of input interfaces
         args += "-n " + str(num_files) + " "
+        # Number of threads feeding the packets
+        if self.options.threads > 1:
+            args += "-j " + str(self.options.threads) + " "
         # Debug flag (verbose output)
         args += "-d"
         errmsg = "Failed to execute the filter:"
@@ -61,6 +61,7 @@ class P4EbpfTest(BaseTest):
     skip_reason = ''
     switch_ns = 'test'
     p4_file_path = ""
+    p4c_additional_args = ""
 
     def setUp(self):
         super(P4EbpfTest, self).setUp()
@@ -79,6 +80,8 @@ class P4EbpfTest(BaseTest):
         self.test_prog_image = os.path.join("ptf_out", filename + ".o")
 
         p4args = "--Wdisable=unused --max-ternary-masks 3"
+        if self.p4c_additional_args:
+            p4args += " " + self.p4c_additional_args
         if self.is_trace_logs_enabled():
             p4args += " --trace"
 
@@ -265,6 +268,7 @@ class P4EbpfTest(BaseTest):
         if priority:
             cmd = cmd + "priority {}".format(priority)
         self.exec_ns_cmd(cmd, "Table {} failed".format(method))
+        self.table_cache_invalidate(table)
 
     def table_add(self, table, key, action=0, data=None, priority=None, references=None,
                   counters=None, meters=None):
@@ -297,6 +301,21 @@ class P4EbpfTest(BaseTest):
         if key:
             cmd = cmd + self._table_create_str_from_key(key)
         self.exec_ns_cmd(cmd, "Table delete failed")
+        self.table_cache_invalidate(table)
+
+    def table_cache_invalidate(self, table):
+        """ Increments the version of the entries of a table with @psa_ebpf_cache,
+            so that the values cached before the last change of the table are ignored.
+            Does nothing for tables without cache.
+        """
+        name = "{}_cache_version".format(table)
+        if not os.path.exists("{}/{}".format(PIPELINE_MAPS_MOUNT_PATH, name)):
+            return
+        version = int.from_bytes(bytes.fromhex(self.read_map(name, "0 0 0 0")), "little")
+        version = ((version + 1) & 0xffffffff).to_bytes(4, "little")
+        cmd = "bpftool map update pinned {}/{} key 0 0 0 0 value {}".format(
+            PIPELINE_MAPS_MOUNT_PATH, name, ' '.join(str(b) for b in version))
+        self.exec_ns_cmd(cmd, "Failed to invalidate cache of table {}".format(table))
 
     def table_set_default(self, table, action=0, data=None, counters=None, meters=None):
         """ Sets default action for table. For parameters documentation see `table_add` method.
@@ -563,6 +563,127 @@ class PSATernaryTest(P4EbpfTest):
         testutils.verify_packet(self, pkt, PORT1)
 
 
+class TernaryCachePSATest(P4EbpfTest):
+    """
+    Test that changes of a table with @psa_ebpf_cache are seen by flows whose
+    entry is already in the cache.
+    """
+
+    p4_file_path = "p4testdata/psa-ternary-cache.p4"
+
+    def runTest(self):
+        pkt = testutils.simple_ip_packet(ip_src='1.1.1.1', ip_dst='10.10.11.11')
+        self.table_add(table="ingress_tbl_fwd_ternary", key=["10.10.0.0^0xffff0000"],
+                       action=1, data=[5], priority=1)
+        # The first packet inserts the entry into the cache, the second one hits it
+        testutils.send_packet(self, PORT0, pkt)
+        testutils.verify_packet(self, pkt, PORT1)
+        testutils.send_packet(self, PORT0, pkt)
+        testutils.verify_packet(self, pkt, PORT1)
+
+        self.table_update(table="ingress_tbl_fwd_ternary", key=["10.10.0.0^0xffff0000"],
+                          action=1, data=[6], priority=1)
+        testutils.send_packet(self, PORT0, pkt)
+        testutils.verify_packet(self, pkt, PORT2)
+
+        # A new entry with a higher priority overrides the cached one
+        self.table_add(table="ingress_tbl_fwd_ternary", key=["10.10.11.0^0xffffff00"],
+                       action=2, priority=10)
+        testutils.send_packet(self, PORT0, pkt)
+        testutils.verify_no_other_packets(self)
+
+        self.table_delete(table="ingress_tbl_fwd_ternary", key=["10.10.11.0^0xffffff00"])
+        testutils.send_packet(self, PORT0, pkt)
+        testutils.verify_packet(self, pkt, PORT2)
+
+
+class TernaryOverlapPSATest(P4EbpfTest):
+    """
+    Test overlapping entries of a ternary table in different tuples, added
+    with the best match in the tuple searched last.
+    """
+
+    p4_file_path = "p4testdata/psa-ternary-overlap.p4"
+
+    def runTest(self):
+        self.table_add(table="ingress_tbl_fwd_ternary", key=["10.10.10.0^0xffffff00"],
+                       action=2, priority=1)
+        self.table_add(table="ingress_tbl_fwd_ternary", key=["10.10.0.0^0xffff0000"],
+                       action=1, data=[5], priority=5)
+        self.table_add(table="ingress_tbl_fwd_ternary", key=["10.0.0.0^0xff000000"],
+                       action=1, data=[6], priority=10)
+        pkt = testutils.simple_ip_packet(ip_src='1.1.1.1', ip_dst='10.10.10.10')
+        testutils.send_packet(self, PORT0, pkt)
+        testutils.verify_packet(self, pkt, PORT2)
+
+        self.table_delete(table="ingress_tbl_fwd_ternary", key=["10.0.0.0^0xff000000"])
+        testutils.send_packet(self, PORT0, pkt)
+        testutils.verify_packet(self, pkt, PORT1)
+
+        self.table_delete(table="ingress_tbl_fwd_ternary", key=["10.10.0.0^0xffff0000"])
+        testutils.send_packet(self, PORT0, pkt)
+        testutils.verify_no_other_packets(self)
+
+
+class TernaryOverlapSortedPSATest(TernaryOverlapPSATest):
+    """
+    Same as TernaryOverlapPSATest, with tuples which psabpf-ctl does not keep
+    sorted: the lookup must not stop early.
+    """
+
+    p4c_additional_args = "--sorted-ternary-tuples"
+
+
+class TernaryOverlapConstPSATest(P4EbpfTest):
+    """
+    Test overlapping const entries of a ternary table in different tuples.
+    """
+
+    p4_file_path = "p4testdata/psa-ternary-overlap-const.p4"
+
+    def verify_lookup_stats(self, lookups, tuple_lookups):
+        pass
+
+    def runTest(self):
+        # Matches entries in both tuples; the first tuple has the best match
+        pkt = testutils.simple_ip_packet(ip_src='1.1.1.1', ip_dst='10.10.10.10')
+        testutils.send_packet(self, PORT0, pkt)
+        testutils.verify_packet(self, pkt, PORT2)
+        self.verify_lookup_stats(1, 1)
+
+        # Matches entries in both tuples; the second tuple has the best match
+        pkt = testutils.simple_ip_packet(ip_src='1.1.1.1', ip_dst='10.10.20.1')
+        testutils.send_packet(self, PORT0, pkt)
+        testutils.verify_packet(self, pkt, PORT1)
+        self.verify_lookup_stats(2, 3)
+
+        # Only matches an entry of the second tuple
+        pkt = testutils.simple_ip_packet(ip_src='1.1.1.1', ip_dst='10.20.0.1')
+        testutils.send_packet(self, PORT0, pkt)
+        testutils.verify_packet(self, pkt, PORT1)
+        self.verify_lookup_stats(3, 5)
+
+
+class TernaryOverlapConstSortedPSATest(TernaryOverlapConstPSATest):
+    """
+    Same as TernaryOverlapConstPSATest, with sorted tuples: the lookup stops
+    after the best match, and only then.
+    """
+
+    p4c_additional_args = "--sorted-ternary-tuples --ternary-lookup-stats"
+
+    def verify_lookup_stats(self, lookups, tuple_lookups):
+        cmd = "bpftool -j map lookup pinned {}/ingress_tbl_fwd_ternary_lookup_stats " \
+              "key 0 0 0 0".format(PIPELINE_MAPS_MOUNT_PATH)
+        _, stdout, _ = self.exec_ns_cmd(cmd, "Failed to read lookup stats")
+        value = [0, 0]
+        for cpu in json.loads(stdout)['values']:
+            data = bytes(int(v, 0) for v in cpu['value'])
+            value[0] += int.from_bytes(data[0:8], "little")
+            value[1] += int.from_bytes(data[8:16], "little")
+        self.assertEqual(value, [lookups, tuple_lookups])
+
+
 class ActionDefaultTernaryPSATest(P4EbpfTest):
 
     p4_file_path = "p4testdata/action-default-ternary.p4"
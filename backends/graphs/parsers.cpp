@@ -26,11 +26,11 @@ namespace graphs {
 using Graph = ParserGraphs::Graph;
 
 static cstring toString(const IR::Expression* expression) {
-    std::stringstream ss;
-    P4::ToP4 toP4(&ss, false);
+    Util::SourceCodeBuilder builder;
+    P4::ToP4 toP4(builder, false);
     toP4.setListTerm("(", ")");
     expression->apply(toP4);
-    return cstring(ss.str());
+    return builder.toString();
 }
 
 // we always have only one subgraph
@@ -28,6 +28,7 @@ limitations under the License.
 #include "lib/crash.h"
 #include "lib/nullstream.h"
 #include "frontends/common/applyOptionsPragmas.h"
+#include "frontends/common/compileServer.h"
 #include "frontends/common/parseInput.h"
 #include "frontends/p4/evaluator/evaluator.h"
 #include "frontends/p4/frontend.h"
@@ -65,7 +66,7 @@ class P4TestOptions : public CompilerOptions {
                            file = arg;
                            return true;
                        },
-                       "read previously dumped json instead of P4 source code");
+                       "read previously dumped json (or IR snapshot) instead of P4 source code");
      }
 };
 
@@ -83,10 +84,7 @@ static void log_dump(const IR::Node *node, const char *head) {
             std::cout << *node << std::endl; }
 }
 
-int main(int argc, char *const argv[]) {
-    setup_gc_logging();
-    setup_signals();
-
+static int compileMain(int argc, char *const argv[]) {
     AutoCompileContext autoP4TestContext(new P4TestContext);
     auto& options = P4TestContext::get().options();
     options.langVersion = CompilerOptions::FrontendVersion::P4_16;
@@ -101,15 +99,13 @@ int main(int argc, char *const argv[]) {
     const IR::P4Program *program = nullptr;
     auto hook = options.getDebugHook();
     if (options.loadIRFromJson) {
-        std::ifstream json(options.file);
-        if (json) {
+        if (auto json = loadJsonFile(options.file)) {
             JSONLoader loader(json);
             const IR::Node* node = nullptr;
             loader >> node;
             if (!(program = node->to<IR::P4Program>()))
                 error(ErrorType::ERR_INVALID, "%s is not a P4Program in json format", options.file);
-        } else {
-            error(ErrorType::ERR_IO, "Can't open %s", options.file); }
+        }
     } else {
         program = P4::parseP4File(options);
 
@@ -161,6 +157,8 @@ int main(int argc, char *const argv[]) {
         if (program) {
             if (options.dumpJsonFile)
                 JSONGenerator(*openFile(options.dumpJsonFile, true), true) << program << std::endl;
+            if (options.dumpIRSnapshotFile)
+                writeIRSnapshot(*openFile(options.dumpIRSnapshotFile, true), program);
             if (options.debugJson) {
                 std::stringstream ss1, ss2;
                 JSONGenerator gen1(ss1), gen2(ss2);
@@ -188,3 +186,13 @@ int main(int argc, char *const argv[]) {
         std::cerr << "Done." << std::endl;
     return ::errorCount() > 0;
 }
+
+int main(int argc, char *const argv[]) {
+    setup_gc_logging();
+    setup_signals();
+
+    if (P4::CompileServer::requested(argc, argv))
+        return P4::CompileServer::serve(argc, argv, compileMain,
+                                        {{"core.p4", "v1model.p4"}}, P4TEST_VERSION_STRING);
+    return compileMain(argc, argv);
+}
@@ -39,7 +39,8 @@
 
 namespace P4Tools {
 
-MidEnd::MidEnd(const CompilerOptions& options) {
+MidEnd::MidEnd(const CompilerOptions& options)
+    : loopsUnrollingMaxStates(options.loopsUnrollingMaxStates) {
     setName("MidEnd");
     refMap.setIsV1(options.langVersion == CompilerOptions::FrontendVersion::P4_14);
 }
@@ -146,7 +147,7 @@ void MidEnd::addDefaultPasses() {
         // Replace any slices in the left side of assignments and convert them to casts.
         new P4::RemoveLeftSlices(&refMap, &typeMap),
         // Remove loops from parsers by unrolling them as far as the stack indices allow.
-        new P4::ParsersUnroll(true, &refMap, &typeMap),
+        new P4::ParsersUnroll(true, &refMap, &typeMap, loopsUnrollingMaxStates),
         new P4::TypeChecking(&refMap, &typeMap, true),
         mkConvertErrors(),
         // Convert tuples into structs.
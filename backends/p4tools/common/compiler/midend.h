@@ -24,6 +24,9 @@ class MidEnd : public PassManager {
     P4::ReferenceMap refMap;
     P4::TypeMap typeMap;
 
+    /// The limit on parser states evaluated when unrolling parser loops (0 for no limit).
+    size_t loopsUnrollingMaxStates;
+
     /// Provides a target-specific pass that converts P4 enums to bit<n>. The default
     /// implementation returns P4::ConvertEnums, instantiated with the policy provided by
     /// @mkChooseEnumRepresentation.
@@ -78,8 +78,8 @@ namespace UBPF {
         prog->emitH(&h, hfile);
         prog->emitC(&c, UBPF::extract_file_name(hfile.c_str()));
 
-        *cstream << c.toString();
-        *hstream << h.toString();
+        *cstream << c.release();
+        *hstream << h.release();
         cstream->flush();
         hstream->flush();
     }
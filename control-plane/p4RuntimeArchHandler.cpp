@@ -14,8 +14,6 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 
-#include <sstream>  // for std::ostringstream
-
 #include <boost/optional.hpp>
 
 #include "frontends/common/resolveReferences/referenceMap.h"
@@ -124,10 +122,10 @@ int64_t getTableSize(const IR::P4Table* table) {
 std::string serializeOneAnnotation(const IR::Annotation* annotation) {
     // we do not need custom serialization logic here: the P4Info should include
     // the annotation as it was in P4.
-    std::ostringstream oss;
-    ToP4 top4(&oss, false);
+    Util::SourceCodeBuilder builder;
+    ToP4 top4(builder, false);
     annotation->apply(top4);
-    auto serializedAnnnotation = oss.str();
+    auto serializedAnnnotation = builder.release();
     // remove the whitespace added by ToP4.
     serializedAnnnotation.pop_back();
     return serializedAnnnotation;
@@ -23,6 +23,7 @@ limitations under the License.
 #include <algorithm>
 #include <iostream>
 #include <iterator>
+#include <map>
 #include <set>
 #include <typeinfo>
 #include <unordered_map>
@@ -565,7 +566,7 @@ class P4RuntimeAnalyzer {
 
         // Allocate ids for all action parameters.
         std::vector<const IR::Parameter *> actionParams;
-        for (auto actionParam : *actionDeclaration->parameters->getEnumerator()) {
+        for (auto actionParam : *actionDeclaration->parameters) {
             actionParams.push_back(actionParam);
         }
         FieldIdAllocator<decltype(actionParams)::value_type> idAllocator(
@@ -1021,14 +1022,17 @@ class P4RuntimeEntriesConverter {
 
         int entryPriority = entriesList->entries.size();
         auto needsPriority = tableNeedsPriority(table, refMap);
+        auto keyColumns = getKeyColumns(table, refMap, typeMap);
+        ActionInfoCache actionInfos;
+        entries->mutable_updates()->Reserve(entries->updates_size() + entryPriority);
         for (auto e : entriesList->entries) {
             auto protoUpdate = entries->add_updates();
             protoUpdate->set_type(p4v1::Update::INSERT);
             auto protoEntity = protoUpdate->mutable_entity();
             auto protoEntry = protoEntity->mutable_table_entry();
             protoEntry->set_table_id(tableId);
-            addMatchKey(protoEntry, table, e->getKeys(), refMap, typeMap);
-            addAction(protoEntry, e->getAction(), refMap, typeMap);
+            addMatchKey(protoEntry, keyColumns, e->getKeys(), typeMap);
+            addAction(protoEntry, e->getAction(), actionInfos, refMap, typeMap);
             // According to the P4 specification, "Entries in a table are
             // matched in the program order, stopping at the first matching
             // entry." In P4Runtime, the lowest valid priority value is 1 and
@@ -1062,8 +1066,63 @@ class P4RuntimeEntriesConverter {
       return false;
     }
 
+    /// What the conversion of a key of the table needs to know; this is the
+    /// same for all entries, so it is only computed once per table.
+    struct KeyColumn {
+        /// P4Runtime id of the match field, or 0 if the match type is not
+        /// supported.
+        int fieldId;
+        int width;
+        cstring matchType;
+        /// Mask matching all bits of the key; only set for ternary keys.
+        boost::optional<std::string> fullMask;
+    };
+
+    /// The action id and the width of the parameters of an action used by
+    /// the entries of a table.
+    struct ActionInfo {
+        p4rt_id_t id;
+        std::vector<int> parameterWidths;
+    };
+    using ActionInfoCache = std::map<const IR::P4Action*, ActionInfo>;
+
+    std::vector<KeyColumn> getKeyColumns(const IR::P4Table* table, ReferenceMap* refMap,
+                                         TypeMap* typeMap) const {
+        std::vector<KeyColumn> columns;
+        int fieldId = 1;
+        for (auto tableKey : table->getKey()->keyElements) {
+            KeyColumn column;
+            column.width = getTypeWidth(tableKey->expression->type, typeMap);
+            column.matchType = getKeyMatchType(tableKey, refMap);
+            if (column.matchType == P4CoreLibrary::instance.exactMatch.name ||
+                column.matchType == P4CoreLibrary::instance.lpmMatch.name ||
+                column.matchType == P4CoreLibrary::instance.ternaryMatch.name ||
+                column.matchType == P4V1::V1Model::instance.rangeMatchType.name ||
+                column.matchType == P4V1::V1Model::instance.optionalMatchType.name)
+                column.fieldId = fieldId++;
+            else
+                column.fieldId = 0;
+            if (column.matchType == P4CoreLibrary::instance.ternaryMatch.name)
+                column.fullMask = stringReprConstant(Util::mask(column.width), column.width);
+            columns.push_back(column);
+        }
+        return columns;
+    }
+
+    const ActionInfo& getActionInfo(const IR::P4Action* actionDecl, ActionInfoCache& cache,
+                                    TypeMap* typeMap) const {
+        auto it = cache.find(actionDecl);
+        if (it != cache.end()) return it->second;
+        auto& info = cache[actionDecl];
+        info.id = symbols.getId(P4RuntimeSymbolType::ACTION(), actionDecl->controlPlaneName());
+        for (auto parameter : actionDecl->parameters->parameters)
+            info.parameterWidths.push_back(getTypeWidth(parameter->type, typeMap));
+        return info;
+    }
+
     void addAction(p4v1::TableEntry* protoEntry,
                    const IR::Expression* actionRef,
+                   ActionInfoCache& actionInfos,
                    ReferenceMap* refMap,
                    TypeMap* typeMap) const {
         if (!actionRef->is<IR::MethodCallExpression>()) {
@@ -1075,18 +1134,17 @@ class P4RuntimeEntriesConverter {
         auto method = actionCall->method->to<IR::PathExpression>()->path;
         auto decl = refMap->getDeclaration(method, true);
         auto actionDecl = decl->to<IR::P4Action>();
-        auto actionName = actionDecl->controlPlaneName();
-        auto actionId = symbols.getId(P4RuntimeSymbolType::ACTION(), actionName);
+        auto& actionInfo = getActionInfo(actionDecl, actionInfos, typeMap);
 
         auto protoAction = protoEntry->mutable_action()->mutable_action();
-        protoAction->set_action_id(actionId);
+        protoAction->set_action_id(actionInfo.id);
+        protoAction->mutable_params()->Reserve(actionCall->arguments->size());
         int parameterIndex = 0;
         int parameterId = 1;
         for (auto arg : *actionCall->arguments) {
             auto protoParam = protoAction->add_params();
             protoParam->set_param_id(parameterId++);
-            auto parameter = actionDecl->parameters->parameters.at(parameterIndex++);
-            int width = getTypeWidth(parameter->type, typeMap);
+            int width = actionInfo.parameterWidths.at(parameterIndex++);
             auto ei = EnumInstance::resolve(arg->expression, typeMap);
             if (arg->expression->is<IR::Constant>()) {
                 auto value = stringRepr(arg->expression->to<IR::Constant>(), width);
@@ -1107,27 +1165,25 @@ class P4RuntimeEntriesConverter {
     }
 
     void addMatchKey(p4v1::TableEntry* protoEntry,
-                     const IR::P4Table* table,
+                     const std::vector<KeyColumn>& keyColumns,
                      const IR::ListExpression* keyset,
-                     ReferenceMap* refMap,
                      TypeMap* typeMap) const {
         int keyIndex = 0;
-        int fieldId = 1;
         for (auto k : keyset->components) {
-            auto tableKey = table->getKey()->keyElements.at(keyIndex++);
-            auto keyWidth = getTypeWidth(tableKey->expression->type, typeMap);
-            auto matchType = getKeyMatchType(tableKey, refMap);
+            auto& column = keyColumns.at(keyIndex++);
+            auto keyWidth = column.width;
+            auto matchType = column.matchType;
 
             if (matchType == P4CoreLibrary::instance.exactMatch.name) {
-              addExact(protoEntry, fieldId++, k, keyWidth, typeMap);
+              addExact(protoEntry, column.fieldId, k, keyWidth, typeMap);
             } else if (matchType == P4CoreLibrary::instance.lpmMatch.name) {
-              addLpm(protoEntry, fieldId++, k, keyWidth, typeMap);
+              addLpm(protoEntry, column.fieldId, k, keyWidth, typeMap);
             } else if (matchType == P4CoreLibrary::instance.ternaryMatch.name) {
-              addTernary(protoEntry, fieldId++, k, keyWidth, typeMap);
+              addTernary(protoEntry, column.fieldId, k, keyWidth, column.fullMask, typeMap);
             } else if (matchType == P4V1::V1Model::instance.rangeMatchType.name) {
-              addRange(protoEntry, fieldId++, k, keyWidth, typeMap);
+              addRange(protoEntry, column.fieldId, k, keyWidth, typeMap);
             } else if (matchType == P4V1::V1Model::instance.optionalMatchType.name) {
-              addOptional(protoEntry, fieldId++, k, keyWidth, typeMap);
+              addOptional(protoEntry, column.fieldId, k, keyWidth, typeMap);
             } else {
                 if (!k->is<IR::DefaultExpression>())
                     ::error(ErrorType::ERR_UNSUPPORTED,
@@ -1249,6 +1305,7 @@ class P4RuntimeEntriesConverter {
 
     void addTernary(p4v1::TableEntry* protoEntry, int fieldId,
                     const IR::Expression* k, int keyWidth,
+                    const boost::optional<std::string>& fullMask,
                     TypeMap* typeMap) const {
         if (k->is<IR::DefaultExpression>())  // don't care, skip in P4Runtime message
             return;
@@ -1271,7 +1328,7 @@ class P4RuntimeEntriesConverter {
             maskStr = stringReprConstant(*mask, keyWidth);
         } else {
             valueStr = convertSimpleKeyExpression(k, keyWidth, typeMap);
-            maskStr = stringReprConstant(Util::mask(keyWidth), keyWidth);
+            maskStr = fullMask;
         }
         if (valueStr == boost::none || maskStr == boost::none) return;
         auto protoMatch = protoEntry->add_match();
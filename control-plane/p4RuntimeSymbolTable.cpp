@@ -15,11 +15,10 @@ limitations under the License.
 */
 #include "p4RuntimeSymbolTable.h"
 
+#include <algorithm>
 #include <iosfwd>
 #include <unordered_map>
-
-#include <boost/algorithm/string/split.hpp>
-#include <boost/range/adaptor/reversed.hpp>
+#include <vector>
 
 #include "lib/cstring.h"
 
@@ -256,44 +255,78 @@ void P4::ControlPlaneAPI::P4RuntimeSymbolTable::computeIdsForSymbols(
     //   [resource type] [name hash value]
     //    \____8_b____/   \_____24_b____/
     auto& symbolTable = symbolTables.at(type);
-    auto resourceType = static_cast<p4rt_id_t>(type);
-
-    // Extract the names of every resource in the collection that does not
-    // already have an id assigned and associate them with an iterator that
-    // we can use to access them again later.  The names are stored in a
-    // std::map to ensure that they're sorted. This is necessary to provide
-    // deterministic ids; see below for details.
-    std::map<cstring, SymbolTable::iterator> nameToIteratorMap;
-    for (auto it = symbolTable.begin(); it != symbolTable.end(); it++) {
-        if (it->second == INVALID_ID) {
-            nameToIteratorMap.emplace(std::make_pair(it->first, it));
+    const p4rt_id_t typePrefix = static_cast<p4rt_id_t>(type) << 24;
+    const p4rt_id_t hashMask = 0xffffff;
+
+    // Collect every resource in the collection that does not already have an
+    // id assigned, sorted by name. This is necessary to provide deterministic
+    // ids; see below for details.
+    std::vector<SymbolTable::value_type*> unassigned;
+    for (auto& symbol : symbolTable) {
+        if (symbol.second == INVALID_ID) {
+            unassigned.push_back(&symbol);
         }
     }
+    if (unassigned.empty()) {
+        return;
+    }
+    std::sort(unassigned.begin(), unassigned.end(),
+              [](const SymbolTable::value_type* a, const SymbolTable::value_type* b) {
+                  return a->first < b->first;
+              });
+
+    // Hash the name and construct an id. Because linear probing is used to
+    // resolve hash collisions, the id that we select depends on the order in
+    // which the names are hashed. This is why we sort the names above.
+    if (unassigned.size() < idBitmapThreshold) {
+        for (auto* symbol : unassigned) {
+            const cstring name = symbol->first;
+            const uint32_t nameId = jenkinsOneAtATimeHash(name.c_str(), name.size());
+            boost::optional<p4rt_id_t> id =
+                probeForId(nameId, [=](uint32_t nameId) {
+                    return typePrefix | (nameId & hashMask);
+                });
+            if (!id) {
+                ::error(ErrorType::ERR_OVERLIMIT,
+                        "No available id to represent %1% in P4Runtime", name);
+                return;
+            }
+            assignedIds.insert(*id);
+            symbol->second = *id;
+        }
+        return;
+    }
 
-    for (const auto& mapping : nameToIteratorMap) {
-        const cstring name = mapping.first;
-        const auto iterator = mapping.second;
-        const uint32_t nameId =
-            jenkinsOneAtATimeHash(name.c_str(), name.size());
-
-        // Hash the name and construct an id. Because linear probing is used
-        // to resolve hash collisions, the id that we select depends on the
-        // order in which the names are hashed. This is why we sort the
-        // names above.
-        boost::optional<p4rt_id_t> id =
-            probeForId(nameId, [=](uint32_t nameId) {
-                return (resourceType << 24) | (nameId & 0xffffff);
-            });
+    // Mark the hash values of the ids of this type which are already taken.
+    std::vector<bool> taken(hashMask + 1);
+    size_t available = taken.size();
+    for (auto id : assignedIds) {
+        if ((id & ~hashMask) == typePrefix && !taken[id & hashMask]) {
+            taken[id & hashMask] = true;
+            available--;
+        }
+    }
+    assignedIds.reserve(assignedIds.size() + unassigned.size());
 
-        if (!id) {
+    for (auto* symbol : unassigned) {
+        const cstring name = symbol->first;
+        if (available == 0) {
             ::error(ErrorType::ERR_OVERLIMIT,
                     "No available id to represent %1% in P4Runtime", name);
             return;
         }
 
+        uint32_t nameId = jenkinsOneAtATimeHash(name.c_str(), name.size()) & hashMask;
+        while (taken[nameId]) {
+            nameId = (nameId + 1) & hashMask;
+        }
+        taken[nameId] = true;
+        available--;
+
         // Update the resource in place with the new id.
-        assignedIds.insert(*id);
-        iterator->second = *id;
+        const p4rt_id_t id = typePrefix | nameId;
+        assignedIds.insert(id);
+        symbol->second = id;
     }
 }
 
@@ -312,46 +345,71 @@ uint32_t P4::ControlPlaneAPI::P4RuntimeSymbolTable::jenkinsOneAtATimeHash(
     return hash;
 }
 
+P4::ControlPlaneAPI::P4SymbolSuffixSet::Components
+P4::ControlPlaneAPI::P4SymbolSuffixSet::reversedComponents(const cstring& symbol) {
+    Components components;
+    std::string_view rest(symbol.c_str(), symbol.size());
+    for (auto dot = rest.rfind('.'); dot != std::string_view::npos; dot = rest.rfind('.')) {
+        components.push_back(rest.substr(dot + 1));
+        rest = rest.substr(0, dot);
+    }
+    components.push_back(rest);
+    return components;
+}
+
 cstring P4::ControlPlaneAPI::P4SymbolSuffixSet::shortestUniqueSuffix(
     const cstring& symbol) const {
     BUG_CHECK(!symbol.isNullOrEmpty(), "Null or empty symbol name?");
-    std::vector<cstring> components;
-    const char* cSymbol = symbol.c_str();
-    boost::split(components, cSymbol, [](char c) { return c == '.'; });
+    if (sortedSuffixes.size() != symbols.size()) {
+        sortedSuffixes.clear();
+        sortedSuffixes.reserve(symbols.size());
+        for (auto s : symbols) {
+            sortedSuffixes.push_back(reversedComponents(s));
+        }
+        std::sort(sortedSuffixes.begin(), sortedSuffixes.end());
+    }
+    auto components = reversedComponents(symbol);
 
     // Determine how many suffix components we need to uniquely identify
     // this symbol. For example, if we have the symbols "d.a.c" and "e.b.c",
     // the suffixes "a.c" and "b.c" are enough to identify the symbols
-    // uniquely, so in both cases we only need two components.
+    // uniquely, so in both cases we only need two components. [first, last)
+    // holds the symbols which end with the components seen so far; the
+    // symbols which end with exactly these components sort first.
     unsigned neededComponents = 0;
-    auto* node = suffixesRoot;
-    for (auto& component : boost::adaptors::reverse(components)) {
-        if (node->edges.find(component) == node->edges.end()) {
+    auto first = sortedSuffixes.cbegin();
+    auto last = sortedSuffixes.cend();
+    for (auto component : components) {
+        const auto index = neededComponents;
+        first = std::lower_bound(first, last, component,
+            [index](const Components& suffix, std::string_view component) {
+                return suffix.size() <= index || suffix[index] < component;
+            });
+        last = std::upper_bound(first, last, component,
+            [index](std::string_view component, const Components& suffix) {
+                return suffix.size() > index && component < suffix[index];
+            });
+        if (first == last) {
             BUG("Symbol is not in suffix set: %1%", symbol);
         }
-
-        node = node->edges[component];
         neededComponents++;
 
-        // If there's only one suffix that passes through this node, we have
-        // a unique suffix right now, and we don't need the remaining
-        // components.
-        if (node->instances < 2) {
+        // If there's only one symbol with this suffix, we have a unique
+        // suffix right now, and we don't need the remaining components.
+        if (last - first < 2) {
             break;
         }
     }
 
     // Serialize the suffix components into the final unique suffix that
     // we'll return.
-    BUG_CHECK(neededComponents <= components.size(), "Too many components?");
     std::string uniqueSuffix;
-    std::for_each(components.end() - neededComponents, components.end(),
-                  [&](const cstring& component) {
-                      if (!uniqueSuffix.empty()) {
-                          uniqueSuffix.append(".");
-                      }
-                      uniqueSuffix.append(component);
-                  });
+    for (auto i = neededComponents; i-- > 0;) {
+        if (!uniqueSuffix.empty()) {
+            uniqueSuffix.append(".");
+        }
+        uniqueSuffix.append(components[i]);
+    }
 
     return uniqueSuffix;
 }
@@ -360,7 +418,7 @@ void P4::ControlPlaneAPI::P4SymbolSuffixSet::addSymbol(const cstring& symbol) {
     BUG_CHECK(!symbol.isNullOrEmpty(), "Null or empty symbol name?");
 
     // Check if the symbol is already in the set. This is necessary because
-    // adding the same symbol more than once will break the algorithm below.
+    // adding the same symbol more than once would count its suffixes twice.
     // TODO(antonin): In the future we may be able to eliminate this check,
     // since we already check for duplicate symbols in P4RuntimeSymbolTable.
     // There are some edge cases, though - for example, symbols of different
@@ -368,34 +426,7 @@ void P4::ControlPlaneAPI::P4SymbolSuffixSet::addSymbol(const cstring& symbol) {
     // in P4-16 due to annotations. Until we handle those cases more
     // strictly and have tests for them, it's safest to ensure this
     // precondition here.
-    {
-        auto result = symbols.insert(symbol);
-        if (!result.second) {
-            return;  // It was already present.
-        }
-    }
-
-    // Split the symbol name into dot-separated components.
-    std::vector<cstring> components;
-    const char* cSymbol = symbol.c_str();
-    boost::split(components, cSymbol, [](char c) { return c == '.'; });
-
-    // Insert the components into our tree of suffixes. We work
-    // right-to-left through the symbol name, since we're concerned with
-    // suffixes. The edges represent components, and the nodes track how
-    // many suffixes pass through that node. For example, if we have symbols
-    // "a.b.c", "b.c", and "a.d.c", the tree will look like this:
-    //   (root) -> "c" -> (3) -> "b" -> (2) -> "a" -> (1)
-    //                       \-> "d" -> (1) -> "a" -> (1)
-    // (Nodes are in parentheses, and edge labels are in quotes.)
-    auto* node = suffixesRoot;
-    for (auto& component : boost::adaptors::reverse(components)) {
-        if (node->edges.find(component) == node->edges.end()) {
-            node->edges[component] = new SuffixNode;
-        }
-        node = node->edges[component];
-        node->instances++;
-    }
+    symbols.insert(symbol);
 }
 
 }  // namespace ControlPlaneAPI
@@ -17,6 +17,11 @@ limitations under the License.
 #ifndef CONTROL_PLANE_P4RUNTIMESYMBOLTABLE_H_
 #define CONTROL_PLANE_P4RUNTIMESYMBOLTABLE_H_
 
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
 #include "lib/cstring.h"
 
 #include "p4RuntimeArchHandler.h"
@@ -66,27 +71,21 @@ struct P4SymbolSuffixSet {
     cstring shortestUniqueSuffix(const cstring& symbol) const;
 
  private:
+    using Components = std::vector<std::string_view>;
+
+    /// @return the path components of @symbol, last first.
+    static Components reversedComponents(const cstring& symbol);
+
     // All symbols in the set. We store these separately to make sure that no
-    // symbol is added to the tree of suffixes more than once.
-    std::set<cstring> symbols;
-
-    // A node in the tree of suffixes. The tree of suffixes is a directed graph
-    // of path components, with the edges pointing from the each component to
-    // its predecessor, so that every suffix of every symbol corresponds to a
-    // path through the tree. For example, "foo.bar[1].baz" would be represented
-    // as "baz" -> "bar[1]" -> "foo".
-    struct SuffixNode {
-        // How many suffixes pass through this node? This includes suffixes that
-        // terminate at this node.
-        unsigned instances = 0;
-
-        // Outgoing edges from this node. The SuffixNode should never be null.
-        std::map<cstring, SuffixNode*> edges;
-    };
-
-    // The root of our tree of suffixes. Note that this is *not* the data
-    // structure known as a suffix tree.
-    SuffixNode* suffixesRoot = new SuffixNode;
+    // symbol is added to the array of suffixes more than once.
+    std::unordered_set<cstring> symbols;
+
+    // The symbols as their path components in reverse order, sorted; for
+    // example, "foo.bar[1].baz" is {"baz", "bar[1]", "foo"}. This flat array
+    // replaces a tree of suffixes: the symbols which share a suffix are
+    // adjacent, so their number is found by binary search. It is sorted when
+    // the first suffix is looked up after symbols were added.
+    mutable std::vector<Components> sortedSuffixes;
 };
 
 /// A table which tracks the symbols which are visible to P4Runtime and their
@@ -162,10 +161,18 @@ class P4RuntimeSymbolTable : public P4RuntimeSymbolTableIface {
     /**
      * Assign an id to each resource of @type (ACTION, TABLE, etc..)  which does
      * not yet have an id, and update the resource in place.  Existing ids are
-     * avoided to ensure that each id is unique.
+     * avoided to ensure that each id is unique.  With many resources, the ids
+     * of @type already in use are marked in a bitmap of the 24-bit name hash
+     * space, and each name takes the first free slot from its hash onwards;
+     * this is the same linear probing as probeForId(), without a set lookup
+     * per probe.
      */
     void computeIdsForSymbols(P4RuntimeSymbolType type);
 
+    /// The number of resources of a type from which computeIdsForSymbols()
+    /// uses a bitmap, whose 2 MB are not worth it for fewer resources.
+    static constexpr size_t idBitmapThreshold = 4096;
+
     /**
      * Construct an id from the provided @sourceValue using the provided
      * function
@@ -199,10 +206,10 @@ class P4RuntimeSymbolTable : public P4RuntimeSymbolTableIface {
     // All the ids we've assigned so far. Used to avoid id collisions; this is
     // especially crucial since ids can be set manually via the '@id'
     // annotation.
-    std::set<p4rt_id_t> assignedIds;
+    std::unordered_set<p4rt_id_t> assignedIds;
 
     // Symbol tables, mapping symbols to P4Runtime ids.
-    using SymbolTable = std::map<cstring, p4rt_id_t>;
+    using SymbolTable = std::unordered_map<cstring, p4rt_id_t>;
     std::map<P4RuntimeSymbolType, SymbolTable> symbolTables{};
 
     // A set which contains all the symbols in the program. It's used to compute
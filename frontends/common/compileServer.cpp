@@ -0,0 +1,366 @@
+/*
+Copyright 2013-present Barefoot Networks, Inc.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "compileServer.h"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "frontends/common/options.h"
+#include "frontends/common/parseInput.h"
+#include "frontends/common/precompiledIncludes.h"
+#include "lib/error.h"
+#include "lib/log.h"
+
+namespace P4 {
+
+namespace {
+
+/// Requests larger than this are not compile requests.
+const uint32_t maxRequestSize = 1 << 20;
+
+volatile sig_atomic_t stopRequested = 0;
+/// Written to by the SIGCHLD handler, so that poll() wakes up when a
+/// compilation is done.
+int childPipe[2] = { -1, -1 };
+
+void onStop(int) { stopRequested = 1; }
+
+void onChild(int) {
+    int saved = errno;
+    char c = 0;
+    if (write(childPipe[1], &c, 1) < 0) {}  // the pipe is full: poll() will wake up anyway
+    errno = saved;
+}
+
+void setHandler(int sig, void (*handler)(int)) {
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = handler;
+    sigemptyset(&action.sa_mask);
+    sigaction(sig, &action, nullptr);
+}
+
+bool readFully(int fd, char* data, size_t size) {
+    while (size > 0) {
+        auto n = read(fd, data, size);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        data += n;
+        size -= n;
+    }
+    return true;
+}
+
+bool writeFully(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        auto n = write(fd, data, size);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        data += n;
+        size -= n;
+    }
+    return true;
+}
+
+struct Request {
+    std::string cwd;
+    std::vector<std::string> args;
+    int out = -1;
+    int err = -1;
+
+    ~Request() {
+        if (out >= 0) close(out);
+        if (err >= 0) close(err);
+    }
+};
+
+/// A request is a 32-bit length in host byte order followed by that many bytes
+/// of NUL-terminated strings: the working directory and the arguments of the
+/// command line (without the program name).  The first message of the
+/// request carries the standard output and error of the client.
+bool receive(int conn, Request& request) {
+    uint32_t size = 0;
+    union {
+        char buffer[CMSG_SPACE(2 * sizeof(int))];
+        struct cmsghdr align;
+    } control;
+    struct iovec iov = { &size, sizeof(size) };
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.buffer;
+    msg.msg_controllen = sizeof(control.buffer);
+    ssize_t n;
+    do {
+        n = recvmsg(conn, &msg, MSG_CMSG_CLOEXEC);
+    } while (n < 0 && errno == EINTR);
+    if (n <= 0) return false;
+
+    for (auto cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+        if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS) continue;
+        size_t count = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+        int fds[2] = { -1, -1 };
+        memcpy(fds, CMSG_DATA(cmsg), std::min(count, size_t(2)) * sizeof(int));
+        request.out = fds[0];
+        request.err = fds[1];
+    }
+    if (request.out < 0 || request.err < 0 || (msg.msg_flags & MSG_CTRUNC)) return false;
+    if (static_cast<size_t>(n) < sizeof(size) &&
+        !readFully(conn, reinterpret_cast<char*>(&size) + n, sizeof(size) - n))
+        return false;
+    if (size == 0 || size > maxRequestSize) return false;
+
+    std::string data(size, '\0');
+    if (!readFully(conn, &data[0], size) || data.back() != '\0') return false;
+    for (size_t pos = 0; pos < data.size(); ) {
+        auto end = data.find('\0', pos);
+        if (request.cwd.empty())
+            request.cwd = data.substr(pos, end - pos);
+        else
+            request.args.push_back(data.substr(pos, end - pos));
+        pos = end + 1;
+    }
+    return !request.cwd.empty();
+}
+
+/// Reads the request of the client connected on @conn and compiles it.
+/// Runs in the forked process, so that a client which is slow to send its
+/// request only holds its own process; never returns.
+[[noreturn]] void serveRequest(const char* program, int conn,
+                               const CompileServer::Compile& compile) {
+    setHandler(SIGCHLD, SIG_DFL);
+    setHandler(SIGINT, SIG_DFL);
+    setHandler(SIGTERM, SIG_DFL);
+    setHandler(SIGPIPE, SIG_DFL);
+    close(childPipe[0]);
+    close(childPipe[1]);
+
+    // Clients send their request right away
+    struct timeval timeout = { 5, 0 };
+    setsockopt(conn, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    Request request;
+    if (!receive(conn, request)) {
+        LOG1("Ignoring an invalid compile request");
+        _exit(1);
+    }
+    close(conn);
+
+    fflush(nullptr);
+    if (dup2(request.out, STDOUT_FILENO) < 0 || dup2(request.err, STDERR_FILENO) < 0)
+        _exit(1);
+    if (chdir(request.cwd.c_str()) != 0) {
+        std::cerr << request.cwd << ": " << strerror(errno) << std::endl;
+        _exit(1);
+    }
+
+    std::vector<char*> argv;
+    argv.push_back(const_cast<char*>(program));
+    for (auto& arg : request.args)
+        argv.push_back(&arg[0]);
+    argv.push_back(nullptr);
+    int rc = compile(argv.size() - 1, argv.data());
+    std::cout.flush();
+    std::cerr.flush();
+    fflush(nullptr);
+    _exit(rc);
+}
+
+/// Parses @includes in advance, as a program that only includes them.
+void parseIncludes(CompilerOptions& options, const std::vector<cstring>& includes) {
+    char name[] = "/tmp/p4c-server-XXXXXX.p4";
+    int fd = mkstemps(name, 3);
+    if (fd < 0) {
+        ::warning(ErrorType::WARN_FAILED,
+                  "Could not parse the standard include files in advance: %1%",
+                  strerror(errno));
+        return;
+    }
+    std::string text;
+    for (auto include : includes)
+        text += "#include <" + std::string(include) + ">\n";
+    bool written = writeFully(fd, text.data(), text.size());
+    close(fd);
+    if (written) {
+        options.file = name;
+        auto before = PrecompiledIncludes::stats;
+        if (parseP4File(options) != nullptr)
+            LOG1("Parsed in advance (" <<
+                 PrecompiledIncludes::stats.diskHits - before.diskHits << " from cache):\n"
+                 << text);
+    }
+    unlink(name);
+}
+
+/// Parses the standard include files in advance, with the frontend options
+/// in @args.  Errors in the include files are reported, but do not stop the
+/// server: compilations will report them again.
+/// @return false if the options are not valid.
+bool warmUp(const char* program, const std::vector<char*>& args,
+            const std::vector<std::vector<cstring>>& preludes, cstring version) {
+    AutoCompileContext context(new P4CContextWithOptions<CompilerOptions>);
+    auto& options = P4CContextWithOptions<CompilerOptions>::get().options();
+    options.langVersion = CompilerOptions::FrontendVersion::P4_16;
+    options.compilerVersion = version;
+
+    std::vector<char*> argv;
+    argv.push_back(const_cast<char*>(program));
+    argv.insert(argv.end(), args.begin(), args.end());
+    argv.push_back(nullptr);
+    options.process(argv.size() - 1, argv.data());
+    if (::errorCount() > 0)
+        return false;
+    for (auto& includes : preludes)
+        parseIncludes(options, includes);
+    return true;
+}
+
+}  // namespace
+
+/* static */ bool CompileServer::requested(int argc, char* const argv[]) {
+    return argc >= 2 && strcmp(argv[1], "--server") == 0;
+}
+
+/* static */ int CompileServer::serve(int argc, char* const argv[], Compile compile,
+                                      const std::vector<std::vector<cstring>>& preludes,
+                                      cstring version) {
+    BUG_CHECK(requested(argc, argv), "Not a compile server command line");
+    if (argc < 3) {
+        std::cerr << argv[0] << ": --server requires the path of a socket" << std::endl;
+        return 1;
+    }
+    const char* path = argv[2];
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        std::cerr << path << ": socket path too long" << std::endl;
+        return 1;
+    }
+    strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+
+    if (!warmUp(argv[0], std::vector<char*>(argv + 3, argv + argc), preludes, version))
+        return 1;
+
+    // A socket left behind by a server that did not exit cleanly
+    struct stat st;
+    if (lstat(path, &st) == 0 && S_ISSOCK(st.st_mode))
+        unlink(path);
+    int server = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (server < 0 ||
+        bind(server, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        listen(server, SOMAXCONN) != 0) {
+        std::cerr << path << ": " << strerror(errno) << std::endl;
+        return 1;
+    }
+    if (pipe2(childPipe, O_CLOEXEC | O_NONBLOCK) != 0) {
+        std::cerr << "pipe: " << strerror(errno) << std::endl;
+        return 1;
+    }
+    setHandler(SIGCHLD, onChild);
+    setHandler(SIGINT, onStop);
+    setHandler(SIGTERM, onStop);
+    // Clients may go away at any time
+    setHandler(SIGPIPE, SIG_IGN);
+
+    size_t maxJobs = std::max(1u, std::thread::hardware_concurrency());
+    std::map<pid_t, int> jobs;  // running compilation -> connection of the client
+    if (Log::verbose())
+        std::cerr << argv[0] << ": serving on " << path << std::endl;
+
+    while (!stopRequested) {
+        pid_t pid;
+        int status;
+        while ((pid = waitpid(-1, &status, WNOHANG)) > 0) {
+            auto job = jobs.find(pid);
+            if (job == jobs.end()) continue;
+            int32_t rc = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+            writeFully(job->second, reinterpret_cast<const char*>(&rc), sizeof(rc));
+            close(job->second);
+            jobs.erase(job);
+        }
+
+        std::vector<struct pollfd> fds;
+        fds.push_back({ childPipe[0], POLLIN, 0 });
+        // Only accept more requests if there is a processor to compile them
+        fds.push_back({ jobs.size() < maxJobs ? server : -1, POLLIN, 0 });
+        // A client that disconnects has been interrupted
+        for (auto& job : jobs)
+            fds.push_back({ job.second, 0, 0 });
+        if (poll(fds.data(), fds.size(), -1) < 0) {
+            if (errno == EINTR) continue;
+            std::cerr << "poll: " << strerror(errno) << std::endl;
+            break;
+        }
+
+        char drain[64];
+        while (read(childPipe[0], drain, sizeof(drain)) > 0) {}
+        auto job = jobs.begin();
+        for (size_t i = 2; i < fds.size(); ++i, ++job)
+            if (fds[i].revents & (POLLHUP | POLLERR))
+                kill(job->first, SIGTERM);
+
+        if (!(fds[1].revents & POLLIN)) continue;
+        int conn = accept4(server, nullptr, nullptr, SOCK_CLOEXEC);
+        if (conn < 0) continue;
+        pid = fork();
+        if (pid == 0) {
+            close(server);
+            for (auto& j : jobs)
+                close(j.second);
+            serveRequest(argv[0], conn, compile);
+        }
+        if (pid < 0) {
+            LOG1("fork: " << strerror(errno));
+            int32_t rc = 1;
+            writeFully(conn, reinterpret_cast<const char*>(&rc), sizeof(rc));
+            close(conn);
+            continue;
+        }
+        jobs.emplace(pid, conn);
+    }
+
+    for (auto& job : jobs)
+        kill(job.first, SIGTERM);
+    for (auto& job : jobs) {
+        waitpid(job.first, nullptr, 0);
+        close(job.second);
+    }
+    close(server);
+    unlink(path);
+    return 0;
+}
+
+}  // namespace P4
@@ -0,0 +1,73 @@
+/*
+Copyright 2013-present Barefoot Networks, Inc.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef _FRONTENDS_COMMON_COMPILESERVER_H_
+#define _FRONTENDS_COMMON_COMPILESERVER_H_
+
+#include <functional>
+#include <vector>
+
+#include "lib/cstring.h"
+
+namespace P4 {
+
+/**
+ * Lets a backend driver serve compile requests over a Unix socket, so that
+ * the cost of starting the compiler is only paid once:
+ *
+ *     p4c-bm2-ss --server /tmp/p4c-bm2-ss.sock [frontend options]
+ *
+ * Before accepting requests, the server parses the standard include files of
+ * the backend (see PrecompiledIncludes), with the frontend options given
+ * after the socket (e.g. --includeCacheDir).  Each connection is then
+ * handed to a process forked from the server, which reads the request (so
+ * that a slow client never holds up the others) and compiles it.  That
+ * process starts from the warm state of the server (heap, interned strings,
+ * parsed includes, static tables), and its changes to global state (errors,
+ * compile contexts, node ids, logging options) are discarded when it exits.
+ * Requests are compiled concurrently, up to one per processor; the others
+ * wait in the socket backlog.
+ *
+ * A request carries the working directory and the command line of the
+ * client, and its standard output and error as file descriptors, so that
+ * a compilation behaves as if the driver had been run by the client.  See
+ * tools/driver/p4c_src/util.py for the client side of the protocol.
+ */
+class CompileServer {
+ public:
+    /// Compiles with command line @argv, as the main function of the driver
+    /// would; returns the exit code.
+    using Compile = std::function<int(int argc, char* const argv[])>;
+
+    /// True if the command line is `driver --server <socket> ...`.
+    static bool requested(int argc, char* const argv[]);
+
+    /**
+     * Serves compile requests until the server is interrupted.
+     *
+     * @param preludes  Standard include files to parse in advance: each
+     *                  element lists the files a typical program of the
+     *                  backend includes, as in `#include <...>`, in order.
+     * @param version   Compiler version, which keys cached includes.
+     * @return the exit code of the server.
+     */
+    static int serve(int argc, char* const argv[], Compile compile,
+                     const std::vector<std::vector<cstring>>& preludes, cstring version);
+};
+
+}  // namespace P4
+
+#endif /* _FRONTENDS_COMMON_COMPILESERVER_H_ */
@@ -14,6 +14,9 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 
+#include <cctype>
+#include <cerrno>
+
 #include "options.h"
 #include "frontends/p4/frontend.h"
 
@@ -57,6 +60,15 @@ CompilerOptions::CompilerOptions() : ParserOptions() {
             return true;
         },
         "Dump the compiler IR after the midend as JSON in the specified file.");
+    registerOption(
+        "--toIRSnapshot", "file",
+        [this](const char* arg) {
+            dumpIRSnapshotFile = arg;
+            return true;
+        },
+        "Dump the compiler IR after the midend as a binary snapshot in the specified file.\n"
+        "Snapshots are loaded with --fromJSON without parsing JSON text; the IR is then\n"
+        "built from them as from a JSON file.");
     registerOption(
         "--ndebug", nullptr,
         [this](const char*) {
@@ -154,6 +166,22 @@ CompilerOptions::CompilerOptions() : ParserOptions() {
             return true;
         },
         "Unrolling all parser's loops");
+    registerOption(
+        "--loopsUnrollMaxStates", "count",
+        [this](const char* arg) {
+            char* end = nullptr;
+            errno = 0;
+            auto count = strtoul(arg, &end, 10);
+            if (!isdigit(static_cast<unsigned char>(*arg)) || *end != '\0' || errno == ERANGE) {
+                ::error(ErrorType::ERR_INVALID, "Illegal number of parser states %1%",
+                        arg);
+                return false;
+            }
+            loopsUnrollingMaxStates = count;
+            return true;
+        },
+        "Leave a parser unchanged if unrolling its loops needs to evaluate more than\n"
+        "count parser states (default: no limit)");
 }
 
 bool CompilerOptions::enable_intrinsic_metadata_fix() { return true; }
@@ -53,6 +53,8 @@ class CompilerOptions : public ParserOptions {
     std::vector<cstring> passesToExcludeBackend;
     // Dump a JSON representation of the IR in the file.
     cstring dumpJsonFile = nullptr;
+    // Dump a binary snapshot of the IR in the file (see ir/json_snapshot.h).
+    cstring dumpIRSnapshotFile = nullptr;
     // Dump and undump the IR tree.
     bool debugJson = false;
     // if this flag is true, compile program in non-debug mode.
@@ -77,6 +79,9 @@ class CompilerOptions : public ParserOptions {
     cstring arch = nullptr;
     // If true, unroll all parser loops inside the midend.
     bool loopsUnrolling = false;
+    // Maximum number of parser state instances evaluated when unrolling
+    // a parser; 0 means no limit.
+    size_t loopsUnrollingMaxStates = 0;
 
     virtual bool enable_intrinsic_metadata_fix();
 };
@@ -16,20 +16,55 @@ limitations under the License.
 
 #include "parseInput.h"
 
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 #include <cstdio>
 #include <iostream>
 #include <sstream>
+#include <string_view>
 
 #include <boost/optional.hpp>
 
+#include "frontends/common/precompiledIncludes.h"
 #include "frontends/parsers/parserDriver.h"
 #include "frontends/p4/fromv1.0/converters.h"
 #include "frontends/p4/frontend.h"
 #include "lib/error.h"
+#include "lib/log.h"
 #include "lib/source_file.h"
 
 namespace P4 {
 
+const IR::P4Program* parseP4_16File(FILE* in, const ParserOptions& options) {
+    // A regular file (e.g. a program which is not preprocessed) is mapped
+    // and lexed in place; a pipe from the preprocessor is read into memory.
+    struct stat st;
+    int fd = fileno(in);
+    if (fd >= 0 && fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        auto offset = lseek(fd, 0, SEEK_CUR);
+        void* data = offset == 0 ?
+            mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+        if (data != MAP_FAILED) {
+            LOG2("Lexing " << st.st_size << " bytes of " << options.file << " in place");
+            auto result = PrecompiledIncludes::parse(
+                std::string_view(static_cast<const char*>(data), st.st_size), options.file,
+                p4includePath, options.includeCacheDir, options.compilerVersion);
+            munmap(data, st.st_size);
+            return result;
+        }
+    }
+
+    std::string input;
+    char buffer[65536];
+    size_t read;
+    while ((read = fread(buffer, 1, sizeof(buffer), in)) > 0)
+        input.append(buffer, read);
+    return PrecompiledIncludes::parse(input, options.file, p4includePath,
+                                      options.includeCacheDir, options.compilerVersion);
+}
+
 const IR::P4Program* parseP4String(const char* sourceFile, unsigned sourceLine,
                                    const std::string& input,
                                    CompilerOptions::FrontendVersion version) {
@@ -64,6 +64,13 @@ parseV1Program(Input& stream, const char* sourceFile, unsigned sourceLine,
  * @return a P4-16 IR tree representing the contents of the given file, or null
  * on failure. If failure occurs, an error will also be reported.
  */
+/**
+ * Parse the preprocessed P4-16 program in @in, reusing the standard include
+ * files it starts with if they have been parsed before (see
+ * PrecompiledIncludes).
+ */
+const IR::P4Program* parseP4_16File(FILE* in, const ParserOptions& options);
+
 template <typename C = P4V1::Converter>
 const IR::P4Program* parseP4File(ParserOptions& options) {
     BUG_CHECK(&options == &P4CContext::get().options(),
@@ -85,7 +92,7 @@ const IR::P4Program* parseP4File(ParserOptions& options) {
 
     auto result = options.isv1()
                 ? parseV1Program<FILE*, C>(in, options.file, 1, options.getDebugHook())
-                : P4ParserDriver::parse(in, options.file);
+                : parseP4_16File(in, options);
     options.closeInput(in);
 
     if (::errorCount() > 0) {
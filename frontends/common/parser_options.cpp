@@ -22,6 +22,7 @@ limitations under the License.
 #include <regex>
 #include <unordered_set>
 
+#include "frontends/p4/toP4/diffDump.h"
 #include "frontends/p4/toP4/toP4.h"
 #include "ir/json_generator.h"
 #include "lib/exceptions.h"
@@ -30,6 +31,7 @@ limitations under the License.
 #include "lib/nullstream.h"
 #include "lib/path.h"
 #include "parser_options.h"
+#include "preprocessor.h"
 
 /* CONFIG_PKGDATADIR is defined by cmake at compile time to be the same as
  * CMAKE_INSTALL_PREFIX This is only valid when the compiler is built and
@@ -176,6 +178,31 @@ ParserOptions::ParserOptions() : Util::Options(defaultMessage) {
             return true;
         },
         "Skip preprocess, assume input file is already preprocessed.");
+    registerOption(
+        "--builtin-cpp", nullptr,
+        [this](const char* ) {
+            builtinPreprocessor = true;
+            return true;
+        },
+        "Preprocess with the built-in preprocessor, which keeps the standard\n"
+        "include files in memory; the external preprocessor is still used for\n"
+        "constructs that the built-in one does not support.");
+    registerOption(
+        "--parse-annotations-on-demand", nullptr,
+        [this](const char* ) {
+            parseAnnotationsOnDemand = true;
+            return true;
+        },
+        "Parse the body of a known annotation only when a compiler pass\n"
+        "asks for it; errors in bodies that are never used are not reported.");
+    registerOption(
+        "--includeCacheDir", "dir",
+        [this](const char* arg) {
+            includeCacheDir = arg;
+            return true;
+        },
+        "Store the parsed standard include files (core.p4, architecture files)\n"
+        "in the specified directory and reuse them in later compilations.");
     registerOption(
         "--disable-annotations", "annotations",
         [this](const char* arg) {
@@ -274,6 +301,16 @@ ParserOptions::ParserOptions() : Util::Options(defaultMessage) {
             return true;
         },
         "[Compiler debugging] Folder where P4 programs are dumped\n");
+    registerOption(
+        "--top4-diff", nullptr,
+        [this](const char*) {
+            top4Diff = true;
+            return true;
+        },
+        "[Compiler debugging] Write the --top4 dumps to a single file,\n"
+        "<program>-passes.p4diff, which holds only the top-level declarations\n"
+        "that changed since the previous dump; tools/p4diff.py prints the\n"
+        "program after any of the dumped passes.\n");
     registerOption(
         "--parser-inline-opt", nullptr,
         [this](const char*) {
@@ -389,12 +426,31 @@ const char* ParserOptions::getIncludePath() {
     return path.c_str();
 }
 
+FILE* ParserOptions::preprocessInProcess() {
+    P4::Preprocessor cpp;
+    std::string reason;
+    if (file == nullptr ||
+        !cpp.setOptions(std::string(preprocessor_options) + getIncludePath(), reason) ||
+        !cpp.run(file.c_str(), preprocessedInput, reason)) {
+        LOG1("Using the external preprocessor: " << reason);
+        return nullptr;
+    }
+    auto in = fmemopen(const_cast<char*>(preprocessedInput.data()), preprocessedInput.size(),
+                       "r");
+    if (in != nullptr) in_memory_input = true;
+    return in;
+}
+
 FILE* ParserOptions::preprocess() {
     FILE* in = nullptr;
+    in_memory_input = false;
 
     if (file == "-") {
         file = "<stdin>";
         in = stdin;
+    } else if (builtinPreprocessor && (in = preprocessInProcess()) != nullptr) {
+        if (Log::verbose())
+            std::cerr << "Preprocessed " << file << " in process" << std::endl;
     } else {
 #ifdef __clang__
         std::string cmd("cc -E -x c -Wno-comment");
@@ -437,7 +493,9 @@ FILE* ParserOptions::preprocess() {
 }
 
 void ParserOptions::closeInput(FILE* inputStream) const {
-    if (close_input) {
+    if (in_memory_input) {
+        fclose(inputStream);
+    } else if (close_input) {
         int exitCode = pclose(inputStream);
         if (WIFEXITED(exitCode) && WEXITSTATUS(exitCode) == 4)
             ::error(ErrorType::ERR_IO, "input file %s does not exist", file);
@@ -491,18 +549,35 @@ void ParserOptions::dumpPass(const char* manager, unsigned seq,
             if (filename == "-")
                 filename = "tmp.p4";
 
-            cstring fileName = makeFileName(dumpFolder, filename, suffix);
-            auto stream = openFile(fileName, true);
-            if (stream != nullptr) {
-                if (Log::verbose())
-                    std::cerr << "Writing program to " << fileName << std::endl;
-                P4::ToP4 toP4(stream, Log::verbose(), file);
-                if (noIncludes) {
-                    toP4.setnoIncludesArg(true);
+            if (top4Diff) {
+                if (!diffDump && !diffDumpFailed) {
+                    Util::PathName path(filename);
+                    cstring fileName = Util::PathName(dumpFolder).join(
+                        path.getBasename() + "-passes.p4diff").toString();
+                    if (Log::verbose())
+                        std::cerr << "Writing program dumps to " << fileName << std::endl;
+                    auto stream = openFile(fileName, false);
+                    // openFile has reported the error; no more dumps are written
+                    if (stream == nullptr)
+                        diffDumpFailed = true;
+                    else
+                        diffDump = std::make_shared<P4::DiffDump>(stream, file, noIncludes);
                 }
-                node->apply(toP4);
-                delete stream;  // close the file
+                if (diffDump)
+                    diffDump->dump(name, node);
+                break;
+            }
+
+            cstring fileName = makeFileName(dumpFolder, filename, suffix);
+            if (Log::verbose())
+                std::cerr << "Writing program to " << fileName << std::endl;
+            Util::SourceCodeBuilder builder;
+            P4::ToP4 toP4(builder, Log::verbose(), file);
+            if (noIncludes) {
+                toP4.setnoIncludesArg(true);
             }
+            node->apply(toP4);
+            builder.writeToFile(fileName);
             break;
         }
     }
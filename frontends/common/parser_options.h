@@ -19,7 +19,9 @@ limitations under the License.
 #ifndef FRONTENDS_COMMON_PARSER_OPTIONS_H_
 #define FRONTENDS_COMMON_PARSER_OPTIONS_H_
 
+#include <memory>
 #include <set>
+#include <string>
 #include <unordered_map>
 
 #include "ir/configuration.h"
@@ -33,16 +35,28 @@ limitations under the License.
 extern const char* p4includePath;
 extern const char* p4_14includePath;
 
+namespace P4 {
+class DiffDump;
+}  // namespace P4
+
 // Base class for compiler options.
 // This class contains the options for the front-ends.
 // Each back-end should subclass this file.
 class ParserOptions : public Util::Options {
     bool close_input = false;
+    // true if the input is preprocessedInput, from the built-in preprocessor
+    bool in_memory_input = false;
+    std::string preprocessedInput;
     static const char* defaultMessage;
 
     // annotation names that are to be ignored by the compiler
     std::set<cstring> disabledAnnotations;
 
+    // diff stream written by dumpPass when top4Diff is set
+    mutable std::shared_ptr<P4::DiffDump> diffDump;
+    // true if the diff stream could not be opened
+    mutable bool diffDumpFailed = false;
+
  protected:
     // Function that is returned by getDebugHook.
     void dumpPass(const char* manager, unsigned seq, const char* pass,
@@ -68,10 +82,18 @@ class ParserOptions : public Util::Options {
     cstring compilerVersion;
     // if true skip preprocess
     bool doNotPreprocess = false;
+    // if true use the built-in preprocessor when it supports the program
+    bool builtinPreprocessor = false;
+    // if true parse annotation bodies only when a pass asks for them
+    bool parseAnnotationsOnDemand = false;
+    // directory where parsed standard include files are cached
+    cstring includeCacheDir = nullptr;
     // substrings matched against pass names
     std::vector<cstring> top4;
     // debugging dumps of programs written in this folder
     cstring dumpFolder = ".";
+    // if true the top4 dumps go to one diff stream instead of a file each
+    bool top4Diff = false;
     // If false, optimization of callee parsers (subparsers) inlining is disabled.
     bool optimizeParserInlining = false;
     // Expect that the only remaining argument is the input file.
@@ -80,6 +102,9 @@ class ParserOptions : public Util::Options {
     const char *getIncludePath() override;
     // Returns the output of the preprocessor.
     FILE* preprocess();
+    // Runs the built-in preprocessor; returns nullptr if the external
+    // preprocessor must be used.
+    FILE* preprocessInProcess();
     // Closes the input stream returned by preprocess.
     void closeInput(FILE* input) const;
     // True if we are compiling a P4 v1.0 or v1.1 program
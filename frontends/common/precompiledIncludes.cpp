@@ -0,0 +1,401 @@
+/*
+Copyright 2013-present Barefoot Networks, Inc.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "precompiledIncludes.h"
+
+#include <unistd.h>
+
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <sstream>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "frontends/parsers/parserDriver.h"
+#include "ir/ir.h"
+#include "ir/json_generator.h"
+#include "ir/json_loader.h"
+#include "ir/json_snapshot.h"
+#include "lib/bufferstream.h"
+#include "lib/log.h"
+
+namespace P4 {
+
+PrecompiledIncludes::Stats PrecompiledIncludes::stats;
+
+namespace {
+
+/// True if input[pos, eol) is a line marker (`# 12 "file"` or
+/// `#line 12 "file"`); sets @file to the file name and @line to the line
+/// number.
+bool isLineMarker(std::string_view input, size_t pos, size_t eol, std::string& file,
+                  unsigned* line = nullptr) {
+    if (input.compare(pos, 6, "#line ") == 0) {
+        pos += 6;
+    } else if (input.compare(pos, 2, "# ") == 0 && pos + 2 < eol && isdigit(input[pos + 2])) {
+        pos += 2;
+    } else {
+        return false;
+    }
+    auto open = input.find('"', pos);
+    if (open >= eol) return false;
+    auto close = input.find('"', open + 1);
+    if (close >= eol) return false;
+    file = std::string(input.substr(open + 1, close - open - 1));
+    if (line) *line = strtoul(std::string(input.substr(pos, open - pos)).c_str(), nullptr, 10);
+    return true;
+}
+
+/// True if input[pos, eol) only contains white space and comments; updates
+/// @inComment for block comments spanning several lines.
+bool isBlank(std::string_view input, size_t pos, size_t eol, bool& inComment) {
+    while (pos < eol) {
+        if (inComment) {
+            auto close = input.find("*/", pos);
+            if (close >= eol) return true;
+            inComment = false;
+            pos = close + 2;
+        } else if (isspace(input[pos])) {
+            pos++;
+        } else if (input.compare(pos, 2, "//") == 0) {
+            return true;
+        } else if (input.compare(pos, 2, "/*") == 0) {
+            inComment = true;
+            pos += 2;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// Splits the preprocessed @input into the text that the preprocessor
+/// produced from files in @includeDir before the first declaration of the
+/// program itself (the prelude), and everything else (@rest, as segments of
+/// @input, which is not copied).  The segments of the main file between two
+/// includes are only comments and line markers; they go to @rest, so that
+/// the prelude does not depend on the name or the license header of the
+/// program.  Line markers keep all source positions right whichever side a
+/// line ends up on.
+/// @return false if the program does not start with included files.
+bool splitPrelude(std::string_view input, cstring includeDir,
+                  std::string& prelude, std::vector<std::string_view>& rest) {
+    std::string prefix = std::string(includeDir) + "/";
+    bool inInclude = false, inComment = false;
+    size_t pos = 0;
+    while (pos < input.size()) {
+        auto eol = input.find('\n', pos);
+        eol = eol == std::string::npos ? input.size() : eol + 1;
+        std::string file;
+        if (isLineMarker(input, pos, eol, file))
+            inInclude = file.compare(0, prefix.size(), prefix) == 0;
+        else if (!inInclude && !isBlank(input, pos, eol, inComment))
+            break;
+        if (inInclude)
+            prelude.append(input.data() + pos, eol - pos);
+        else if (!rest.empty() && rest.back().data() + rest.back().size() == input.data() + pos)
+            rest.back() = std::string_view(rest.back().data(), rest.back().size() + eol - pos);
+        else
+            rest.push_back(input.substr(pos, eol - pos));
+        pos = eol;
+    }
+    rest.push_back(input.substr(pos));
+    return !prelude.empty();
+}
+
+/// Preludes parsed by this process, by text
+std::unordered_map<std::string, const ParserPrelude*> preludes;
+
+std::string cacheFileName(cstring cacheDir, cstring version, const std::string& prelude) {
+    std::stringstream name;
+    name << cacheDir << "/prelude-" << std::hex << std::setw(16) << std::setfill('0')
+         << std::hash<std::string>()(std::string(version) + '\n' + prelude) << ".p4ir";
+    return name.str();
+}
+
+JsonData* toJson(const std::vector<Util::ProgramStructure::Symbol>& symbols) {
+    auto result = new JsonVector();
+    for (auto& symbol : symbols) {
+        auto obj = new JsonObject();
+        (*obj)["name"] = new JsonString(symbol.name.c_str());
+        (*obj)["kind"] = new JsonNumber(static_cast<int>(symbol.kind));
+        (*obj)["container"] = new JsonBoolean(symbol.container);
+        (*obj)["allowDuplicates"] = new JsonBoolean(symbol.allowDuplicates);
+        if (symbol.typeNamespace)
+            (*obj)["typeNamespace"] = new JsonString(symbol.typeNamespace.c_str());
+        (*obj)["members"] = toJson(symbol.members);
+        result->push_back(obj);
+    }
+    return result;
+}
+
+bool fromJson(JsonData* json, std::vector<Util::ProgramStructure::Symbol>& symbols) {
+    auto vec = json ? json->to<JsonVector>() : nullptr;
+    if (!vec) return false;
+    for (auto elem : *vec) {
+        auto obj = elem->to<JsonObject>();
+        if (!obj) return false;
+        auto name = obj->find("name");
+        auto kind = obj->find("kind");
+        auto container = obj->find("container");
+        auto allowDuplicates = obj->find("allowDuplicates");
+        auto typeNamespace = obj->find("typeNamespace");
+        auto members = obj->find("members");
+        if (name == obj->end() || !name->second->is<JsonString>() ||
+            kind == obj->end() || !kind->second->is<JsonNumber>() ||
+            container == obj->end() || !container->second->is<JsonBoolean>() ||
+            allowDuplicates == obj->end() || !allowDuplicates->second->is<JsonBoolean>() ||
+            members == obj->end())
+            return false;
+        Util::ProgramStructure::Symbol symbol;
+        symbol.name = *name->second->to<JsonString>();
+        symbol.kind = static_cast<Util::ProgramStructure::SymbolKind>(
+            static_cast<int>(*kind->second->to<JsonNumber>()));
+        symbol.container = *container->second->to<JsonBoolean>();
+        symbol.allowDuplicates = *allowDuplicates->second->to<JsonBoolean>();
+        if (typeNamespace != obj->end()) {
+            if (!typeNamespace->second->is<JsonString>()) return false;
+            symbol.typeNamespace = *typeNamespace->second->to<JsonString>();
+        }
+        if (!fromJson(members->second, symbol.members)) return false;
+        symbols.push_back(std::move(symbol));
+    }
+    return true;
+}
+
+/// The source positions of all the nodes of a program, in the order in
+/// which an Inspector visits them.
+class GetPositions : public Inspector {
+ public:
+    std::stringstream positions;
+    GetPositions() { setName("GetPositions"); }
+    bool preorder(const IR::Node* node) override {
+        auto& start = node->srcInfo.getStart();
+        auto& end = node->srcInfo.getEnd();
+        positions << start.getLineNumber() << ' ' << start.getColumnNumber() << ' '
+                  << end.getLineNumber() << ' ' << end.getColumnNumber() << ' ';
+        return true;
+    }
+};
+
+/// Sets the source positions read by GetPositions on a program with the same
+/// structure.  Sets @ok to false if the positions do not match the program.
+/// The nodes are changed in place: they were just made by the JSONLoader,
+/// which sets the source information of its nodes the same way, and a
+/// Modifier would discard copies that only differ in their positions.
+class SetPositions : public Inspector {
+    const Util::InputSources* sources;
+    std::istream& positions;
+    bool& ok;
+
+ public:
+    SetPositions(const Util::InputSources* sources, std::istream& positions, bool& ok) :
+            sources(sources), positions(positions), ok(ok) { setName("SetPositions"); }
+    bool preorder(const IR::Node* node) override {
+        unsigned startLine, startColumn, endLine, endColumn;
+        if (!(positions >> startLine >> startColumn >> endLine >> endColumn) ||
+            (startLine == 0) != (endLine == 0)) {
+            ok = false;
+            return false;
+        }
+        if (startLine != 0) {
+            const_cast<IR::Node*>(node)->srcInfo = Util::SourceInfo(
+                sources, Util::SourcePosition(startLine, startColumn),
+                Util::SourcePosition(endLine, endColumn));
+        } else {
+            const_cast<IR::Node*>(node)->srcInfo = Util::SourceInfo();
+        }
+        return true;
+    }
+};
+
+/// The file and line where the prelude @text starts, given by its first line
+/// marker.  The parser maps the first line of its input to them before it
+/// reads the marker, and keeps that mapping, so the prelude must not be
+/// parsed as a part of the program file.
+std::pair<cstring, unsigned> preludeStart(const std::string& text) {
+    std::string file;
+    unsigned line = 1;
+    auto eol = text.find('\n');
+    isLineMarker(text, 0, eol == std::string::npos ? text.size() : eol, file, &line);
+    return { cstring(file), line };
+}
+
+/// The InputSources that the lexer builds when reading the prelude @text:
+/// its text, and the lines of its line markers.
+Util::InputSources* readSources(const std::string& text) {
+    auto sources = new Util::InputSources;
+    auto start = preludeStart(text);
+    sources->mapLine(start.first, start.second);  // as P4ParserDriver::parse
+    std::string_view input(text);
+    size_t pos = 0;
+    while (pos < input.size()) {
+        auto eol = input.find('\n', pos);
+        eol = eol == std::string::npos ? input.size() : eol + 1;
+        std::string file;
+        unsigned line;
+        // The lexer maps the line when it reads the file name of the marker.
+        if (isLineMarker(input, pos, eol, file, &line))
+            sources->mapLine(file, line);
+        sources->appendText(std::string(input.substr(pos, eol - pos)).c_str());
+        pos = eol;
+    }
+    return sources;
+}
+
+/// A cache file holds the prelude text it was made from, which must match
+/// exactly: the file name is only a hash of it.  The loader only keeps the
+/// file names and lines of source positions, so the positions of all the
+/// nodes are stored separately and restored against the InputSources of the
+/// text, for ToP4 to recognize system files and for error messages.
+const ParserPrelude* loadPrelude(const std::string& fileName, cstring version,
+                                 const std::string& text) {
+    std::ifstream in(fileName, std::ios::binary);
+    if (!in) return nullptr;
+    auto json = readJsonSnapshot(in);
+    auto obj = json ? json->to<JsonObject>() : nullptr;
+    if (!obj) return nullptr;
+    auto cachedVersion = obj->find("compilerVersion");
+    auto cachedText = obj->find("prelude");
+    auto symbols = obj->find("symbols");
+    auto program = obj->find("program");
+    auto positions = obj->find("positions");
+    if (cachedVersion == obj->end() || cachedText == obj->end() ||
+        symbols == obj->end() || program == obj->end() || positions == obj->end())
+        return nullptr;
+    auto versionString = cachedVersion->second->to<JsonString>();
+    auto textString = cachedText->second->to<JsonString>();
+    if (!versionString || *versionString != std::string(version) ||
+        !textString || *textString != text)
+        return nullptr;
+
+    auto prelude = new ParserPrelude;
+    if (!fromJson(symbols->second, prelude->symbols)) return nullptr;
+    JSONLoader loader(program->second);
+    const IR::Node* node = nullptr;
+    loader >> node;
+    auto p4program = node ? node->to<IR::P4Program>() : nullptr;
+    auto positionsString = positions->second->to<JsonString>();
+    if (!p4program || !positionsString) return nullptr;
+
+    auto sources = readSources(text);
+    std::istringstream positionsStream(*positionsString);
+    bool ok = true;
+    p4program->apply(SetPositions(sources, positionsStream, ok));
+    std::string extra;
+    if (!ok || positionsStream >> extra) {
+        LOG1("Source positions in " << fileName << " do not match the program");
+        return nullptr;
+    }
+    prelude->declarations = p4program->objects;
+    prelude->sources = sources;
+    return prelude;
+}
+
+void storePrelude(const std::string& fileName, cstring version, const std::string& text,
+                  const ParserPrelude* prelude) {
+    auto p4program = new IR::P4Program(prelude->declarations);
+    std::stringstream programText;
+    JSONGenerator(programText, true) << p4program << std::endl;
+    JsonData* program = nullptr;
+    programText >> program;
+    if (!program) {
+        LOG1("Could not convert the prelude to JSON");
+        return;
+    }
+    auto entry = new JsonObject();
+    (*entry)["compilerVersion"] = new JsonString(version.c_str());
+    (*entry)["prelude"] = new JsonString(text);
+    (*entry)["symbols"] = toJson(prelude->symbols);
+    (*entry)["program"] = program;
+    GetPositions getPositions;
+    p4program->apply(getPositions);
+    (*entry)["positions"] = new JsonString(getPositions.positions.str());
+
+    // Write to a temporary file first, so that concurrent compilations never
+    // see a partial file.
+    auto tmpName = fileName + ".tmp" + std::to_string(getpid());
+    {
+        std::ofstream out(tmpName, std::ios::binary);
+        if (!out) {
+            LOG1("Cannot write " << tmpName);
+            return;
+        }
+        writeJsonSnapshot(out, entry);
+        if (!out) {
+            LOG1("Cannot write " << tmpName);
+            unlink(tmpName.c_str());
+            return;
+        }
+    }
+    if (rename(tmpName.c_str(), fileName.c_str()) != 0) {
+        LOG1("Cannot write " << fileName);
+        unlink(tmpName.c_str());
+    }
+}
+
+}  // namespace
+
+/* static */ void PrecompiledIncludes::clear() {
+    preludes.clear();
+}
+
+/* static */ const IR::P4Program*
+PrecompiledIncludes::parse(std::string_view input, const char* sourceFile,
+                           cstring includeDir, cstring cacheDir, cstring version) {
+    if (!version) version = "";
+    std::string text;
+    std::vector<std::string_view> rest;
+    if (!splitPrelude(input, includeDir, text, rest)) {
+        Util::BufferInputStream stream(input);
+        return P4ParserDriver::parse(stream, sourceFile);
+    }
+
+    const ParserPrelude* prelude = nullptr;
+    auto it = preludes.find(text);
+    if (it != preludes.end()) {
+        stats.memoryHits++;
+        prelude = it->second;
+    } else {
+        std::string fileName;
+        if (cacheDir) {
+            fileName = cacheFileName(cacheDir, version, text);
+            prelude = loadPrelude(fileName, version, text);
+        }
+        if (prelude) {
+            stats.diskHits++;
+            LOG2("Loaded parsed includes from " << fileName);
+        } else {
+            stats.misses++;
+            Util::BufferInputStream stream(text);
+            auto start = preludeStart(text);
+            prelude = P4ParserDriver::parsePrelude(stream, start.first, start.second);
+            if (!prelude) return nullptr;
+            if (cacheDir) storePrelude(fileName, version, text, prelude);
+        }
+        preludes.emplace(text, prelude);
+    }
+
+    Util::BufferInputStream stream(rest);
+    return P4ParserDriver::parse(stream, sourceFile, 1, prelude);
+}
+
+}  // namespace P4
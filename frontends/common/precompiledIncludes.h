@@ -0,0 +1,76 @@
+/*
+Copyright 2013-present Barefoot Networks, Inc.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef _FRONTENDS_COMMON_PRECOMPILEDINCLUDES_H_
+#define _FRONTENDS_COMMON_PRECOMPILEDINCLUDES_H_
+
+#include <string>
+#include <string_view>
+
+#include "lib/cstring.h"
+
+namespace IR {
+class P4Program;
+}  // namespace IR
+
+namespace P4 {
+
+struct ParserPrelude;
+
+/**
+ * Parses preprocessed P4-16 programs, reusing the result of parsing the
+ * standard include files (core.p4, v1model.p4, psa.p4, ...) they start with.
+ *
+ * The prelude of a program is the text that the preprocessor produced from
+ * files in the include directory before the first declaration of the program
+ * itself.  It is keyed on its exact text (so on the contents of the include
+ * files and on any macros that affect them) and on the compiler version.
+ * Parsed preludes are kept in memory for the lifetime of the process and,
+ * if a cache directory is given, stored there as IR snapshots, with the
+ * source positions of their nodes, for later compiler runs.
+ *
+ * Only parsing is skipped: the frontend still type-checks the declarations
+ * of the prelude, since TypeMap is keyed on nodes that every compilation
+ * rewrites.
+ */
+class PrecompiledIncludes {
+ public:
+    struct Stats {
+        unsigned memoryHits = 0;
+        unsigned diskHits = 0;
+        unsigned misses = 0;
+    };
+
+    /**
+     * Parse the preprocessed P4-16 program @input.
+     *
+     * @param includeDir  Directory of the standard include files.
+     * @param cacheDir    Directory for parsed preludes; may be null.
+     * @param version     Compiler version, part of the key of cached preludes.
+     */
+    static const IR::P4Program* parse(std::string_view input, const char* sourceFile,
+                                      cstring includeDir, cstring cacheDir,
+                                      cstring version);
+
+    /// Forget the preludes parsed so far; the cache directory is not affected.
+    static void clear();
+
+    static Stats stats;
+};
+
+}  // namespace P4
+
+#endif /* _FRONTENDS_COMMON_PRECOMPILEDINCLUDES_H_ */
@@ -0,0 +1,1049 @@
+/*
+Copyright 2013-present Barefoot Networks, Inc.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "preprocessor.h"
+
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <unordered_map>
+
+#include "lib/log.h"
+
+namespace P4 {
+
+Preprocessor::Stats Preprocessor::stats;
+
+/// The lines of a file, and its include guard once the file has been
+/// processed.
+struct Preprocessor::SourceText {
+    time_t mtime = 0;
+    off_t size = 0;
+    std::vector<std::string> lines;
+    bool crlf = false;  // some lines end with \r\n
+    bool guardKnown = false;
+    std::string guard;  // empty if the file has no include guard
+    // First and last line of the include guard
+    size_t guardBegin = 0, guardEnd = 0;
+    // Only blank lines are outside of the include guard, so that cpp does
+    // not enter the file again once the guard macro is defined.
+    bool guardOnly = false;
+};
+
+/// An include file as cpp identifies it: by its name in the `#include` and
+/// the directory where the search started, rather than by its path.
+struct Preprocessor::IncludedFile {
+    std::string path;
+    std::shared_ptr<SourceText> text;
+    bool processed = false;  // read to the end in this run
+};
+
+/// Writes the output lines as cpp does: it moves to the line of each token
+/// with empty lines, or with a line marker when it changes files or skips
+/// 8 lines or more (see maybe_print_line in gcc/c-family/c-ppoutput.cc).
+class Preprocessor::OutputPrinter {
+    std::string& output;
+    std::string file;
+    size_t line = 0;
+    bool printed = false;  // the current output line is not terminated
+
+ public:
+    explicit OutputPrinter(std::string& output) : output(output) {}
+
+    void marker(const std::string& name, size_t at, const char* flags);
+    void moveTo(const std::string& name, size_t at);
+    /// Prints @text, the tokens of the line @at of the file @name.
+    void print(const std::string& name, size_t at, const std::string& text) {
+        moveTo(name, at);
+        output += text;
+        printed = true;
+    }
+    void finish() {
+        if (printed) output += '\n';
+        printed = false;
+    }
+};
+
+namespace {
+
+/// Thrown on anything the external preprocessor must handle.
+struct Unsupported {
+    std::string reason;
+};
+
+[[noreturn]] void unsupported(const std::string& reason) {
+    throw Unsupported{reason};
+}
+
+/// Include files read by this process, by path
+std::unordered_map<std::string, std::shared_ptr<Preprocessor::SourceText>> files;
+
+const unsigned maxIncludeDepth = 200;
+
+bool isIdentStart(char c) { return isalpha(static_cast<unsigned char>(c)) || c == '_'; }
+bool isIdentChar(char c) { return isalnum(static_cast<unsigned char>(c)) || c == '_'; }
+bool isSpace(char c) { return isspace(static_cast<unsigned char>(c)); }
+
+/// Macros that cpp defines itself, even with -undef.
+bool isBuiltinMacro(const std::string& name) {
+    static const std::set<std::string> builtins = {
+        "__FILE__", "__LINE__", "__COUNTER__", "__DATE__", "__TIME__", "__TIMESTAMP__",
+        "__INCLUDE_LEVEL__", "__BASE_FILE__", "__STDC__", "__STDC_VERSION__",
+        "__STDC_HOSTED__", "__ASSEMBLER__", "__has_include", "__has_include_next",
+        "_Pragma" };
+    return builtins.count(name) || name.compare(0, 6, "__GNUC") == 0 ||
+           name.compare(0, 5, "__GCC") == 0;
+}
+
+size_t identEnd(const std::string& text, size_t pos) {
+    while (pos < text.size() && isIdentChar(text[pos])) pos++;
+    return pos;
+}
+
+size_t skipSpaces(const std::string& text, size_t pos) {
+    while (pos < text.size() && isSpace(text[pos])) pos++;
+    return pos;
+}
+
+/// Skips the string literal starting at text[pos]; with
+/// `-x assembler-with-cpp`, single quotes do not start literals.  A string
+/// which continues on the next line ends with the line if @lenient is set,
+/// as with cpp; it is not supported otherwise.
+size_t skipString(const std::string& text, size_t pos, bool lenient = false) {
+    for (pos++; pos < text.size() && text[pos] != '"'; pos++)
+        if (text[pos] == '\\') pos++;
+    if (pos >= text.size()) {
+        if (lenient) return text.size();
+        unsupported("unterminated string literal");
+    }
+    return pos + 1;
+}
+
+/// Skips a preprocessing number, such as 10, 0x1F, 8w255 or 1e+3.
+size_t skipNumber(const std::string& text, size_t pos) {
+    for (pos++; pos < text.size(); pos++) {
+        char c = text[pos];
+        if (isIdentChar(c) || c == '.') continue;
+        char prev = text[pos - 1];
+        if ((c == '+' || c == '-') && (prev == 'e' || prev == 'E' || prev == 'p' || prev == 'P'))
+            continue;
+        break;
+    }
+    return pos;
+}
+
+/// True if cpp separates @left and @right with a space when one of them
+/// comes from a macro expansion, because their tokens would be read as one.
+bool avoidPaste(const std::string& left, const std::string& right) {
+    if (left.empty() || right.empty()) return false;
+    char l = left.back(), r = right[0];
+    if (isIdentChar(l) && isIdentChar(r)) return true;
+    if (isIdentChar(l) || l == '.') {
+        auto start = left.size();
+        while (start > 0 && (isIdentChar(left[start - 1]) || left[start - 1] == '.')) start--;
+        bool number = isdigit(static_cast<unsigned char>(left[start])) ||
+                      (left[start] == '.' && start + 1 < left.size());
+        return number && (r == '.' || r == '+' || r == '-');
+    }
+    if (l == r && strchr("+-<>&|=:#", l)) return true;
+    if (r == '=' && strchr("<>!=+-*/%&|^", l)) return true;
+    return (l == '-' && r == '>') || (l == '/' && (r == '*' || r == '/')) ||
+           (l == '.' && isdigit(static_cast<unsigned char>(r)));
+}
+
+std::string trim(const std::string& text) {
+    auto begin = skipSpaces(text, 0);
+    auto end = text.size();
+    while (end > begin && isSpace(text[end - 1])) end--;
+    return text.substr(begin, end - begin);
+}
+
+/// Replaces the comments in the directive @line with spaces.
+std::string stripComments(const std::string& line) {
+    std::string result;
+    for (size_t pos = 0; pos < line.size(); ) {
+        if (line[pos] == '"') {
+            auto end = skipString(line, pos);
+            result.append(line, pos, end - pos);
+            pos = end;
+        } else if (line.compare(pos, 2, "//") == 0) {
+            break;
+        } else if (line.compare(pos, 2, "/*") == 0) {
+            auto close = line.find("*/", pos + 2);
+            if (close == std::string::npos)
+                unsupported("comment continued after a directive");
+            result += ' ';
+            pos = close + 2;
+        } else {
+            result += line[pos++];
+        }
+    }
+    return result;
+}
+
+/// Spaces @line as cpp does: leading white space becomes one space per
+/// character, other white space between tokens a single space, and trailing
+/// white space is removed; comments are unchanged.
+std::string normalizeSpaces(const std::string& line, bool inComment) {
+    std::string result;
+    size_t pos = 0;
+    if (!inComment) {
+        pos = skipSpaces(line, 0);
+        if (pos == line.size()) return result;
+        result.append(pos, ' ');
+    }
+    while (pos < line.size()) {
+        if (inComment) {
+            auto close = line.find("*/", pos);
+            auto end = close == std::string::npos ? line.size() : close + 2;
+            result.append(line, pos, end - pos);
+            inComment = close == std::string::npos;
+            pos = end;
+        } else if (isSpace(line[pos])) {
+            pos = skipSpaces(line, pos);
+            if (pos < line.size()) result += ' ';
+        } else if (line.compare(pos, 2, "//") == 0) {
+            result.append(line, pos, std::string::npos);
+            break;
+        } else if (line.compare(pos, 2, "/*") == 0) {
+            result += "/*";
+            inComment = true;
+            pos += 2;
+        } else if (line[pos] == '"') {
+            auto end = skipString(line, pos, true);
+            result.append(line, pos, end - pos);
+            pos = end;
+        } else {
+            result += line[pos++];
+        }
+    }
+    return result;
+}
+
+/// True if @line only contains white space and comments; updates
+/// @inComment for block comments spanning several lines.
+bool isBlank(const std::string& line, bool& inComment) {
+    for (size_t pos = 0; pos < line.size(); ) {
+        if (inComment) {
+            auto close = line.find("*/", pos);
+            if (close == std::string::npos) return true;
+            inComment = false;
+            pos = close + 2;
+        } else if (isSpace(line[pos])) {
+            pos++;
+        } else if (line.compare(pos, 2, "//") == 0) {
+            return true;
+        } else if (line.compare(pos, 2, "/*") == 0) {
+            inComment = true;
+            pos += 2;
+        } else {
+            // The rest of the line may still open a comment
+            for (; pos < line.size(); pos++) {
+                if (line[pos] == '"') {
+                    pos = skipString(line, pos, true) - 1;
+                } else if (line.compare(pos, 2, "//") == 0) {
+                    break;
+                } else if (line.compare(pos, 2, "/*") == 0) {
+                    isBlank(line.substr(pos), inComment);
+                    break;
+                }
+            }
+            return false;
+        }
+    }
+    return true;
+}
+
+/// Directive name at the start of @line (e.g. "include" for `  # include
+/// <core.p4>`), with @pos set after it; empty if @line is not a directive.
+std::string directiveName(const std::string& line, size_t& pos, bool& isDirective) {
+    pos = skipSpaces(line, 0);
+    isDirective = pos < line.size() && line[pos] == '#';
+    if (!isDirective) return "";
+    pos = skipSpaces(line, pos + 1);
+    auto end = identEnd(line, pos);
+    auto name = line.substr(pos, end - pos);
+    pos = end;
+    return name;
+}
+
+std::string quoteFileName(const std::string& name) {
+    std::string result = "\"";
+    for (char c : name) {
+        if (c == '"' || c == '\\') result += '\\';
+        result += c;
+    }
+    return result + "\"";
+}
+
+bool isIdentifier(const std::string& text) {
+    return !text.empty() && isIdentStart(text[0]) && identEnd(text, 0) == text.size();
+}
+
+/// The macro tested by an `#if` whose expression is `!defined X` or
+/// `!defined(X)`, which cpp takes as an include guard; empty otherwise.
+std::string negatedDefined(const std::string& expression) {
+    auto pos = skipSpaces(expression, 0);
+    if (pos >= expression.size() || expression[pos] != '!') return "";
+    pos = skipSpaces(expression, pos + 1);
+    auto end = identEnd(expression, pos);
+    if (expression.compare(pos, end - pos, "defined") != 0 || end - pos != 7) return "";
+    auto rest = trim(expression.substr(end));
+    if (!rest.empty() && rest[0] == '(' && rest.back() == ')')
+        rest = trim(rest.substr(1, rest.size() - 2));
+    return isIdentifier(rest) ? rest : "";
+}
+
+std::shared_ptr<Preprocessor::SourceText> readFile(const std::string& path, bool cache) {
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) return nullptr;
+    if (cache) {
+        auto it = files.find(path);
+        if (it != files.end() && it->second->mtime == st.st_mtime &&
+            it->second->size == st.st_size) {
+            Preprocessor::stats.fileHits++;
+            return it->second;
+        }
+    }
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return nullptr;
+    auto text = std::make_shared<Preprocessor::SourceText>();
+    text->mtime = st.st_mtime;
+    text->size = st.st_size;
+    std::string line;
+    while (std::getline(in, line)) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+            text->crlf = true;
+        }
+        text->lines.push_back(std::move(line));
+    }
+    if (cache) {
+        Preprocessor::stats.fileMisses++;
+        files[path] = text;
+        LOG2("Read include file " << path);
+    }
+    return text;
+}
+
+/// Evaluates the expression of `#if`, once `defined` and macros have been
+/// replaced; identifiers left are 0.
+class ExpressionEvaluator {
+    const std::string& text;
+    size_t pos = 0;
+
+    void skip() { pos = skipSpaces(text, pos); }
+    bool accept(const char* op) {
+        skip();
+        auto len = strlen(op);
+        if (text.compare(pos, len, op) != 0) return false;
+        // Do not take `<` for `<<`, `&` for `&&`, and so on
+        if (len == 1 && pos + 1 < text.size()) {
+            char next = text[pos + 1];
+            if ((op[0] == '<' || op[0] == '>') && (next == op[0] || next == '='))
+                return false;
+            if ((op[0] == '&' || op[0] == '|') && next == op[0]) return false;
+            if ((op[0] == '!' || op[0] == '=') && next == '=') return false;
+        }
+        pos += len;
+        return true;
+    }
+    void expect(const char* op) {
+        if (!accept(op)) unsupported(std::string("expected ") + op + " in #if expression");
+    }
+
+    intmax_t primary() {
+        skip();
+        if (accept("(")) {
+            auto value = conditional();
+            expect(")");
+            return value;
+        }
+        if (pos < text.size() && isdigit(static_cast<unsigned char>(text[pos]))) {
+            auto end = skipNumber(text, pos);
+            auto number = text.substr(pos, end - pos);
+            while (!number.empty() && strchr("uUlL", number.back())) number.pop_back();
+            char* last;
+            auto value = strtoumax(number.c_str(), &last, 0);
+            if (*last != 0) unsupported("invalid number " + number + " in #if expression");
+            pos = end;
+            return static_cast<intmax_t>(value);
+        }
+        if (pos < text.size() && isIdentStart(text[pos])) {
+            pos = identEnd(text, pos);
+            return 0;
+        }
+        unsupported("invalid #if expression");
+    }
+    intmax_t unary() {
+        if (accept("!")) return !unary();
+        if (accept("~")) return ~unary();
+        if (accept("-")) return -unary();
+        if (accept("+")) return unary();
+        return primary();
+    }
+    intmax_t multiplicative() {
+        auto value = unary();
+        while (true) {
+            if (accept("*")) {
+                value *= unary();
+            } else if (accept("/") || accept("%")) {
+                bool div = text[pos - 1] == '/';
+                auto right = unary();
+                if (right == 0) unsupported("division by zero in #if expression");
+                value = div ? value / right : value % right;
+            } else {
+                return value;
+            }
+        }
+    }
+    intmax_t additive() {
+        auto value = multiplicative();
+        while (true) {
+            if (accept("+"))
+                value += multiplicative();
+            else if (accept("-"))
+                value -= multiplicative();
+            else
+                return value;
+        }
+    }
+    intmax_t shift() {
+        auto value = additive();
+        while (true) {
+            if (accept("<<"))
+                value <<= additive();
+            else if (accept(">>"))
+                value >>= additive();
+            else
+                return value;
+        }
+    }
+    intmax_t relational() {
+        auto value = shift();
+        while (true) {
+            if (accept("<="))
+                value = value <= shift();
+            else if (accept(">="))
+                value = value >= shift();
+            else if (accept("<"))
+                value = value < shift();
+            else if (accept(">"))
+                value = value > shift();
+            else
+                return value;
+        }
+    }
+    intmax_t equality() {
+        auto value = relational();
+        while (true) {
+            if (accept("=="))
+                value = value == relational();
+            else if (accept("!="))
+                value = value != relational();
+            else
+                return value;
+        }
+    }
+    intmax_t bitAnd() {
+        auto value = equality();
+        while (accept("&")) value &= equality();
+        return value;
+    }
+    intmax_t bitXor() {
+        auto value = bitAnd();
+        while (accept("^")) value ^= bitAnd();
+        return value;
+    }
+    intmax_t bitOr() {
+        auto value = bitXor();
+        while (accept("|")) value |= bitXor();
+        return value;
+    }
+    intmax_t logicalAnd() {
+        auto value = bitOr();
+        while (accept("&&")) {
+            auto right = bitOr();
+            value = value && right;
+        }
+        return value;
+    }
+    intmax_t logicalOr() {
+        auto value = logicalAnd();
+        while (accept("||")) {
+            auto right = logicalAnd();
+            value = value || right;
+        }
+        return value;
+    }
+    intmax_t conditional() {
+        auto value = logicalOr();
+        if (!accept("?")) return value;
+        auto ifTrue = conditional();
+        expect(":");
+        auto ifFalse = conditional();
+        return value ? ifTrue : ifFalse;
+    }
+
+ public:
+    explicit ExpressionEvaluator(const std::string& text) : text(text) {}
+    intmax_t evaluate() {
+        auto value = conditional();
+        skip();
+        if (pos != text.size()) unsupported("invalid #if expression");
+        return value;
+    }
+};
+
+}  // namespace
+
+void Preprocessor::OutputPrinter::marker(const std::string& name, size_t at,
+                                         const char* flags) {
+    if (printed) output += '\n';
+    printed = false;
+    file = name;
+    line = at;
+    output += "# " + std::to_string(at) + " " + quoteFileName(name) + flags + "\n";
+}
+
+void Preprocessor::OutputPrinter::moveTo(const std::string& name, size_t at) {
+    if (printed) {
+        output += '\n';
+        line++;
+        printed = false;
+    }
+    if (name == file && at >= line && at < line + 8) {
+        output.append(at - line, '\n');
+        line = at;
+    } else {
+        marker(name, at, "");
+    }
+}
+
+/* static */ void Preprocessor::clearCache() {
+    files.clear();
+}
+
+bool Preprocessor::setOptions(const std::string& options, std::string& reason) {
+    std::vector<std::string> args;
+    for (size_t pos = skipSpaces(options, 0); pos < options.size(); ) {
+        auto end = pos;
+        while (end < options.size() && !isSpace(options[end])) end++;
+        args.push_back(options.substr(pos, end - pos));
+        pos = skipSpaces(options, end);
+    }
+    for (size_t i = 0; i < args.size(); i++) {
+        auto& arg = args[i];
+        // The external preprocessor is run by the shell, which handles quotes
+        if (arg.find_first_of("\"'\\$`") != std::string::npos) {
+            reason = "quoted option " + arg;
+            return false;
+        }
+        auto option = arg.substr(0, 2);
+        auto value = arg.substr(2);
+        if ((option == "-I" || option == "-D" || option == "-U") && value.empty()) {
+            if (i + 1 == args.size()) {
+                reason = "missing value for " + option;
+                return false;
+            }
+            value = args[++i];
+        }
+        if (option == "-I") {
+            addIncludeDir(value);
+        } else if (option == "-D") {
+            if (!define(value, reason)) return false;
+        } else if (option == "-U") {
+            undefine(value);
+        } else {
+            reason = "option " + arg;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Preprocessor::define(const std::string& definition, std::string& reason) {
+    auto eq = definition.find('=');
+    auto text = eq == std::string::npos
+            ? definition + " 1"
+            : definition.substr(0, eq) + " " + definition.substr(eq + 1);
+    try {
+        defineMacro(text);
+    } catch (const Unsupported& e) {
+        reason = e.reason;
+        return false;
+    }
+    return true;
+}
+
+bool Preprocessor::run(const std::string& file, std::string& output, std::string& reason) {
+    auto text = readFile(file, false);
+    if (!text) {
+        reason = "cannot read " + file;
+        stats.fallbacks++;
+        return false;
+    }
+    output.clear();
+    includedFiles.clear();
+    try {
+        OutputPrinter printer(output);
+        processFile(text, file, printer, 0);
+        printer.finish();
+    } catch (const Unsupported& e) {
+        reason = e.reason;
+        stats.fallbacks++;
+        return false;
+    }
+    return true;
+}
+
+/// Defines a macro from the text after `#define`.
+void Preprocessor::defineMacro(const std::string& text) {
+    auto pos = skipSpaces(text, 0);
+    auto end = identEnd(text, pos);
+    if (end == pos || !isIdentStart(text[pos])) unsupported("invalid macro name in " + text);
+    auto name = text.substr(pos, end - pos);
+    if (name == "defined" || isBuiltinMacro(name)) unsupported("definition of " + name);
+    Macro macro;
+    pos = end;
+    if (pos < text.size() && text[pos] == '(') {
+        macro.functionLike = true;
+        pos = skipSpaces(text, pos + 1);
+        if (pos < text.size() && text[pos] == ')') {
+            pos++;
+        } else {
+            while (true) {
+                pos = skipSpaces(text, pos);
+                end = identEnd(text, pos);
+                if (end == pos || !isIdentStart(text[pos]))
+                    unsupported("invalid parameters for macro " + name);
+                macro.params.push_back(text.substr(pos, end - pos));
+                pos = skipSpaces(text, end);
+                if (pos < text.size() && text[pos] == ',') {
+                    pos++;
+                } else if (pos < text.size() && text[pos] == ')') {
+                    pos++;
+                    break;
+                } else {
+                    unsupported("invalid parameters for macro " + name);
+                }
+            }
+        }
+    }
+    macro.body = trim(text.substr(pos));
+    for (size_t i = 0; i < macro.body.size(); i++) {
+        if (macro.body[i] == '"')
+            i = skipString(macro.body, i) - 1;
+        else if (macro.body[i] == '#')
+            unsupported("# or ## in macro " + name);
+    }
+    macros[name] = std::move(macro);
+}
+
+/// Macro-expands @text, without expanding the macros in @disabled.  In the
+/// lines of a file, @inComment tracks block comments, which are kept; @text
+/// must not contain comments otherwise.
+std::string Preprocessor::expand(const std::string& text, const std::set<std::string>& disabled,
+                                 bool* inComment) {
+    std::string result;
+    size_t pos = 0;
+    while (pos < text.size()) {
+        if (inComment && *inComment) {
+            auto close = text.find("*/", pos);
+            auto end = close == std::string::npos ? text.size() : close + 2;
+            result.append(text, pos, end - pos);
+            if (close != std::string::npos) *inComment = false;
+            pos = end;
+            continue;
+        }
+        char c = text[pos];
+        char next = pos + 1 < text.size() ? text[pos + 1] : 0;
+        if (c == '/' && (next == '*' || next == '/')) {
+            if (!inComment) unsupported("comment in macro arguments");
+            if (next == '/') {
+                result.append(text, pos, std::string::npos);
+                break;
+            }
+            *inComment = true;
+            result += "/*";
+            pos += 2;
+        } else if (c == '"') {
+            auto end = skipString(text, pos, inComment != nullptr);
+            result.append(text, pos, end - pos);
+            pos = end;
+        } else if (isdigit(static_cast<unsigned char>(c)) ||
+                   (c == '.' && isdigit(static_cast<unsigned char>(next)))) {
+            auto end = skipNumber(text, pos);
+            result.append(text, pos, end - pos);
+            pos = end;
+        } else if (isIdentStart(c)) {
+            auto end = identEnd(text, pos);
+            auto name = text.substr(pos, end - pos);
+            pos = end;
+            auto expansion = expandName(name, text, pos, disabled);
+            if (expansion == name) {
+                result += name;
+                continue;
+            }
+            // Spaces are added around expansions as cpp does
+            if (avoidPaste(result, expansion)) result += ' ';
+            result += expansion;
+            if (pos < text.size() && avoidPaste(result, text.substr(pos, 2))) result += ' ';
+        } else {
+            result += c;
+            pos++;
+        }
+    }
+    return result;
+}
+
+/// Expands the identifier @name found in @text; for a function-like macro,
+/// consumes the arguments that follow @pos.
+std::string Preprocessor::expandName(const std::string& name, const std::string& text,
+                                     size_t& pos, const std::set<std::string>& disabled) {
+    auto it = macros.find(name);
+    if (it == macros.end()) {
+        if (isBuiltinMacro(name)) unsupported("built-in macro " + name);
+        return name;
+    }
+    if (disabled.count(name)) return name;
+    const Macro& macro = it->second;
+    auto inner = disabled;
+    inner.insert(name);
+    if (!macro.functionLike)
+        return expand(macro.body, inner, nullptr);
+
+    auto open = skipSpaces(text, pos);
+    // In C, the arguments may start on a later line, or after the text a
+    // macro expands to.
+    if (open == text.size()) unsupported("invocation of macro " + name + " may span lines");
+    if (text[open] != '(') return name;
+
+    std::vector<std::string> args;
+    std::string arg;
+    int depth = 0;
+    for (pos = open + 1; ; pos++) {
+        if (pos >= text.size()) unsupported("arguments of macro " + name + " span lines");
+        char c = text[pos];
+        if (c == '"') {
+            auto end = skipString(text, pos);
+            arg.append(text, pos, end - pos);
+            pos = end - 1;
+            continue;
+        }
+        if (text.compare(pos, 2, "/*") == 0 || text.compare(pos, 2, "//") == 0)
+            unsupported("comment in arguments of macro " + name);
+        if (c == '(') {
+            depth++;
+        } else if (c == ')' && depth > 0) {
+            depth--;
+        } else if (c == ')' || (c == ',' && depth == 0)) {
+            args.push_back(trim(arg));
+            arg.clear();
+            if (c == ')') break;
+            continue;
+        }
+        arg += c;
+    }
+    pos++;
+    if (macro.params.empty() && args.size() == 1 && args[0].empty())
+        args.clear();
+    if (args.size() != macro.params.size())
+        unsupported("wrong number of arguments for macro " + name);
+
+    // Arguments are fully expanded before substitution
+    std::map<std::string, std::string> values;
+    for (size_t i = 0; i < args.size(); i++)
+        values[macro.params[i]] = expand(args[i], disabled, nullptr);
+    std::string body;
+    for (size_t i = 0; i < macro.body.size(); ) {
+        char c = macro.body[i];
+        if (c == '"') {
+            auto end = skipString(macro.body, i);
+            body.append(macro.body, i, end - i);
+            i = end;
+        } else if (isdigit(static_cast<unsigned char>(c))) {
+            auto end = skipNumber(macro.body, i);
+            body.append(macro.body, i, end - i);
+            i = end;
+        } else if (isIdentStart(c)) {
+            auto end = identEnd(macro.body, i);
+            auto param = values.find(macro.body.substr(i, end - i));
+            if (param != values.end())
+                body += param->second;
+            else
+                body.append(macro.body, i, end - i);
+            i = end;
+        } else {
+            body += c;
+            i++;
+        }
+    }
+    return expand(body, inner, nullptr);
+}
+
+bool Preprocessor::evaluate(const std::string& expression) {
+    // `defined` is replaced before macro expansion
+    std::string text;
+    for (size_t pos = 0; pos < expression.size(); ) {
+        if (!isIdentStart(expression[pos])) {
+            if (isdigit(static_cast<unsigned char>(expression[pos]))) {
+                auto end = skipNumber(expression, pos);
+                text.append(expression, pos, end - pos);
+                pos = end;
+            } else {
+                text += expression[pos++];
+            }
+            continue;
+        }
+        auto end = identEnd(expression, pos);
+        auto name = expression.substr(pos, end - pos);
+        pos = end;
+        if (name != "defined") {
+            text += name;
+            continue;
+        }
+        pos = skipSpaces(expression, pos);
+        bool paren = pos < expression.size() && expression[pos] == '(';
+        if (paren) pos = skipSpaces(expression, pos + 1);
+        end = identEnd(expression, pos);
+        if (end == pos) unsupported("invalid use of defined");
+        auto macro = expression.substr(pos, end - pos);
+        if (isBuiltinMacro(macro)) unsupported("built-in macro " + macro);
+        pos = skipSpaces(expression, end);
+        if (paren) {
+            if (pos >= expression.size() || expression[pos] != ')')
+                unsupported("invalid use of defined");
+            pos++;
+        }
+        text += macros.count(macro) ? " 1 " : " 0 ";
+    }
+    return ExpressionEvaluator(expand(text, {}, nullptr)).evaluate() != 0;
+}
+
+/// Looks up the file as cpp does, which only searches the include path once
+/// for each name and starting directory.
+std::shared_ptr<Preprocessor::IncludedFile>
+Preprocessor::findInclude(const std::string& directive, const std::string& file) {
+    auto pos = skipSpaces(directive, 0);
+    if (pos >= directive.size() || (directive[pos] != '"' && directive[pos] != '<'))
+        unsupported("computed #include");
+    bool quoted = directive[pos] == '"';
+    auto close = directive.find(quoted ? '"' : '>', pos + 1);
+    if (close == std::string::npos) unsupported("invalid #include");
+    if (skipSpaces(directive, close + 1) != directive.size())
+        unsupported("extra text after #include");
+    auto included = directive.substr(pos + 1, close - pos - 1);
+
+    auto found = [this](const std::string& key, const std::string& path,
+                        std::shared_ptr<SourceText> text) {
+        auto result = std::make_shared<IncludedFile>();
+        result->path = path;
+        result->text = text;
+        return includedFiles[key] = result;
+    };
+    if (!included.empty() && included[0] == '/') {
+        auto key = "/\n" + included;
+        auto it = includedFiles.find(key);
+        if (it != includedFiles.end()) return it->second;
+        if (auto text = readFile(included, false)) return found(key, included, text);
+        unsupported("cannot find include file " + included);
+    }
+
+    std::string quoteKey;
+    if (quoted) {
+        auto slash = file.rfind('/');
+        auto dir = slash == std::string::npos ? "" : file.substr(0, slash + 1);
+        quoteKey = "\"" + dir + "\n" + included;
+        auto it = includedFiles.find(quoteKey);
+        if (it != includedFiles.end()) return it->second;
+        if (auto text = readFile(dir + included, false))
+            return found(quoteKey, dir + included, text);
+    }
+    // A quoted include which continues in the include path shares the
+    // file found for the same name in angle brackets.
+    auto bracketKey = "<\n" + included;
+    std::shared_ptr<IncludedFile> result;
+    auto it = includedFiles.find(bracketKey);
+    if (it != includedFiles.end()) {
+        result = it->second;
+    } else {
+        for (auto& dir : includeDirs) {
+            auto path = dir + "/" + included;
+            if (auto text = readFile(path, true)) {
+                result = found(bracketKey, path, text);
+                break;
+            }
+        }
+    }
+    if (!result) unsupported("cannot find include file " + included);
+    if (quoted) includedFiles[quoteKey] = result;
+    return result;
+}
+
+void Preprocessor::processFile(std::shared_ptr<SourceText> text, const std::string& name,
+                               OutputPrinter& printer, unsigned depth) {
+    if (depth > maxIncludeDepth) unsupported("#include nested too deeply");
+    printer.marker(name, 1, depth > 0 ? " 1" : "");
+
+    // Include guard detection: the file must consist of `#ifndef X` (or
+    // `#if !defined X`) ... `#endif`, apart from blank lines and comments.
+    // The lines of the guard are skipped when X is defined; the comments
+    // around it are still printed.
+    enum { Start, InGuard, AfterGuard, NoGuard } guardState = Start;
+    std::string guard;
+    size_t guardBegin = 0, guardEnd = 0;
+    bool guardOnly = true;
+    bool skipGuard = text->guardKnown && !text->guard.empty() && macros.count(text->guard);
+
+    std::vector<Conditional> conditionals;
+    auto active = [&conditionals]() {
+        return conditionals.empty() || conditionals.back().active;
+    };
+    bool inComment = false;
+    auto& lines = text->lines;
+    for (size_t i = 0; i < lines.size(); ) {
+        if (skipGuard && i == text->guardBegin) {
+            i = text->guardEnd + 1;
+            continue;
+        }
+        size_t pos = 0;
+        bool isDirective = false;
+        std::string directive;
+        if (!inComment) directive = directiveName(lines[i], pos, isDirective);
+        if (!isDirective) {
+            auto& line = lines[i++];
+            if (!line.empty() && line.back() == '\\')
+                unsupported("line continuation outside of a directive");
+            bool wasInComment = inComment;
+            bool empty = !wasInComment && trim(line).empty();
+            if (active()) {
+                auto output = normalizeSpaces(expand(line, {}, &inComment), wasInComment);
+                // cpp prints the lines which have a token, even if it
+                // expands to nothing (then with one space less before it);
+                // comments are tokens with -C
+                if (output.empty() && !empty)
+                    output.append(std::max<size_t>(skipSpaces(line, 0), 1) - 1, ' ');
+                if (!empty) printer.print(name, i, output);
+                if (guardState != InGuard) {
+                    bool comment = wasInComment;
+                    if (!isBlank(line, comment)) guardState = NoGuard;
+                    if (!empty) guardOnly = false;
+                }
+            } else {
+                isBlank(line, inComment);
+            }
+            // cpp counts the lines of such comments differently
+            if (inComment && text->crlf) unsupported("comment spanning CRLF lines");
+            continue;
+        }
+
+        // Directives may continue on the next lines
+        auto first = i;
+        auto body = lines[i++].substr(pos);
+        while (!body.empty() && body.back() == '\\' && i < lines.size()) {
+            body.pop_back();
+            body += lines[i++];
+        }
+        body = stripComments(body);
+
+        if (guardState == AfterGuard) guardState = NoGuard;
+        if (guardState == Start) {
+            if (directive == "ifndef")
+                guard = trim(body);
+            else if (directive == "if")
+                guard = negatedDefined(body);
+            else
+                guard.clear();
+            guardState = guard.empty() ? NoGuard : InGuard;
+            guardBegin = first;
+        }
+
+        if (directive == "if" || directive == "ifdef" || directive == "ifndef") {
+            bool parentActive = active();
+            bool value = false;
+            if (parentActive) {
+                if (directive == "if") {
+                    value = evaluate(body);
+                } else {
+                    auto macro = trim(body);
+                    if (!isIdentifier(macro)) unsupported("invalid #" + directive);
+                    if (isBuiltinMacro(macro)) unsupported("built-in macro " + macro);
+                    value = macros.count(macro) == (directive == "ifdef" ? 1u : 0u);
+                }
+            }
+            conditionals.push_back({ parentActive && value, value, false, parentActive });
+        } else if (directive == "elif" || directive == "else") {
+            if (conditionals.empty() || conditionals.back().sawElse)
+                unsupported("#" + directive + " without #if");
+            auto& cond = conditionals.back();
+            bool value = false;
+            if (cond.parentActive && !cond.taken)
+                value = directive == "else" || evaluate(body);
+            cond.active = cond.parentActive && value;
+            cond.taken = cond.taken || value;
+            cond.sawElse = directive == "else";
+            if (guardState == InGuard && conditionals.size() == 1) guardState = NoGuard;
+        } else if (directive == "endif") {
+            if (conditionals.empty()) unsupported("#endif without #if");
+            conditionals.pop_back();
+            if (guardState == InGuard && conditionals.empty()) {
+                guardState = AfterGuard;
+                guardEnd = i - 1;
+            }
+        } else if (!active()) {
+            // Other directives are ignored in skipped branches
+        } else if (directive == "define") {
+            defineMacro(body);
+        } else if (directive == "undef") {
+            auto macro = trim(body);
+            if (isBuiltinMacro(macro)) unsupported("#undef of " + macro);
+            macros.erase(macro);
+        } else if (directive == "include") {
+            auto included = findInclude(body, name);
+            // Like cpp, do not even enter a file which has been read already
+            // and only consists of an include guard whose macro is defined.
+            auto& guarded = *included->text;
+            if (included->processed && guarded.guardOnly && macros.count(guarded.guard))
+                continue;
+            printer.moveTo(name, first + 1);
+            processFile(included->text, included->path, printer, depth + 1);
+            included->processed = true;
+            printer.marker(name, i + 1, " 2");
+        } else if (directive.empty() && trim(body).empty()) {
+            // The null directive
+        } else {
+            unsupported("#" + directive + " directive");
+        }
+    }
+    if (!conditionals.empty()) unsupported("unterminated #if");
+    if (inComment) unsupported("unterminated comment");
+    if (!skipGuard) {
+        text->guardKnown = true;
+        text->guard = guardState == AfterGuard ? guard : "";
+        text->guardBegin = guardBegin;
+        text->guardEnd = guardEnd;
+        text->guardOnly = guardState == AfterGuard && guardOnly;
+    }
+}
+
+}  // namespace P4
@@ -0,0 +1,123 @@
+/*
+Copyright 2013-present Barefoot Networks, Inc.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef _FRONTENDS_COMMON_PREPROCESSOR_H_
+#define _FRONTENDS_COMMON_PREPROCESSOR_H_
+
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace P4 {
+
+/**
+ * An in-process C preprocessor for the subset of the language that P4
+ * programs and the standard include files use:
+ *  - `#include "file"` and `#include <file>`;
+ *  - `#define` and `#undef` of object-like and function-like macros;
+ *  - `#if`, `#ifdef`, `#ifndef`, `#elif`, `#else` and `#endif`, with integer
+ *    expressions and `defined`.
+ * Comments are kept, as with `cpp -C`, and the output has the same lines and
+ * line markers as that of GNU cpp, so that source positions are the same as
+ * with the external preprocessor.  Only the markers that cpp prints for
+ * `<built-in>` and `<command-line>` before the first line, which depend on
+ * its version, are left out.
+ *
+ * Anything else (e.g. `#pragma`, `#error`, `#` and `##` in macros, macro
+ * invocations spanning several lines, built-in macros such as `__LINE__`,
+ * missing include files) makes run() fail: the caller then falls back to the
+ * external preprocessor, which either supports the construct or reports the
+ * error.
+ *
+ * The lines of the files found in the include path are read once per
+ * process and kept in memory, so that a process which compiles many programs
+ * (e.g. the compile server) does not read the standard include files again;
+ * their macros are still expanded by each run, as definitions may differ.
+ * Each file also keeps its include guard once it has been processed, so
+ * that later includes skip the guarded lines, in this run or another one,
+ * when the guard macro is defined.
+ */
+class Preprocessor {
+ public:
+    struct Stats {
+        unsigned fileHits = 0;    // include files found in memory
+        unsigned fileMisses = 0;  // include files read from disk
+        unsigned fallbacks = 0;   // runs stopped by an unsupported construct
+    };
+    static Stats stats;
+
+    /// Applies the cpp options in @options, separated by spaces; -I, -D and
+    /// -U are supported.  @return false, with the reason in @reason, if there
+    /// are other options.
+    bool setOptions(const std::string& options, std::string& reason);
+    /// Appends @dir to the include path, as the -I option of cpp.
+    void addIncludeDir(const std::string& dir) { includeDirs.push_back(dir); }
+    /// Defines a macro as the -D option of cpp does, e.g. `X`, `X=2` or
+    /// `F(a)=a+1`.  @return false, with the reason in @reason, if the
+    /// definition is not supported.
+    bool define(const std::string& definition, std::string& reason);
+    /// Undefines a macro, as the -U option of cpp.
+    void undefine(const std::string& name) { macros.erase(name); }
+
+    /// Preprocesses @file.  @return true and the preprocessed text in
+    /// @output, or false and the reason in @reason if the external
+    /// preprocessor must be used instead.
+    bool run(const std::string& file, std::string& output, std::string& reason);
+
+    /// Forgets the include files kept in memory.
+    static void clearCache();
+
+    /// The lines of a file read by the preprocessor.
+    struct SourceText;
+    struct IncludedFile;
+    class OutputPrinter;
+
+ private:
+    struct Macro {
+        bool functionLike = false;
+        std::vector<std::string> params;
+        std::string body;
+    };
+    struct Conditional {
+        bool active;       // lines in the current branch are kept
+        bool taken;        // a branch has been active already
+        bool sawElse;
+        bool parentActive;
+    };
+
+    std::vector<std::string> includeDirs;
+    std::map<std::string, Macro> macros;
+    /// Files included in the current run, by start directory and name
+    std::map<std::string, std::shared_ptr<IncludedFile>> includedFiles;
+
+    void defineMacro(const std::string& text);
+    void processFile(std::shared_ptr<SourceText> text, const std::string& name,
+                     OutputPrinter& printer, unsigned depth);
+    /// Handles `#include` in @file; @return the included file.
+    std::shared_ptr<IncludedFile> findInclude(const std::string& directive,
+                                              const std::string& file);
+    std::string expand(const std::string& text, const std::set<std::string>& disabled,
+                       bool* inComment);
+    std::string expandName(const std::string& name, const std::string& text, size_t& pos,
+                           const std::set<std::string>& disabled);
+    bool evaluate(const std::string& expression);
+};
+
+}  // namespace P4
+
+#endif /* _FRONTENDS_COMMON_PREPROCESSOR_H_ */
@@ -39,58 +39,70 @@ ResolutionContext::resolve(IR::ID name, P4::ResolutionType type) const {
     return &empty;
 }
 
+const std::vector<const IR::IDeclaration*>&
+ResolutionContext::getDeclsByName(const IR::IGeneralNamespace *ns, cstring name) const {
+    auto index = nameIndex.find(ns);
+    if (index == nameIndex.end()) {
+        index = nameIndex.emplace(ns, NameIndex()).first;
+        for (auto *decl : *ns->getDeclarations()) {
+            CHECK_NULL(decl);
+            index->second[decl->getName().name].push_back(decl); }
+        LOG3("Indexed " << index->second.size() << " names in " << dbp(ns->getNode())); }
+    indexedLookups++;
+    auto decls = index->second.find(name);
+    if (decls == index->second.end())
+        return empty;
+    return decls->second;
+}
+
 const std::vector<const IR::IDeclaration*>*
 ResolutionContext::lookup(const IR::INamespace *current, IR::ID name,
                           P4::ResolutionType type) const {
     LOG2("Trying to resolve in " << current->toString());
 
     if (auto gen = current->to<IR::IGeneralNamespace>()) {
-        Util::Enumerator<const IR::IDeclaration*> *decls = gen->getDeclsByName(name);
-        switch (type) {
-            case P4::ResolutionType::Any:
-                break;
-            case P4::ResolutionType::Type: {
-                std::function<bool(const IR::IDeclaration*)> kindFilter =
-                        [](const IR::IDeclaration *d) {
-                    return d->is<IR::Type>(); };
-                decls = decls->where(kindFilter);
-                break; }
-            case P4::ResolutionType::TypeVariable: {
-                std::function<bool(const IR::IDeclaration*)> kindFilter =
-                        [](const IR::IDeclaration *d) {
-                return d->is<IR::Type_Var>(); };
-                decls = decls->where(kindFilter);
-                break; }
-        default:
-            BUG("Unexpected enumeration value %1%", static_cast<int>(type)); }
-
-        if (!anyOrder && name.srcInfo.isValid()) {
-            std::function<bool(const IR::IDeclaration*)> locationFilter =
-                    [this, name, type](const IR::IDeclaration *d) {
-                if (d->is<IR::Type_Var>() || d->is<IR::ParserState>())
-                    // type vars and parser states may be used before their definitions
+        auto &candidates = getDeclsByName(gen, name);
+        auto kindFilter = [type](const IR::IDeclaration *d) {
+            switch (type) {
+                case P4::ResolutionType::Any:
                     return true;
-                Util::SourceInfo nsi = name.srcInfo;
-                Util::SourceInfo dsi = d->getNode()->srcInfo;
-                bool before = dsi <= nsi;
-                LOG3("\tPosition test:" << dsi << "<=" << nsi << "=" << before);
-
-                if (type == ResolutionType::Type) {
-                    if (auto *type_decl = findContext<IR::Type_Declaration>())
-                        if (type_decl->getNode() == d->getNode()) {
-                            ::error(ErrorType::ERR_UNSUPPORTED,
-                                "Self-referencing types not supported: '%1%' within '%2%'",
-                                name, d->getNode()); }
-                } else if (type == ResolutionType::Any) {
-                    if (auto *decl_ctxt = findContext<IR::Declaration>())
-                        if (decl_ctxt->getNode() == d->getNode())
-                            before = false; }
-
-                return before; };
-            decls = decls->where(locationFilter); }
-
-        auto vector = decls->toVector();
-        if (!vector->empty()) {
+                case P4::ResolutionType::Type:
+                    return d->is<IR::Type>();
+                case P4::ResolutionType::TypeVariable:
+                    return d->is<IR::Type_Var>();
+            }
+            BUG("Unexpected enumeration value %1%", static_cast<int>(type)); };
+        bool checkLocation = !anyOrder && name.srcInfo.isValid();
+        auto locationFilter = [this, name, type](const IR::IDeclaration *d) {
+            if (d->is<IR::Type_Var>() || d->is<IR::ParserState>())
+                // type vars and parser states may be used before their definitions
+                return true;
+            Util::SourceInfo nsi = name.srcInfo;
+            Util::SourceInfo dsi = d->getNode()->srcInfo;
+            bool before = dsi <= nsi;
+            LOG3("\tPosition test:" << dsi << "<=" << nsi << "=" << before);
+
+            if (type == ResolutionType::Type) {
+                if (auto *type_decl = findContext<IR::Type_Declaration>())
+                    if (type_decl->getNode() == d->getNode()) {
+                        ::error(ErrorType::ERR_UNSUPPORTED,
+                            "Self-referencing types not supported: '%1%' within '%2%'",
+                            name, d->getNode()); }
+            } else if (type == ResolutionType::Any) {
+                if (auto *decl_ctxt = findContext<IR::Declaration>())
+                    if (decl_ctxt->getNode() == d->getNode())
+                        before = false; }
+
+            return before; };
+
+        std::vector<const IR::IDeclaration*> *vector = nullptr;
+        for (auto *d : candidates) {
+            if (!kindFilter(d) || (checkLocation && !locationFilter(d)))
+                continue;
+            if (!vector)
+                vector = new std::vector<const IR::IDeclaration*>();
+            vector->push_back(d); }
+        if (vector) {
             LOG3("Resolved in " << dbp(current->getNode()));
             return vector; }
     } else if (auto simple = current->to<IR::ISimpleNamespace>()) {
@@ -147,10 +159,16 @@ ResolutionContext::lookup(const IR::INamespace *current, IR::ID name,
 
 const std::vector<const IR::IDeclaration*> *ResolutionContext::lookupMatchKind(IR::ID name) const {
     if (auto *global = findContext<IR::P4Program>()) {
-        for (auto *obj : global->objects) {
-            if (auto *match_kind = obj->to<IR::Declaration_MatchKind>()) {
-                auto *rv = lookup(match_kind, name, ResolutionType::Any);
-                if (!rv->empty()) return rv; } } }
+        auto kinds = matchKinds.find(global);
+        if (kinds == matchKinds.end()) {
+            kinds = matchKinds.emplace(global,
+                                       std::vector<const IR::Declaration_MatchKind*>()).first;
+            for (auto *obj : global->objects)
+                if (auto *match_kind = obj->to<IR::Declaration_MatchKind>())
+                    kinds->second.push_back(match_kind); }
+        for (auto *match_kind : kinds->second) {
+            auto *rv = lookup(match_kind, name, ResolutionType::Any);
+            if (!rv->empty()) return rv; } }
     return &empty;
 }
 
@@ -340,11 +358,15 @@ Visitor::profile_t ResolveReferences::init_apply(const IR::Node *node) {
     anyOrder = refMap->isV1();
     if (!refMap->checkMap(node))
         refMap->clear();
+    if (node != indexedRoot) {
+        clearIndex();
+        indexedRoot = node; }
     return Inspector::init_apply(node);
 }
 
 void ResolveReferences::end_apply(const IR::Node *node) {
     refMap->updateMap(node);
+    LOG2(indexedLookups << " indexed lookups in " << indexedNamespaces() << " namespaces");
 }
 
 // Visitor methods
@@ -17,6 +17,9 @@ limitations under the License.
 #ifndef _COMMON_RESOLVEREFERENCES_RESOLVEREFERENCES_H_
 #define _COMMON_RESOLVEREFERENCES_RESOLVEREFERENCES_H_
 
+#include <unordered_map>
+#include <vector>
+
 #include "ir/ir.h"
 #include "referenceMap.h"
 #include "lib/exceptions.h"
@@ -33,7 +36,27 @@ enum class ResolutionType {
 
 /// Visitor mixin for looking up names in enclosing scopes from the Visitor::Context
 class ResolutionContext : virtual public Visitor, public DeclarationLookup {
+    typedef std::unordered_map<cstring, std::vector<const IR::IDeclaration*>> NameIndex;
+
+    /// Name to declarations index of each general namespace, built the first
+    /// time a name is looked up in it.  IR nodes are not modified once built,
+    /// so an index stays valid until its namespace node is replaced.
+    mutable std::unordered_map<const IR::IGeneralNamespace*, NameIndex> nameIndex;
+    /// match_kind declarations of each program, in program order.
+    mutable std::unordered_map<const IR::P4Program*,
+                               std::vector<const IR::Declaration_MatchKind*>> matchKinds;
+
  protected:
+    /// Number of lookups answered by nameIndex; for statistics only.
+    mutable size_t indexedLookups = 0;
+
+    /// All declarations called @p name in @p ns, in declaration order.
+    const std::vector<const IR::IDeclaration*>&
+    getDeclsByName(const IR::IGeneralNamespace *ns, cstring name) const;
+    /// Drop all cached namespace indices.
+    void clearIndex() const { nameIndex.clear(); matchKinds.clear(); indexedLookups = 0; }
+    size_t indexedNamespaces() const { return nameIndex.size(); }
+
     // Note that all errors have been merged by the parser into
     // a single error { } namespace.
 
@@ -89,6 +112,10 @@ class ResolveReferences : public Inspector, private ResolutionContext {
     /// If @true, then warn if one declaration shadows another.
     bool checkShadow;
 
+    /// Root of the last program visited; namespace indices are kept across
+    /// applications to the same program.
+    const IR::Node *indexedRoot = nullptr;
+
  private:
     /// Resolve @p path; if @p isType is `true` then resolution will
     /// only return type nodes.
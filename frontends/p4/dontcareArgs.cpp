@@ -23,7 +23,7 @@ const IR::Node* DontcareArgs::postorder(IR::MethodCallExpression* expression) {
     auto vec = new IR::Vector<IR::Argument>();
 
     auto mi = MethodInstance::resolve(expression, refMap, typeMap);
-    for (auto p : *mi->substitution.getParametersInArgumentOrder()) {
+    for (auto p : mi->substitution.getParametersInArgumentOrder()) {
         auto a = mi->substitution.lookup(p);
         if (a->expression->is<IR::DefaultExpression>()) {
             cstring name = refMap->newName("arg");
@@ -100,10 +100,10 @@ class PrettyPrint : public Inspector {
     }
     bool preorder(const IR::P4Program* program) override {
         if (!ppfile.isNullOrEmpty()) {
-            Util::PathName path(ppfile);
-            std::ostream *ppStream = openFile(path.toString(), true);
-            P4::ToP4 top4(ppStream, false, inputfile);
+            Util::SourceCodeBuilder builder;
+            P4::ToP4 top4(builder, false, inputfile);
             (void)program->apply(top4);
+            builder.writeToFile(ppfile);
         }
         return false;  // prune
     }
@@ -155,6 +155,9 @@ const IR::P4Program *FrontEnd::run(const CompilerOptions &options, const IR::P4P
     refMap.setIsV1(isv1);
 
     auto evaluator = new P4::EvaluatorPass(&refMap, &typeMap);
+    // Do not parse on demand with the handlers of an earlier compilation
+    IR::Annotation::parseBody = nullptr;
+    parseAnnotations.setOnDemand(options.parseAnnotationsOnDemand);
     PassManager passes({
         new P4V1::getV1ModelVersion,
         // Parse annotations
@@ -261,6 +264,11 @@ const IR::P4Program *FrontEnd::run(const CompilerOptions &options, const IR::P4P
     passes.setStopOnError(true);
     passes.addDebugHooks(hooks, true);
     const IR::P4Program* result = program->apply(passes);
+    auto& annotations = parseAnnotations.getStats();
+    LOG1("Front end: " << annotations.parsed << " annotation bodies parsed in "
+         << std::chrono::duration_cast<std::chrono::microseconds>(annotations.parseTime).count()
+         << "us; " << annotations.onDemand << " of " << annotations.deferred
+         << " deferred bodies parsed on demand");
     return result;
 }
 
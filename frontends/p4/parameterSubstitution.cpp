@@ -39,7 +39,7 @@ void ParameterSubstitution::populate(const IR::ParameterList* params,
               "Incompatible number of arguments for parameter list: %1% and %2%",
               params, args);
 
-    auto pe = params->getEnumerator();
+    auto pe = params->begin();
     for (auto a : *args) {
         const IR::Parameter* p;
         if (a->name) {
@@ -49,9 +49,8 @@ void ParameterSubstitution::populate(const IR::ParameterList* params,
                 continue;
             }
         } else {
-            bool success = pe->moveNext();
-            BUG_CHECK(success, "Enumerator finished too soon");
-            p = pe->getCurrent();
+            BUG_CHECK(pe != params->end(), "Parameter list finished too soon");
+            p = *pe++;
         }
         add(p, a);
     }
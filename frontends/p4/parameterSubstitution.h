@@ -22,7 +22,7 @@ limitations under the License.
 #include "ir/ir.h"
 #include "lib/cstring.h"
 #include "lib/exceptions.h"
-#include "lib/enumerator.h"
+#include "lib/iterator_range.h"
 
 namespace P4 {
 
@@ -61,7 +61,7 @@ class ParameterSubstitution : public IHasDbPrint {
     }
 
     const IR::Parameter* findParameter(const IR::Argument* argument) const {
-        for (auto p : *getParametersInOrder())
+        for (auto p : getParametersInOrder())
             if (lookup(p) == argument)
                 return p;
         return nullptr;
@@ -77,20 +77,22 @@ class ParameterSubstitution : public IHasDbPrint {
                   const IR::Vector<IR::Argument>* args);
 
     /// Returns parameters in the order they were added
-    Util::Enumerator<const IR::Parameter*>* getParametersInArgumentOrder() const
-    { return Util::Enumerator<const IR::Parameter*>::createEnumerator(parameters); }
+    Util::iterator_range<std::vector<const IR::Parameter*>::const_iterator>
+    getParametersInArgumentOrder() const
+    { return Util::make_range(parameters); }
 
     /// Returns parameters in the order of the parameter list.
     /// Only works if parameters were inserted using populate.
-    Util::Enumerator<const IR::Parameter*>* getParametersInOrder() const {
+    Util::iterator_range<IR::IndexedVector<IR::Parameter>::const_iterator>
+    getParametersInOrder() const {
         if (paramList == nullptr)
-            return new Util::EmptyEnumerator<const IR::Parameter*>;
-        return paramList->getEnumerator();
+            return { {}, {} };
+        return Util::make_range(paramList->parameters);
     }
 
     void dbprint(std::ostream& out) const {
         if (paramList != nullptr) {
-            for (auto s : *paramList->getEnumerator())
+            for (auto s : *paramList)
                 out << dbp(s) << "=>" << dbp(lookup(s)) << std::endl;
         } else {
             for (auto s : parametersByName)
@@ -16,6 +16,11 @@ limitations under the License.
 
 #include "parseAnnotations.h"
 
+#include <memory>
+
+#include "frontends/parsers/p4/p4parser.hpp"
+#include "lib/log.h"
+
 namespace P4 {
 
 ParseAnnotations::HandlerMap ParseAnnotations::standardHandlers() {
@@ -131,6 +136,68 @@ bool ParseAnnotations::parseP4rtTranslationAnnotation(
     return parsed != nullptr;
 }
 
+bool ParseAnnotations::parseBody(const Handler& handler, IR::Annotation* annotation,
+                                 Stats& stats) {
+    auto start = std::chrono::steady_clock::now();
+    bool parsed = handler(annotation);
+    stats.parseTime += std::chrono::steady_clock::now() - start;
+    stats.parsed++;
+    return parsed;
+}
+
+bool ParseAnnotations::isLiteralBody(const IR::Annotation* annotation) {
+    for (auto token : annotation->body) {
+        switch (token->token_type) {
+        case P4Parser::token_type::TOK_STRING_LITERAL:
+        case P4Parser::token_type::TOK_INTEGER:
+        case P4Parser::token_type::TOK_COMMA:
+            break;
+        default:
+            return false;
+        }
+    }
+    return true;
+}
+
+Visitor::profile_t ParseAnnotations::init_apply(const IR::Node* root) {
+    // Each application starts with new statistics, and forgets the bodies
+    // parsed on demand for an earlier program.
+    state = std::make_shared<State>();
+    if (onDemand) {
+        // The parsed annotations are kept with the handlers, so that each
+        // body is parsed at most once, whichever pass asks for it, even
+        // after this pass is destroyed.
+        auto state = this->state;
+        state->handlers = handlers;
+        IR::Annotation::parseBody = [state](const IR::Annotation* annotation) {
+            auto it = state->parsed.find(annotation);
+            if (it != state->parsed.end())
+                return it->second;
+            auto result = annotation;
+            auto handler = state->handlers.find(annotation->name.name);
+            if (handler != state->handlers.end()) {
+                auto clone = annotation->clone();
+                state->stats.onDemand++;
+                if (parseBody(handler->second, clone, state->stats)) {
+                    clone->needsParsing = false;
+                    result = clone;
+                }
+            }
+            state->parsed.emplace(annotation, result);
+            return result;
+        };
+    }
+    return Modifier::init_apply(root);
+}
+
+void ParseAnnotations::end_apply() {
+    auto& stats = state->stats;
+    LOG1(name() << ": " << stats.parsed << " annotation bodies parsed in "
+         << std::chrono::duration_cast<std::chrono::microseconds>(stats.parseTime).count()
+         << "us, " << stats.deferred << " deferred");
+    Modifier::end_apply();
+}
+
 void ParseAnnotations::postorder(IR::Annotation* annotation) {
     if (!annotation->needsParsing) {
         return;
@@ -151,7 +218,12 @@ void ParseAnnotations::postorder(IR::Annotation* annotation) {
         return;
     }
 
-    annotation->needsParsing = !handlers[name](annotation);
+    if (onDemand && isLiteralBody(annotation)) {
+        state->stats.deferred++;
+        return;
+    }
+
+    annotation->needsParsing = !parseBody(handlers[name], annotation, state->stats);
 }
 
 }  // namespace P4
@@ -17,6 +17,9 @@ limitations under the License.
 #ifndef _P4_PARSEANNOTATIONS_H_
 #define _P4_PARSEANNOTATIONS_H_
 
+#include <chrono>
+#include <memory>
+
 #include "ir/ir.h"
 #include "frontends/p4/typeChecking/typeChecker.h"
 #include "frontends/parsers/parserDriver.h"
@@ -119,6 +122,14 @@ class ParseAnnotations : public Modifier {
     /// Keyed on annotation names.
     typedef std::unordered_map<cstring, Handler> HandlerMap;
 
+    /// Counts of annotation bodies.
+    struct Stats {
+        unsigned parsed = 0;    // bodies parsed, whether eagerly or on demand
+        unsigned deferred = 0;  // bodies left unparsed by an on-demand pass
+        unsigned onDemand = 0;  // deferred bodies parsed when a pass asked for them
+        std::chrono::nanoseconds parseTime{0};  // time spent in the handlers
+    };
+
     /// Produces a pass that rewrites the spec-defined annotations.
     explicit ParseAnnotations(bool warn = false)
             : warnUnknown(warn), handlers(standardHandlers()) {
@@ -142,6 +153,21 @@ class ParseAnnotations : public Modifier {
         }
     }
 
+    /// In on-demand mode the bodies of known annotations which only consist
+    /// of literals, such as `@name("x")`, are not parsed by this pass:
+    /// IR::Annotations::getSingle parses a body, once, when a pass asks for
+    /// the annotation.  Bodies that no pass asks for are never parsed, and
+    /// syntax errors in them are not reported.  Other bodies, such as
+    /// `@length(N + 1)`, are parsed by this pass, so that type checking and
+    /// constant folding process them.
+    void setOnDemand(bool onDemand) { this->onDemand = onDemand; }
+
+    /// The statistics of the last application of this pass, including the
+    /// bodies parsed on demand since then.
+    const Stats& getStats() const { return state->stats; }
+
+    profile_t init_apply(const IR::Node* root) override;
+    void end_apply() override;
     void postorder(IR::Annotation* annotation) final;
 
     static HandlerMap standardHandlers();
@@ -162,6 +188,26 @@ class ParseAnnotations : public Modifier {
     /// Whether to warn about unknown annotations.
     const bool warnUnknown;
 
+    /// Whether to leave the bodies of known annotations unparsed until a
+    /// pass asks for them.
+    bool onDemand = false;
+
+    /// Runs the handler of @annotation and updates @stats.
+    static bool parseBody(const Handler& handler, IR::Annotation* annotation, Stats& stats);
+    /// True if the body of @annotation only has literals, which the front end
+    /// passes after this one leave unchanged.
+    static bool isLiteralBody(const IR::Annotation* annotation);
+
+    /// The state of an application, which IR::Annotation::parseBody shares
+    /// in on-demand mode.
+    struct State {
+        Stats stats;
+        HandlerMap handlers;
+        /// Annotations parsed on demand, by unparsed annotation
+        std::unordered_map<const IR::Annotation*, const IR::Annotation*> parsed;
+    };
+    std::shared_ptr<State> state = std::make_shared<State>();
+
     /// The set of unknown annotations for which warnings have already been
     /// made.
     std::set<cstring> warned;
@@ -369,7 +369,7 @@ class GetWrittenExpressions : public Inspector {
                 return;
             }
         }
-        for (auto p : *mi->substitution.getParametersInArgumentOrder()) {
+        for (auto p : mi->substitution.getParametersInArgumentOrder()) {
             if (!p->hasOut()) continue;
             // The only modified expressions much be left-values
             // that are substituted to out or inout parameters.
@@ -412,14 +412,14 @@ const IR::Node* DoSimplifyExpressions::preorder(IR::MethodCallExpression* mce) {
     gwe.setCalledBy(this);
     mce->apply(gwe);
 
-    for (auto p : *mi->substitution.getParametersInArgumentOrder()) {
+    for (auto p : mi->substitution.getParametersInArgumentOrder()) {
         if (p->direction == IR::Direction::None)
             continue;
         auto arg = mi->substitution.lookup(p);
         if (gwe.written.find(GetWrittenExpressions::everything) != gwe.written.end()) {
             // just copy everything.
             LOG3("Detected table application, using temporaries for all parameters " << arg);
-            for (auto p : *mi->substitution.getParametersInArgumentOrder())
+            for (auto p : mi->substitution.getParametersInArgumentOrder())
                 useTemporary.emplace(p);
             break;
         }
@@ -463,7 +463,7 @@ const IR::Node* DoSimplifyExpressions::preorder(IR::MethodCallExpression* mce) {
     }
 
     // For each argument check to see if it aliases any expression in the written set.
-    for (auto p : *mi->substitution.getParametersInArgumentOrder()) {
+    for (auto p : mi->substitution.getParametersInArgumentOrder()) {
         if (useTemporary.find(p) != useTemporary.end())
             continue;
         auto arg = mi->substitution.lookup(p);
@@ -487,7 +487,7 @@ const IR::Node* DoSimplifyExpressions::preorder(IR::MethodCallExpression* mce) {
     visit(mce->method);
 
     ClonePathExpressions cloner;  // a cheap version of deep copy
-    for (auto p : *mi->substitution.getParametersInArgumentOrder()) {
+    for (auto p : mi->substitution.getParametersInArgumentOrder()) {
         auto arg = mi->substitution.lookup(p);
         if (p->direction == IR::Direction::None) {
             args->push_back(arg);
@@ -42,20 +42,21 @@ class DoStaticAssert : public Transform {
             if (ef->method->name == "static_assert") {
                 auto subst = ef->substitution;
                 auto params = subst.getParametersInOrder();
-                if (!params->moveNext()) {
+                if (params.empty()) {
                     ::warning(ErrorType::WARN_INVALID,
                               "static_assert with no arguments: %1%", method);
                     return method;
                 }
-                auto param = params->getCurrent();
+                auto it = params.begin();
+                auto param = *it;
                 CHECK_NULL(param);
                 auto arg = subst.lookup(param);
                 CHECK_NULL(arg);
                 if (auto bl = arg->expression->to<IR::BoolLiteral>()) {
                     if (!bl->value) {
                         cstring message = "static_assert failed";
-                        if (params->moveNext()) {
-                            param = params->getCurrent();
+                        if (++it != params.end()) {
+                            param = *it;
                             CHECK_NULL(param);
                             auto msg = subst.lookup(param);
                             CHECK_NULL(msg);
@@ -108,6 +108,8 @@ class Namespace : public NamedSymbol {
     void clear() {
         contents.clear();
     }
+    const std::unordered_map<cstring, NamedSymbol*>& getContents() const { return contents; }
+    bool duplicatesAllowed() const { return allowDuplicates; }
     static const Namespace empty;
 };
 
@@ -278,6 +280,81 @@ void ProgramStructure::declareParameters(const IR::IndexedVector<IR::Parameter>*
         declareObject(param->name, param->type->toString());
 }
 
+namespace {
+
+ProgramStructure::Symbol exportSymbol(const NamedSymbol* symbol) {
+    ProgramStructure::Symbol result;
+    result.name = symbol->getName();
+    result.srcInfo = symbol->getSourceInfo();
+    if (auto ct = dynamic_cast<const ContainerType*>(symbol)) {
+        result.container = true;
+        result.allowDuplicates = ct->duplicatesAllowed();
+        for (auto& member : ct->getContents())
+            result.members.push_back(exportSymbol(member.second));
+    }
+    if (dynamic_cast<const Object*>(symbol) != nullptr) {
+        result.kind = symbol->template_args ? ProgramStructure::SymbolKind::TemplateIdentifier
+                                            : ProgramStructure::SymbolKind::Identifier;
+        auto tns = symbol->symNamespace();
+        if (tns != &Namespace::empty)
+            result.typeNamespace = tns->getName();
+    } else {
+        result.kind = symbol->template_args ? ProgramStructure::SymbolKind::TemplateType
+                                            : ProgramStructure::SymbolKind::Type;
+    }
+    return result;
+}
+
+NamedSymbol* importSymbol(const ProgramStructure::Symbol& symbol,
+                          std::vector<std::pair<Object*, cstring>>& objects) {
+    NamedSymbol* result;
+    if (symbol.container) {
+        auto ct = new ContainerType(symbol.name, symbol.srcInfo, symbol.allowDuplicates);
+        for (auto& member : symbol.members) {
+            auto m = importSymbol(member, objects);
+            ct->declare(m);
+            m->setParent(ct);
+        }
+        result = ct;
+    } else if (symbol.kind == ProgramStructure::SymbolKind::Identifier ||
+               symbol.kind == ProgramStructure::SymbolKind::TemplateIdentifier) {
+        auto o = new Object(symbol.name, symbol.srcInfo);
+        if (symbol.typeNamespace)
+            objects.emplace_back(o, symbol.typeNamespace);
+        result = o;
+    } else {
+        result = new SimpleType(symbol.name, symbol.srcInfo);
+    }
+    result->template_args = symbol.kind == ProgramStructure::SymbolKind::TemplateIdentifier ||
+                            symbol.kind == ProgramStructure::SymbolKind::TemplateType;
+    return result;
+}
+
+}  // namespace
+
+std::vector<ProgramStructure::Symbol> ProgramStructure::getTopLevelSymbols() const {
+    std::vector<Symbol> result;
+    for (auto& symbol : rootNamespace->getContents())
+        if (dynamic_cast<const ContainerType*>(symbol.second) != nullptr ||
+            dynamic_cast<const Namespace*>(symbol.second) == nullptr)
+            result.push_back(exportSymbol(symbol.second));
+    return result;
+}
+
+void ProgramStructure::declareTopLevelSymbols(const std::vector<Symbol>& symbols) {
+    // Objects refer to the namespace of their type, which is looked up
+    // by name once all the types have been declared.
+    std::vector<std::pair<Object*, cstring>> objects;
+    for (auto& symbol : symbols) {
+        auto s = importSymbol(symbol, objects);
+        rootNamespace->declare(s);
+        s->setParent(rootNamespace);
+    }
+    for (auto& object : objects)
+        if (auto tns = dynamic_cast<const Namespace*>(rootNamespace->lookup(object.second)))
+            object.first->setNamespace(tns);
+}
+
 void ProgramStructure::endParse() {
     BUG_CHECK(currentNamespace == rootNamespace,
               "Namespace stack is not empty at the end of parsing");
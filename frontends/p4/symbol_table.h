@@ -61,6 +61,18 @@ class ProgramStructure final {
         TemplateType,
     };
 
+    /// A snapshot of a declared symbol, with all the information the lexer
+    /// needs to classify identifiers.  Container types carry their members.
+    struct Symbol {
+        cstring name;
+        SymbolKind kind;
+        Util::SourceInfo srcInfo;
+        bool container = false;
+        bool allowDuplicates = false;   // for containers
+        cstring typeNamespace;          // for objects: the type they were declared with
+        std::vector<Symbol> members;    // for containers
+    };
+
     ProgramStructure();
 
     void setDebug(bool debug) { this->debug = debug; }
@@ -83,6 +95,13 @@ class ProgramStructure final {
 
     void endParse();
 
+    /// All symbols declared at the top level so far.
+    std::vector<Symbol> getTopLevelSymbols() const;
+    /// Declare again at the top level symbols returned by getTopLevelSymbols(),
+    /// possibly of another ProgramStructure; used to resume parsing after a
+    /// prefix of a program that was parsed separately.
+    void declareTopLevelSymbols(const std::vector<Symbol>& symbols);
+
     cstring toString() const;
     void clear();
 };
@@ -0,0 +1,112 @@
+/*
+Copyright 2013-present Barefoot Networks, Inc.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <set>
+#include <vector>
+
+#include "diffDump.h"
+#include "toP4.h"
+
+namespace P4 {
+
+/// Prints the top-level declarations that the DiffDump has not seen yet,
+/// and records the order of all of them.
+class DiffDump::Printer : public ToP4 {
+    DiffDump& diff;
+    std::vector<unsigned>& order;
+
+ public:
+    Printer(DiffDump& diff, Util::SourceCodeBuilder& builder, std::vector<unsigned>& order) :
+            ToP4(builder, false, diff.mainFile), diff(diff), order(order) {
+        setnoIncludesArg(diff.noIncludes);
+        setName("DiffDumpPrinter");
+    }
+
+    using ToP4::preorder;
+    bool preorder(const IR::P4Program* program) override {
+        std::set<cstring> includesEmitted;
+        for (auto a : program->objects) {
+            // Same as ToP4::preorder(const IR::P4Program*)
+            cstring sourceFile = ifSystemFile(a);
+            if (!a->is<IR::Type_Error>() && sourceFile != nullptr) {
+                if (includesEmitted.emplace(sourceFile).second) {
+                    emitInclude(program, sourceFile);
+                    auto text = builder.release();
+                    auto it = diff.includeIds.find(text);
+                    if (it == diff.includeIds.end()) {
+                        it = diff.includeIds.emplace(text, diff.nextId++).first;
+                        diff.writeItem(it->second, "include", text);
+                    }
+                    order.push_back(it->second);
+                }
+                continue;
+            }
+            diff.stats.declarations++;
+            auto it = diff.nodeIds.find(a);
+            if (it == diff.nodeIds.end()) {
+                // Print the declaration as if it followed another one.
+                builder.newline();
+                visit(a);
+                auto text = builder.release();
+                it = diff.nodeIds.emplace(a, diff.nextId++).first;
+                diff.writeItem(it->second, "decl", text.substr(1));
+                diff.stats.printed++;
+            }
+            order.push_back(it->second);
+        }
+        return false;
+    }
+};
+
+DiffDump::DiffDump(std::ostream* out, cstring mainFile, bool noIncludes) :
+        out(out), mainFile(mainFile), noIncludes(noIncludes) {
+    CHECK_NULL(out);
+}
+
+void DiffDump::writeItem(unsigned id, const char* kind, const std::string& text) {
+    *out << "#@item " << id << " " << kind << " " << text.size() << "\n";
+    out->write(text.data(), text.size());
+    *out << "\n";
+}
+
+void DiffDump::dump(cstring pass, const IR::Node* node) {
+    auto printed = stats.printed;
+    *out << "#@pass " << pass << "\n";
+    std::vector<unsigned> order;
+    Util::SourceCodeBuilder builder;
+    if (node->is<IR::P4Program>()) {
+        Printer printer(*this, builder, order);
+        node->apply(printer);
+    } else {
+        auto it = nodeIds.find(node);
+        if (it == nodeIds.end()) {
+            ToP4 toP4(builder, false, mainFile);
+            toP4.setnoIncludesArg(noIncludes);
+            node->apply(toP4);
+            it = nodeIds.emplace(node, nextId++).first;
+            writeItem(it->second, "node", builder.release());
+        }
+        order.push_back(it->second);
+    }
+    *out << "#@order";
+    for (auto id : order)
+        *out << " " << id;
+    *out << std::endl;
+    stats.dumps++;
+    LOG2("Dumped " << pass << ": " << stats.printed - printed << " new declarations");
+}
+
+}  // namespace P4
@@ -0,0 +1,77 @@
+/*
+Copyright 2013-present Barefoot Networks, Inc.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef _P4_TOP4_DIFFDUMP_H_
+#define _P4_TOP4_DIFFDUMP_H_
+
+#include <memory>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+
+#include "ir/ir.h"
+
+namespace P4 {
+
+/**
+Dumps the program after successive passes as one diff stream.  Each dump
+prints only the top-level declarations whose nodes were not in a previous
+dump, followed by the order of all the declarations: IR nodes are never
+modified in place, so a declaration whose node is unchanged also prints
+the same.  tools/p4diff.py rebuilds the text that ToP4 would print after
+any dumped pass.
+
+The stream is a sequence of records:
+
+    #@pass <name>
+    #@item <id> <kind> <length>
+    <length bytes of text>
+    #@order <id>...
+
+The kind of an item is `decl` (a top-level declaration), `include` (the
+#include replacing declarations from a system file) or `node` (a whole
+node which is not a program).
+*/
+class DiffDump {
+    class Printer;
+
+    std::unique_ptr<std::ostream> out;
+    cstring mainFile;
+    bool noIncludes;
+    unsigned nextId = 0;
+    // Holding the nodes also keeps them alive, so their addresses are not
+    // reused by other nodes.
+    std::unordered_map<const IR::Node*, unsigned> nodeIds;
+    std::unordered_map<std::string, unsigned> includeIds;
+
+    void writeItem(unsigned id, const char* kind, const std::string& text);
+
+ public:
+    struct Stats {
+        unsigned dumps = 0;
+        unsigned declarations = 0;  // in all the dumps
+        unsigned printed = 0;  // declarations printed, as they were new
+    } stats;
+
+    /// Writes the stream to @out, which the DiffDump closes.
+    DiffDump(std::ostream* out, cstring mainFile, bool noIncludes = false);
+    /// Dumps @node, the program after the pass @pass.
+    void dump(cstring pass, const IR::Node* node);
+};
+
+}  // namespace P4
+
+#endif /* _P4_TOP4_DIFFDUMP_H_ */
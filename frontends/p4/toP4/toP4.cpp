@@ -33,8 +33,7 @@ Visitor::profile_t ToP4::init_apply(const IR::Node* node) {
 
 void ToP4::end_apply(const IR::Node*) {
     if (outStream != nullptr) {
-        cstring result = builder.toString();
-        *outStream << result.c_str();
+        builder.writeTo(*outStream);
         outStream->flush();
     }
     BUG_CHECK(listTerminators.size() == listTerminators_init_apply_size,
@@ -149,6 +148,27 @@ void ToP4::dump(unsigned depth, const IR::Node* node, unsigned adjDepth) {
         builder.emitIndent();
 }
 
+void ToP4::emitInclude(const IR::P4Program* program, cstring sourceFile) {
+    if (sourceFile.startsWith(p4includePath)) {
+        const char *p = sourceFile.c_str() + strlen(p4includePath);
+        if (*p == '/') p++;
+        if (P4V1::V1Model::instance.file.name == p) {
+            P4V1::getV1ModelVersion g;
+            program->apply(g);
+            builder.append("#define V1MODEL_VERSION ");
+            builder.append(g.version);
+            builder.appendLine("");
+        }
+        builder.append("#include <");
+        builder.append(p);
+        builder.appendLine(">");
+    } else {
+        builder.append("#include \"");
+        builder.append(sourceFile);
+        builder.appendLine("\"");
+    }
+}
+
 bool ToP4::preorder(const IR::P4Program* program) {
     std::set<cstring> includesEmitted;
 
@@ -166,24 +186,7 @@ bool ToP4::preorder(const IR::P4Program* program) {
              * we ignore mainFile and don't emit #includes for any non-system header */
 
             if (includesEmitted.find(sourceFile) == includesEmitted.end()) {
-                if (sourceFile.startsWith(p4includePath)) {
-                    const char *p = sourceFile.c_str() + strlen(p4includePath);
-                    if (*p == '/') p++;
-                    if (P4V1::V1Model::instance.file.name == p) {
-                        P4V1::getV1ModelVersion g;
-                        program->apply(g);
-                        builder.append("#define V1MODEL_VERSION ");
-                        builder.append(g.version);
-                        builder.appendLine("");
-                    }
-                    builder.append("#include <");
-                    builder.append(p);
-                    builder.appendLine(">");
-                } else {
-                    builder.append("#include \"");
-                    builder.append(sourceFile);
-                    builder.appendLine("\"");
-                }
+                emitInclude(program, sourceFile);
                 includesEmitted.emplace(sourceFile);
             }
             first = false;
@@ -1223,7 +1226,7 @@ bool ToP4::preorder(const IR::P4Control * c) {
 bool ToP4::preorder(const IR::ParameterList* p) {
     builder.append("(");
     bool first = true;
-    for (auto param : *p->getEnumerator()) {
+    for (auto param : *p) {
         if (!first)
             builder.append(", ");
         first = false;
@@ -1423,10 +1426,10 @@ bool ToP4::preorder(const IR::Path* p) {
 }
 
 std::string toP4(const IR::INode* node) {
-    std::stringstream stream;
-    P4::ToP4 toP4(&stream, false);
+    Util::SourceCodeBuilder builder;
+    P4::ToP4 toP4(builder, false);
     node->getNode()->apply(toP4);
-    return stream.str();
+    return builder.release();
 }
 
 void dumpP4(const IR::INode* node) {
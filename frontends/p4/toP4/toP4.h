@@ -73,12 +73,17 @@ class ToP4 : public Inspector {
         BUG_CHECK(!listTerminators.empty(), "Empty listTerminators");
         listTerminators.pop_back();
     }
-    bool isSystemFile(cstring file);
-    cstring ifSystemFile(const IR::Node* node);  // return file containing node if system file
     // dump node IR tree up to depth - in the form of a comment
     void dump(unsigned depth, const IR::Node* node = nullptr, unsigned adjDepth = 0);
     unsigned curDepth() const;
 
+ protected:
+    bool isSystemFile(cstring file);
+    cstring ifSystemFile(const IR::Node* node);  // return file containing node if system file
+    /// Emits the #include which replaces the declarations of @program
+    /// that come from the system file @sourceFile.
+    void emitInclude(const IR::P4Program* program, cstring sourceFile);
+
  public:
     // Output is constructed here
     Util::SourceCodeBuilder& builder;
@@ -95,6 +95,53 @@ TypeChecking::TypeChecking(ReferenceMap* refMap, TypeMap* typeMap,
 
 //////////////////////////////////////////////////////////////////////////
 
+namespace {
+/// Type variables are renamed by each type inference, and the types of
+/// tables and of their action lists point to the copies of the program
+/// nodes visited by the type inference that created them, so types that
+/// contain them cannot be compared across two type maps.
+bool hasTypeVariables(const IR::Type* type) {
+    struct FindTypeVariables : public Inspector {
+        bool found = false;
+        bool preorder(const IR::Type_Var*) override { found = true; return false; }
+        bool preorder(const IR::Type_Table*) override { found = true; return false; }
+        bool preorder(const IR::Type_ActionEnum*) override { found = true; return false; }
+    } find;
+    type->apply(find);
+    return find.found;
+}
+}  // namespace
+
+Visitor::profile_t VerifyTypeMap::init_apply(const IR::Node* node) {
+    fullRefMap.clear();
+    fullRefMap.setIsV1(refMap->isV1());
+    fullTypeMap.clear();
+    node->apply(TypeChecking(&fullRefMap, &fullTypeMap));
+    return Inspector::init_apply(node);
+}
+
+bool VerifyTypeMap::preorder(const IR::Node* node) {
+    auto expected = fullTypeMap.getType(node);
+    if (expected == nullptr)
+        return true;
+    auto actual = typeMap->getType(node);
+    BUG_CHECK(actual != nullptr, "%1%: no type in the maintained type map", node);
+    if (!hasTypeVariables(expected) && !hasTypeVariables(actual))
+        BUG_CHECK(typeMap->equivalent(actual, expected, true),
+                  "%1%: type %2% in the maintained type map, type checking gives %3%",
+                  node, actual, expected);
+    if (auto expression = node->to<IR::Expression>()) {
+        BUG_CHECK(typeMap->isLeftValue(expression) == fullTypeMap.isLeftValue(expression),
+                  "%1%: left-value mismatch in the maintained type map", node);
+        BUG_CHECK(typeMap->isCompileTimeConstant(expression) ==
+                  fullTypeMap.isCompileTimeConstant(expression),
+                  "%1%: compile-time constant mismatch in the maintained type map", node);
+    }
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
 bool TypeInference::learn(const IR::Node* node, Visitor* caller) {
     auto *learner = clone();
     learner->setCalledBy(caller);
@@ -256,7 +303,7 @@ const IR::ParameterList* TypeInference::canonicalizeParameters(const IR::Paramet
 
     bool changes = false;
     auto vec = new IR::IndexedVector<IR::Parameter>();
-    for (auto p : *params->getEnumerator()) {
+    for (auto p : *params) {
         auto paramType = getTypeType(p->type);
         if (paramType == nullptr)
             return nullptr;
@@ -616,15 +663,15 @@ const IR::Node* TypeInference::preorder(IR::P4Program* program) {
 
 const IR::Node* TypeInference::postorder(IR::Type_Error* decl) {
     (void)setTypeType(decl);
-    for (auto id : *decl->getDeclarations())
-        setType(id->getNode(), decl);
+    for (auto id : decl->members)
+        setType(id, decl);
     return decl;
 }
 
 const IR::Node* TypeInference::postorder(IR::Declaration_MatchKind* decl) {
     if (done()) return decl;
-    for (auto id : *decl->getDeclarations())
-        setType(id->getNode(), IR::Type_MatchKind::get());
+    for (auto id : decl->members)
+        setType(id, IR::Type_MatchKind::get());
     return decl;
 }
 
@@ -956,7 +1003,7 @@ TypeInference::checkExternConstructor(const IR::Node* errorPosition,
 
     auto args = new IR::Vector<IR::ArgumentInfo>();
     size_t i = 0;
-    for (auto pi : *methodType->parameters->getEnumerator()) {
+    for (auto pi : *methodType->parameters) {
         if (i >= arguments->size()) {
             BUG_CHECK(pi->isOptional() || pi->defaultValue != nullptr,
                       "Missing nonoptional arg %s", pi);
@@ -1381,8 +1428,8 @@ const IR::Node* TypeInference::postorder(IR::Type_ActionEnum* type) {
 
 const IR::Node* TypeInference::postorder(IR::Type_Enum* type) {
     auto canon = setTypeType(type);
-    for (auto e : *type->getDeclarations())
-        setType(e->getNode(), canon);
+    for (auto e : type->members)
+        setType(e, canon);
     return type;
 }
 
@@ -1392,8 +1439,8 @@ const IR::Node* TypeInference::postorder(IR::Type_SerEnum* type) {
         // want to set the type for the SerEnum either.
         return type;
     auto canon = setTypeType(type);
-    for (auto e : *type->getDeclarations())
-        setType(e->getNode(), canon);
+    for (auto e : type->members)
+        setType(e, canon);
     return type;
 }
 
@@ -3991,7 +4038,7 @@ const IR::ActionListElement* TypeInference::validateActionInitializer(
     auto callInstance = MethodInstance::resolve(call, refMap, typeMap, nullptr, true);
     auto listInstance = MethodInstance::resolve(actionListCall, refMap, typeMap, nullptr, true);
 
-    for (auto param : *listInstance->substitution.getParametersInArgumentOrder()) {
+    for (auto param : listInstance->substitution.getParametersInArgumentOrder()) {
         auto aa = listInstance->substitution.lookup(param);
         auto da = callInstance->substitution.lookup(param);
         if (da == nullptr) {
@@ -4007,7 +4054,7 @@ const IR::ActionListElement* TypeInference::validateActionInitializer(
         }
     }
 
-    for (auto param : *callInstance->substitution.getParametersInOrder()) {
+    for (auto param : callInstance->substitution.getParametersInOrder()) {
         auto da = callInstance->substitution.lookup(param);
         if (da == nullptr) {
             typeError("%1%: parameter should be assigned in call %2%",
@@ -60,6 +60,25 @@ class TypeChecking : public PassManager {
                  bool updateExpressions = false);
 };
 
+/// Checks that @typeMap holds the same types as a full type check of the
+/// program would compute.  Passes that keep the type map across program
+/// changes (rather than running ClearTypeMap) rely on TypeChecking to only
+/// infer the types of new nodes; this pass validates that the types of the
+/// other nodes are still right.  A mismatch is a compiler bug.
+class VerifyTypeMap : public Inspector {
+    ReferenceMap* refMap;
+    TypeMap*      typeMap;
+    ReferenceMap  fullRefMap;
+    TypeMap       fullTypeMap;
+
+ public:
+    VerifyTypeMap(ReferenceMap* refMap, TypeMap* typeMap) :
+            refMap(refMap), typeMap(typeMap)
+    { CHECK_NULL(refMap); CHECK_NULL(typeMap); setName("VerifyTypeMap"); }
+    profile_t init_apply(const IR::Node* node) override;
+    bool preorder(const IR::Node* node) override;
+};
+
 template<typename... T>
 void typeError(const char* format, T... args) {
     ::error(ErrorType::ERR_TYPE_ERROR, format, args...);
@@ -41,9 +41,10 @@ cstring TypeVariableSubstitution::compose(const IR::ITypeVar* var, const IR::Typ
     }
 
     // First check whether the substitution is legal.
-    // It is not if var occurs in substitution
+    // It is not if var occurs in substitution, after replacing
+    // the variables that are already bound.
     TypeOccursVisitor occurs(var);
-    substitution->apply(occurs);
+    apply(substitution)->apply(occurs);
     if (occurs.occurs)
         return "'%1%' cannot be replaced with '%2%' which already contains it";
 
@@ -54,41 +55,62 @@ cstring TypeVariableSubstitution::compose(const IR::ITypeVar* var, const IR::Typ
             var->toString(), substitution->toString(), bound->toString());
     }
 
-    // Replace var with substitution everywhere
-    TypeVariableSubstitution *tvs = new TypeVariableSubstitution();
-    bool success = tvs->setBinding(var, substitution);
+    // Replace var with substitution everywhere; the other bindings
+    // are refined when they are looked up.
+    composed.push_back(var);
+    bool success = setBinding(var, substitution);
     if (!success)
-        BUG("Cannot set binding");
-
-    TypeVariableSubstitutionVisitor visitor(tvs);
-    for (auto &bound : binding) {
-        const IR::Type* type = bound.second;
-        const IR::Node* newType = type->apply(visitor);
-        if (newType == nullptr)
-            return "Could not replace '%1%' with '%2%'";
-        if (newType == type)
-            continue;
+        BUG("Failed to insert binding");
+    return "";
+}
+
+bool TypeVariableSubstitution::setBinding(const IR::ITypeVar* id, const IR::Type* type) {
+    if (containsKey(id))
+        return TypeSubstitution::setBinding(id, type);
+    resolved.emplace(id, std::make_pair(type, composed.size()));
+    return TypeSubstitution::setBinding(id, type);
+}
 
-        LOG3("Refining subsitution for " << bound.first->getNode() << " to " << newType);
-        bound.second = newType->to<IR::Type>();
+const IR::Type* TypeVariableSubstitution::resolve(const IR::ITypeVar* var) const {
+    auto it = resolved.find(var);
+    if (it == resolved.end())
+        return nullptr;
+    auto& entry = it->second;
+    while (entry.second < composed.size()) {
+        auto bound = composed[entry.second++];
+        TypeVariableSubstitution tvs;
+        tvs.setBinding(bound, ::get(binding, bound));
+        TypeVariableSubstitutionVisitor visitor(&tvs);
+        auto type = entry.first->apply(visitor)->to<IR::Type>();
+        CHECK_NULL(type);
+        if (type == entry.first)
+            continue;
+        LOG3("Refining substitution for " << var->getNode() << " to " << type);
+        entry.first = type;
     }
+    return entry.first;
+}
 
-    success = setBinding(var, substitution);
-    if (!success)
-        BUG("Failed to insert binding");
-    return "";
+const IR::Type* TypeVariableSubstitution::apply(const IR::Type* type) const {
+    CHECK_NULL(type);
+    if (isIdentity())
+        return type;
+    TypeVariableSubstitutionVisitor visitor(this);
+    auto result = type->apply(visitor);
+    CHECK_NULL(result);
+    return result->to<IR::Type>();
 }
 
 void TypeVariableSubstitution::simpleCompose(const TypeVariableSubstitution* other) {
     CHECK_NULL(other);
     for (auto v : other->binding) {
-        const IR::Type* subst = v.second;
+        const IR::Type* subst = other->lookup(v.first);
         auto it = binding.find(v.first);
         if (it != binding.end())
             BUG("Changing binding for %1% from %2% to %3%",
                 v.first, it->second, subst);
         LOG3("Setting substitution for " << v.first->getNode() << " to " << subst);
-        binding[v.first] = subst;
+        setBinding(v.first, subst);
     }
 }
 
@@ -19,6 +19,9 @@ limitations under the License.
 
 #include <map>
 #include <sstream>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "ir/ir.h"
 #include "lib/exceptions.h"
@@ -37,10 +40,12 @@ class TypeSubstitution : public IHasDbPrint {
 
     /** True if this is the empty substitution, which does not replace anything. */
     bool isIdentity() const { return binding.size() == 0; }
-    const IR::Type* lookup(T t) const
+    /// Subclasses may compute the value bound to t on demand; all accesses
+    /// to bindings through the base class go through lookup.
+    virtual const IR::Type* lookup(T t) const
     { return ::get(binding, t); }
     const IR::Type* get(T t) const
-    { return ::get(binding, t); }
+    { return lookup(t); }
 
     bool containsKey(T key) const { return binding.find(key) != binding.end(); }
 
@@ -65,18 +70,43 @@ class TypeSubstitution : public IHasDbPrint {
         for (auto it : binding) {
             if (!first)
                 out << std::endl;
-            out << it.first << " -> " << dbp(it.second);
+            out << it.first << " -> " << dbp(lookup(it.first));
             first = false;
         }
     }
 
-    void clear() { binding.clear(); }
+    virtual void clear() { binding.clear(); }
 };
 
+/**
+ * Substitution of type variables.  Binding a variable with 'compose'
+ * replaces it in all the bindings created before; this is done lazily:
+ * the variables bound by 'compose' are recorded in order, and a binding
+ * is brought up to date with the ones recorded since it was last looked
+ * up.  Composing a binding is thus independent of the number of bindings
+ * already present, and bindings which are never looked up are never
+ * rewritten.  The values returned by 'lookup' are the same as if every
+ * binding were rewritten when each variable is composed.
+ */
 class TypeVariableSubstitution final : public TypeSubstitution<const IR::ITypeVar*> {
+    /// Variables bound by 'compose', in the order they were bound.
+    std::vector<const IR::ITypeVar*> composed;
+    /// Current value of each bound variable, and the number of variables in
+    /// 'composed' which have been replaced in it.
+    mutable std::unordered_map<const IR::ITypeVar*,
+                               std::pair<const IR::Type*, size_t>> resolved;
+
+    const IR::Type* resolve(const IR::ITypeVar* var) const;
+
  public:
     TypeVariableSubstitution() = default;
     TypeVariableSubstitution(const TypeVariableSubstitution& other) = default;
+    const IR::Type* lookup(const IR::ITypeVar* t) const override
+    { return resolve(t); }
+    bool setBinding(const IR::ITypeVar* id, const IR::Type* type);
+    /// Replace all variables bound by this substitution that occur in 'type'.
+    const IR::Type* apply(const IR::Type* type) const;
+    void clear() override { TypeSubstitution::clear(); composed.clear(); resolved.clear(); }
     bool setBindings(const IR::Node* errorLocation,
                      const IR::TypeParameters* params,
                      const IR::Vector<IR::Type>* args);
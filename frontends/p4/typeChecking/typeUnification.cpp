@@ -169,7 +169,7 @@ bool TypeUnification::unifyFunctions(const BinaryConstraint* constraint,
         constraints->add(constraint->create(dest->returnType, src->returnType));
 
     auto sit = src->parameters->parameters.begin();
-    for (auto dit : *dest->parameters->getEnumerator()) {
+    for (auto dit : *dest->parameters) {
         if (sit == src->parameters->parameters.end()) {
             if (dit->isOptional())
                 continue;
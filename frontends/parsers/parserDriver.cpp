@@ -69,6 +69,17 @@ struct AutoStdioInputStream {
 
 namespace P4 {
 
+namespace {
+
+/// Sizes the text kept by @sources for the input @in, when the stream knows
+/// how much input is left (e.g. Util::BufferInputStream).
+void reserveInput(Util::InputSources* sources, std::istream& in) {
+    auto size = in.rdbuf()->in_avail();
+    if (size > 0) sources->reserve(size);
+}
+
+}  // namespace
+
 AbstractParserDriver::AbstractParserDriver()
     : sources(new Util::InputSources) { }
 
@@ -153,6 +164,7 @@ P4ParserDriver::parse(std::istream& in, const char* sourceFile,
     LOG1("Parsing P4-16 program " << sourceFile);
 
     P4ParserDriver driver;
+    reserveInput(driver.sources, in);
     P4Lexer lexer(in);
     if (!driver.parse(lexer, sourceFile, sourceLine)) return nullptr;
     return new IR::P4Program(driver.nodes->srcInfo, *driver.nodes);
@@ -165,6 +177,45 @@ P4ParserDriver::parse(FILE* in, const char* sourceFile,
     return parse(inputStream.get(), sourceFile, sourceLine);
 }
 
+/* static */ const IR::P4Program*
+P4ParserDriver::parse(std::istream& in, const char* sourceFile,
+                      unsigned sourceLine, const ParserPrelude* prelude) {
+    CHECK_NULL(prelude);
+    LOG1("Parsing P4-16 program " << sourceFile << " after "
+         << prelude->declarations.size() << " precompiled declarations");
+
+    P4ParserDriver driver;
+    if (prelude->sources)
+        driver.sources = new Util::InputSources(*prelude->sources);
+    for (auto node : prelude->declarations) {
+        // The error declarations of the program are merged into the
+        // prelude's, which must not change.
+        if (auto error = node->to<IR::Type_Error>()) {
+            driver.allErrors = error->clone();
+            node = driver.allErrors;
+        }
+        driver.nodes->push_back(node);
+    }
+    driver.structure->declareTopLevelSymbols(prelude->symbols);
+    reserveInput(driver.sources, in);
+    P4Lexer lexer(in);
+    if (!driver.parse(lexer, sourceFile, sourceLine)) return nullptr;
+    return new IR::P4Program(driver.nodes->srcInfo, *driver.nodes);
+}
+
+/* static */ const ParserPrelude*
+P4ParserDriver::parsePrelude(std::istream& in, const char* sourceFile,
+                             unsigned sourceLine /* = 1 */) {
+    LOG1("Parsing P4-16 prelude " << sourceFile);
+
+    P4ParserDriver driver;
+    reserveInput(driver.sources, in);
+    P4Lexer lexer(in);
+    if (!driver.parse(lexer, sourceFile, sourceLine)) return nullptr;
+    return new ParserPrelude{ *driver.nodes, driver.structure->getTopLevelSymbols(),
+                              driver.sources };
+}
+
 template<typename T> const T*
 P4ParserDriver::parse(P4AnnotationLexer::Type type,
                       const Util::SourceInfo& srcInfo,
@@ -332,6 +383,7 @@ V1ParserDriver::parse(std::istream& in, const char* sourceFile,
 
     // Create and configure the parser and lexer.
     V1ParserDriver driver;
+    P4::reserveInput(driver.sources, in);
     V1Lexer lexer(in);
     V1Parser parser(driver, lexer);
 
@@ -95,6 +95,22 @@ class AbstractParserDriver {
     cstring lastIdentifier;
 };
 
+/**
+ * The result of parsing a prefix of a P4-16 program that consists only of
+ * complete top-level declarations (in practice, the standard include files
+ * at the start of a preprocessed program): the declarations, and the symbols
+ * the lexer needs to parse whatever follows them.  A prelude can be shared
+ * by any number of programs that start with the same text.
+ */
+struct ParserPrelude {
+    IR::Vector<IR::Node> declarations;
+    std::vector<Util::ProgramStructure::Symbol> symbols;
+    /// The text of the prelude, if available.  Programs resuming after the
+    /// prelude start with a copy of it, so that source positions in the
+    /// program come after all the positions in the prelude.
+    const Util::InputSources* sources = nullptr;
+};
+
 /// A ParserDriver that can parse P4-16 programs.
 class P4ParserDriver final : public AbstractParserDriver {
  public:
@@ -116,6 +132,21 @@ class P4ParserDriver final : public AbstractParserDriver {
     static const IR::P4Program* parse(FILE* in, const char* sourceFile,
                                       unsigned sourceLine = 1);
 
+    /**
+     * Parse a P4-16 program that starts with the declarations in @prelude;
+     * @in contains the rest of the program.
+     */
+    static const IR::P4Program* parse(std::istream& in, const char* sourceFile,
+                                      unsigned sourceLine, const ParserPrelude* prelude);
+
+    /**
+     * Parse a prefix of a P4-16 program, to be reused by parse() above.
+     *
+     * @returns the prelude if parsing was successful, or null otherwise.
+     */
+    static const ParserPrelude* parsePrelude(std::istream& in, const char* sourceFile,
+                                             unsigned sourceLine = 1);
+
     /**
      * Parses a P4-16 annotation body.
      *
@@ -18,6 +18,8 @@ limitations under the License.
 
 namespace IR {
 
+std::function<const Annotation*(const Annotation*)> Annotation::parseBody;
+
 cstring Annotation::getName() const {
     BUG_CHECK(name == IR::Annotation::nameAnnotation,
               "%1%: Only works on name annotations", this);
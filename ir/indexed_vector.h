@@ -20,6 +20,7 @@ limitations under the License.
 
 #include "dbprint.h"
 #include "lib/enumerator.h"
+#include "lib/iterator_range.h"
 #include "lib/error.h"
 #include "lib/null.h"
 #include "lib/safe_vector.h"
@@ -101,9 +102,11 @@ class IndexedVector : public Vector<T> {
         if (it == declarations.end())
             return nullptr;
         return it->second->template to<U>(); }
+    /// Lazy range of all declarations; does not allocate.
+    auto getDeclarationRange() const {
+        return Util::make_range(Values(declarations).begin(), Values(declarations).end()); }
     Util::Enumerator<const IDeclaration*>* getDeclarations() const {
-        return Util::Enumerator<const IDeclaration*>::createEnumerator(
-            Values(declarations).begin(), Values(declarations).end()); }
+        return Util::enumerate(getDeclarationRange()); }
     iterator erase(iterator i) {
         removeFromMap(*i);
         return Vector<T>::erase(i); }
@@ -215,7 +215,7 @@ void Block::setValue(const Node* node, const CompileTimeValue* value) {
 void InstantiatedBlock::instantiate(std::vector<const CompileTimeValue*> *args) {
     CHECK_NULL(args);
     auto it = args->begin();
-    for (auto p : *getConstructorParameters()->getEnumerator()) {
+    for (auto p : *getConstructorParameters()) {
         if (it == args->end()) {
             BUG_CHECK(p->isOptional(), "Missing nonoptional arg %s", p);
             continue; }
@@ -240,10 +240,20 @@ InstantiatedBlock::findParameterValue(cstring paramName) const {
     return getValue(param->getNode());
 }
 
+/// Lazy range over the top-level objects of @p program that are declarations.
+static auto programDeclarations(const P4Program* program) {
+    return Util::make_range(program->objects)
+            .where([](const Node* node) { return node->is<IDeclaration>(); })
+            .map([](const Node* node) { return node->to<IDeclaration>(); });
+}
+
 Util::Enumerator<const IDeclaration*>* P4Program::getDeclarations() const {
-    return objects.getEnumerator()
-            ->as<const IDeclaration*>()
-            ->where([](const IDeclaration* d) { return d != nullptr; });
+    return Util::enumerate(programDeclarations(this));
+}
+
+Util::Enumerator<const IDeclaration*>* P4Program::getDeclsByName(cstring name) const {
+    return Util::enumerate(programDeclarations(this).where(
+        [name](const IDeclaration* d) { return name == d->getName().name; }));
 }
 
 const IR::PackageBlock* ToplevelBlock::getMain() const {
@@ -34,6 +34,7 @@ limitations under the License.
 #include "lib/safe_vector.h"
 #include "ir.h"
 #include "json_parser.h"
+#include "json_snapshot.h"
 
 class JSONLoader {
     template<typename T> class has_fromJSON {
@@ -50,8 +51,12 @@ class JSONLoader {
     std::unordered_map<int, IR::Node*> &node_refs;
     JsonData *json = nullptr;
 
-    explicit JSONLoader(std::istream &in) : node_refs(*(new std::unordered_map<int, IR::Node*>()))
-    { in >> json; }
+    /// Reads either JSON text or an IR snapshot (see json_snapshot.h) from @p in.
+    explicit JSONLoader(std::istream &in) : node_refs(*(new std::unordered_map<int, IR::Node*>())) {
+        if ((in >> std::ws).peek() == 'P')
+            json = readJsonSnapshot(in);
+        else
+            in >> json; }
 
     explicit JSONLoader(JsonData *json)
     : node_refs(*(new std::unordered_map<int, IR::Node*>())), json(json) {}
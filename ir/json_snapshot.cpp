@@ -0,0 +1,279 @@
+/*
+Copyright 2013-present Barefoot Networks, Inc.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "ir/json_snapshot.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "ir/ir.h"
+#include "ir/json_generator.h"
+#include "lib/error.h"
+
+namespace {
+
+const char snapshotMagic[] = "P4IRSNAP";
+const size_t snapshotMagicSize = sizeof(snapshotMagic) - 1;
+const unsigned char snapshotVersion = 1;
+
+enum SnapshotTag : unsigned char {
+    TagNull,
+    TagFalse,
+    TagTrue,
+    TagInt,         // zigzag-encoded varint
+    TagBigInt,      // index of the decimal representation in the string table
+    TagString,      // index in the string table
+    TagVector,      // #elements:varint value*
+    TagObject,      // #fields:varint (key index:varint value)*
+};
+
+class SnapshotWriter {
+    std::unordered_map<std::string, uint64_t> index;
+    std::vector<const std::string *> strings;
+    std::string body;
+
+    static void varint(std::string &out, uint64_t v) {
+        while (v >= 0x80) {
+            out += static_cast<char>((v & 0x7f) | 0x80);
+            v >>= 7; }
+        out += static_cast<char>(v); }
+
+    void string(const std::string &s) {
+        auto it = index.emplace(s, strings.size()).first;
+        if (it->second == strings.size())
+            strings.push_back(&it->first);
+        varint(body, it->second); }
+
+ public:
+    void value(const JsonData *json) {
+        if (auto obj = json->to<JsonObject>()) {
+            body += static_cast<char>(TagObject);
+            varint(body, obj->size());
+            for (auto &field : *obj) {
+                string(field.first);
+                value(field.second); }
+        } else if (auto vec = json->to<JsonVector>()) {
+            body += static_cast<char>(TagVector);
+            varint(body, vec->size());
+            for (auto elem : *vec)
+                value(elem);
+        } else if (auto str = json->to<JsonString>()) {
+            body += static_cast<char>(TagString);
+            string(*str);
+        } else if (auto num = json->to<JsonNumber>()) {
+            if (num->val >= std::numeric_limits<int64_t>::min() &&
+                num->val <= std::numeric_limits<int64_t>::max()) {
+                auto v = static_cast<int64_t>(num->val);
+                body += static_cast<char>(TagInt);
+                varint(body, (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63));
+            } else {
+                std::stringstream decimal;
+                decimal << num->val;
+                body += static_cast<char>(TagBigInt);
+                string(decimal.str()); }
+        } else if (auto b = json->to<JsonBoolean>()) {
+            body += static_cast<char>(b->val ? TagTrue : TagFalse);
+        } else {
+            body += static_cast<char>(TagNull); } }
+
+    void write(std::ostream &out) const {
+        std::string header(snapshotMagic, snapshotMagicSize);
+        header += static_cast<char>(snapshotVersion);
+        varint(header, strings.size());
+        out.write(header.data(), header.size());
+        for (auto s : strings) {
+            std::string length;
+            varint(length, s->size());
+            out.write(length.data(), length.size());
+            out.write(s->data(), s->size()); }
+        out.write(body.data(), body.size()); }
+};
+
+/// Decodes a snapshot in a single pass.  Any inconsistency (truncated data,
+/// unknown tag, index out of range) makes the whole snapshot invalid.
+class SnapshotReader {
+    const unsigned char *p, *end;
+    bool ok = true;
+    // The string table is only scanned up front; JsonStrings are created
+    // when first referenced by a value and then shared.
+    std::vector<std::pair<const char *, size_t>> table;
+    std::vector<JsonString *> strings;
+    JsonBoolean *trueValue = nullptr, *falseValue = nullptr;
+    JsonNull *nullValue = nullptr;
+
+    bool fail() { ok = false; return false; }
+
+    bool varint(uint64_t &v) {
+        v = 0;
+        for (unsigned shift = 0; shift < 64; shift += 7) {
+            if (p == end) return fail();
+            unsigned char byte = *p++;
+            v |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) return true; }
+        return fail(); }
+
+    bool stringIndex(uint64_t &i) {
+        if (!varint(i)) return false;
+        if (i >= table.size()) return fail();
+        return true; }
+
+    JsonString *string(uint64_t i) {
+        if (!strings[i])
+            strings[i] = new JsonString(std::string(table[i].first, table[i].second));
+        return strings[i]; }
+
+    JsonData *value() {
+        if (!ok || p == end) { fail(); return nullptr; }
+        uint64_t n, i;
+        switch (*p++) {
+        case TagNull:
+            if (!nullValue) nullValue = new JsonNull();
+            return nullValue;
+        case TagFalse:
+            if (!falseValue) falseValue = new JsonBoolean(false);
+            return falseValue;
+        case TagTrue:
+            if (!trueValue) trueValue = new JsonBoolean(true);
+            return trueValue;
+        case TagInt: {
+            if (!varint(n)) return nullptr;
+            int64_t v = static_cast<int64_t>(n >> 1) ^ -static_cast<int64_t>(n & 1);
+            return new JsonNumber(big_int(v)); }
+        case TagBigInt:
+            if (!stringIndex(i)) return nullptr;
+            return new JsonNumber(big_int(std::string(table[i].first, table[i].second)));
+        case TagString:
+            if (!stringIndex(i)) return nullptr;
+            return string(i);
+        case TagVector: {
+            // every element takes at least one byte
+            if (!varint(n) || n > static_cast<uint64_t>(end - p)) { fail(); return nullptr; }
+            auto vec = new JsonVector();
+            vec->reserve(n);
+            while (n-- > 0) {
+                auto elem = value();
+                if (!elem) return nullptr;
+                vec->push_back(elem); }
+            return vec; }
+        case TagObject: {
+            if (!varint(n) || n > static_cast<uint64_t>(end - p)) { fail(); return nullptr; }
+            auto obj = new JsonObject();
+            while (n-- > 0) {
+                if (!stringIndex(i)) return nullptr;
+                auto field = value();
+                if (!field) return nullptr;
+                (*obj)[std::string(table[i].first, table[i].second)] = field; }
+            return obj; }
+        default:
+            fail();
+            return nullptr; } }
+
+ public:
+    SnapshotReader(const char *data, size_t size)
+            : p(reinterpret_cast<const unsigned char *>(data)), end(p + size) {}
+
+    JsonData *read() {
+        if (!isJsonSnapshot(reinterpret_cast<const char *>(p), end - p)) return nullptr;
+        p += snapshotMagicSize + 1;
+        uint64_t n;
+        if (!varint(n) || n > static_cast<uint64_t>(end - p)) return nullptr;
+        table.reserve(n);
+        while (n-- > 0) {
+            uint64_t length;
+            if (!varint(length) || length > static_cast<uint64_t>(end - p)) return nullptr;
+            table.emplace_back(reinterpret_cast<const char *>(p), length);
+            p += length; }
+        strings.resize(table.size());
+        auto result = value();
+        if (!ok || p != end) return nullptr;
+        return result; }
+};
+
+}  // namespace
+
+bool isJsonSnapshot(const char *data, size_t size) {
+    return size > snapshotMagicSize &&
+           memcmp(data, snapshotMagic, snapshotMagicSize) == 0 &&
+           static_cast<unsigned char>(data[snapshotMagicSize]) == snapshotVersion;
+}
+
+void writeJsonSnapshot(std::ostream &out, const JsonData *json) {
+    SnapshotWriter writer;
+    writer.value(json);
+    writer.write(out);
+}
+
+void writeIRSnapshot(std::ostream &out, const IR::Node *node) {
+    // Going through the text form keeps the snapshot in sync with whatever
+    // the generated toJSON methods write; this only costs at dump time.
+    std::stringstream text;
+    JSONGenerator(text, true) << node << std::endl;
+    JsonData *json = nullptr;
+    text >> json;
+    BUG_CHECK(json != nullptr, "Could not convert %1% to JSON", node);
+    writeJsonSnapshot(out, json);
+}
+
+JsonData *readJsonSnapshot(const char *data, size_t size) {
+    return SnapshotReader(data, size).read();
+}
+
+JsonData *readJsonSnapshot(std::istream &in) {
+    std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    return readJsonSnapshot(data.data(), data.size());
+}
+
+JsonData *loadJsonFile(const char *filename) {
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        ::error(ErrorType::ERR_IO, "%s: No such file or directory.", filename);
+        return nullptr; }
+    struct stat st;
+    const char *data = nullptr;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        auto map = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map != MAP_FAILED) data = static_cast<const char *>(map); }
+    close(fd);
+
+    JsonData *json = nullptr;
+    if (data && isJsonSnapshot(data, st.st_size)) {
+        json = readJsonSnapshot(data, st.st_size);
+        munmap(const_cast<char *>(data), st.st_size);
+    } else {
+        if (data) munmap(const_cast<char *>(data), st.st_size);
+        std::ifstream in(filename);
+        // Not mappable (e.g. a pipe) or a text file
+        if (in.peek() == snapshotMagic[0]) {
+            json = readJsonSnapshot(in);
+        } else {
+            in >> json; } }
+    if (json == nullptr)
+        ::error(ErrorType::ERR_IO, "%s: Not valid json input file", filename);
+    return json;
+}
@@ -0,0 +1,67 @@
+/*
+Copyright 2013-present Barefoot Networks, Inc.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef IR_JSON_SNAPSHOT_H_
+#define IR_JSON_SNAPSHOT_H_
+
+/* IR snapshots: a compact binary encoding of the JSON form of the IR.
+   A snapshot holds exactly the JsonData tree the text parser would build
+   from the output of JSONGenerator, so JSONLoader consumes both the same
+   way (node back-references are the usual {"Node_ID": n} objects).  All
+   keys and strings are interned in a table at the start of the file and
+   referred to by index; numbers that fit in 64 bits are varints.  Loading
+   maps the file into memory and decodes it in a single pass, without any
+   character-level parsing; string values are created on first use and
+   shared between all their occurrences.
+
+   Only the parsing of the JSON text is replaced: the whole JsonData tree
+   is decoded up front, and JSONLoader then builds every IR node from it
+   exactly as it does for a text file.  IR nodes are not materialized
+   lazily, and the IR generator emits no snapshot-specific code.
+
+   Layout:  "P4IRSNAP" version:u8 #strings:varint (length:varint bytes)*
+            value
+   value:   tag:u8 followed by a tag-dependent payload, see SnapshotTag. */
+
+#include <cstddef>
+#include <iosfwd>
+
+#include "ir/json_parser.h"
+
+namespace IR {
+class Node;
+}  // namespace IR
+
+/// True if @p data starts with the header of an IR snapshot.
+bool isJsonSnapshot(const char *data, size_t size);
+
+/// Encode @p json as a snapshot.
+void writeJsonSnapshot(std::ostream &out, const JsonData *json);
+/// Encode the JSON form of @p node (as written by JSONGenerator) as a snapshot.
+void writeIRSnapshot(std::ostream &out, const IR::Node *node);
+
+/// Decode a snapshot from memory.  Returns nullptr if the data is not a valid
+/// snapshot.  The result does not refer to @p data.
+JsonData *readJsonSnapshot(const char *data, size_t size);
+/// Decode a snapshot from a stream; used when the input cannot be mapped.
+JsonData *readJsonSnapshot(std::istream &in);
+
+/// Load @p filename, which can be either a snapshot or a JSON text file.
+/// Snapshots are mapped into memory.  Reports an error and returns nullptr
+/// if the file cannot be read or is not valid.
+JsonData *loadJsonFile(const char *filename);
+
+#endif /* IR_JSON_SNAPSHOT_H_ */
@@ -133,13 +133,20 @@ class NameMap : public Node {
     void toJSON(JSONGenerator &json) const override;
     static NameMap<T, MAP, COMP, ALLOC> *fromJSON(JSONLoader &json);
 
+    /// Lazy range of all values; does not allocate.
+    auto valueRange() const {
+        return Util::make_range(Values(symbols).begin(), Values(symbols).end()); }
     Util::Enumerator<const T*>* valueEnumerator() const {
-        return Util::Enumerator<const T*>::createEnumerator(Values(symbols).begin(),
-                                                            Values(symbols).end()); }
+        return Util::enumerate(valueRange()); }
     template <typename S>
     Util::Enumerator<const S*>* only() const {
-        std::function<bool(const T*)> filter = [](const T* d) { return d->template is<S>(); };
-        return valueEnumerator()->where(filter)->template as<const S*>(); }
+        return Util::enumerate(onlyRange<S>()); }
+    /// Lazy range of all values that are of type S, cast to S; does not allocate.
+    template <typename S>
+    auto onlyRange() const {
+        return valueRange()
+                .where([](const T* d) { return d->template is<S>(); })
+                .map([](const T* d) { return d->template to<S>(); }); }
 };
 
 }  // namespace IR
@@ -14,6 +14,9 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 
+#include <sstream>
+#include <unordered_set>
+
 #include "ir.h"
 #include "lib/gc.h"
 #include "lib/n4.h"
@@ -123,12 +126,39 @@ void PassManager::runDebugHooks(const char* visitorName, const IR::Node* program
         h(name(), seqNo, visitorName, program);
 }
 
+// Logs the program before an iteration of a PassRepeated.  After the first
+// iteration only the top-level declarations which changed are dumped.
+static void logRepeatedState(const IR::Node* previous, const IR::Node* program) {
+    auto before = previous ? previous->to<IR::P4Program>() : nullptr;
+    auto after = program ? program->to<IR::P4Program>() : nullptr;
+    if (before == nullptr || after == nullptr) {
+        LOG5("PassRepeated state is:\n" << dumpToString(program));
+        return;
+    }
+    std::unordered_set<const IR::Node*> unchanged(before->objects.begin(),
+                                                  before->objects.end());
+    std::stringstream changed;
+    unsigned count = 0;
+    for (auto a : after->objects) {
+        if (unchanged.count(a) == 0) {
+            changed << dumpToString(a);
+            count++;
+        }
+    }
+    LOG5("PassRepeated state changed in " << count << " of " << after->objects.size() <<
+         " declarations:\n" << changed.str());
+}
+
 const IR::Node *PassRepeated::apply_visitor(const IR::Node *program, const char *name) {
     bool done = false;
     unsigned iterations = 0;
     unsigned initial_error_count = ::errorCount();
+    const IR::Node* logged = nullptr;
     while (!done) {
-        LOG5("PassRepeated state is:\n" << dumpToString(program));
+        if (LOGGING(5)) {
+            logRepeatedState(logged, program);
+            logged = program;
+        }
         running = true;
         auto newprogram = PassManager::apply_visitor(program, name);
         if (program == newprogram || newprogram == nullptr)
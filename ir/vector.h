@@ -19,6 +19,7 @@ limitations under the License.
 
 #include "dbprint.h"
 #include "lib/enumerator.h"
+#include "lib/iterator_range.h"
 #include "lib/null.h"
 #include "lib/safe_vector.h"
 
@@ -189,8 +190,13 @@ class Vector : public VectorBase {
         return Util::Enumerator<const T*>::createEnumerator(vec); }
     template <typename S>
     Util::Enumerator<const S*>* only() const {
-        std::function<bool(const T*)> filter = [](const T* d) { return d->template is<S>(); };
-        return getEnumerator()->where(filter)->template as<const S*>(); }
+        return Util::enumerate(onlyRange<S>()); }
+    /// Lazy range of all elements that are of type S, cast to S; does not allocate.
+    template <typename S>
+    auto onlyRange() const {
+        return Util::make_range(vec)
+                .where([](const T* d) { return d->template is<S>(); })
+                .map([](const T* d) { return d->template to<S>(); }); }
 };
 
 }  // namespace IR
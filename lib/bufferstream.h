@@ -0,0 +1,69 @@
+/*
+Copyright 2013-present Barefoot Networks, Inc.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef _LIB_BUFFERSTREAM_H_
+#define _LIB_BUFFERSTREAM_H_
+
+#include <istream>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace Util {
+
+/// An input stream which reads one or more buffers in memory in place,
+/// one after the other, without copying them as std::istringstream does.
+/// The buffers must outlive the stream.  Before the first read, in_avail()
+/// is the total size, so that readers can size their own buffers.
+class BufferInputStream final : public std::istream {
+    class Buffer final : public std::streambuf {
+        std::vector<std::string_view> segments;
+        size_t next = 0;
+
+     protected:
+        int_type underflow() override {
+            while (gptr() == egptr() && next < segments.size()) {
+                auto segment = segments[next++];
+                auto begin = const_cast<char*>(segment.data());
+                setg(begin, begin, begin + segment.size());
+            }
+            return gptr() == egptr() ? traits_type::eof() : traits_type::to_int_type(*gptr());
+        }
+        std::streamsize showmanyc() override {
+            std::streamsize size = 0;
+            for (auto i = next; i < segments.size(); i++) size += segments[i].size();
+            return size > 0 ? size : -1;
+        }
+
+     public:
+        explicit Buffer(std::vector<std::string_view> segments)
+            : segments(std::move(segments)) {}
+    };
+
+    Buffer buffer;
+
+ public:
+    explicit BufferInputStream(std::string_view text)
+        : BufferInputStream(std::vector<std::string_view>{ text }) {}
+    explicit BufferInputStream(std::vector<std::string_view> segments)
+        : std::istream(nullptr), buffer(std::move(segments)) { rdbuf(&buffer); }
+};
+
+}  // namespace Util
+
+#endif /* _LIB_BUFFERSTREAM_H_ */
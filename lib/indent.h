@@ -36,6 +36,7 @@ class indent_t {
     indent_t operator-(int v) { indent_t rv = *this; rv.indent -= v; return rv; }
     indent_t &operator+=(int v) { indent += v; return *this; }
     indent_t &operator-=(int v) { indent -= v; return *this; }
+    int level() const { return indent; }
     static indent_t &getindent(std::ostream &);
 };
 
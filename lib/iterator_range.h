@@ -0,0 +1,213 @@
+/*
+Copyright 2013-present Barefoot Networks, Inc.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+/* Lazy ranges with the same vocabulary as Util::Enumerator (where, map, as,
+   concat, single, ...), but built entirely from templates: composing them
+   allocates nothing and iteration involves no virtual calls.  Ranges are
+   small values that refer to the underlying container, which must outlive
+   them.  Use Util::enumerate() to turn a range into an Enumerator
+   where a type-erased interface (e.g. INamespace::getDeclarations) is
+   required. */
+
+#ifndef _LIB_ITERATOR_RANGE_H_
+#define _LIB_ITERATOR_RANGE_H_
+
+#include <cstddef>
+#include <iterator>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "lib/enumerator.h"
+
+namespace Util {
+
+template <class Iter> class iterator_range;
+
+namespace Detail {
+/// Lambdas are not copy-assignable in C++17, but the iterators holding them
+/// must be (Enumerator, for one, reassigns its current position).
+template <class F>
+class assignable {
+    std::optional<F> f;
+
+ public:
+    explicit assignable(F f) : f(std::move(f)) {}
+    assignable(const assignable &) = default;
+    assignable &operator=(const assignable &other) {
+        if (this != &other) f.emplace(*other.f);
+        return *this; }
+    template <class... Args>
+    decltype(auto) operator()(Args &&...args) const { return (*f)(std::forward<Args>(args)...); }
+};
+}  // namespace Detail
+
+/// Skips all elements of the underlying iterator that do not satisfy @p Pred.
+template <class Iter, class Pred>
+class filter_iterator {
+    Iter it, end;
+    Detail::assignable<Pred> pred;
+
+    void skip() { while (it != end && !pred(*it)) ++it; }
+
+ public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef typename std::iterator_traits<Iter>::value_type value_type;
+    typedef typename std::iterator_traits<Iter>::difference_type difference_type;
+    typedef const value_type *pointer;
+    typedef decltype(*std::declval<Iter>()) reference;
+
+    filter_iterator(Iter it, Iter end, Pred pred) : it(it), end(end), pred(pred) { skip(); }
+    reference operator*() const { return *it; }
+    filter_iterator &operator++() { ++it; skip(); return *this; }
+    filter_iterator operator++(int) { auto copy = *this; ++*this; return copy; }
+    bool operator==(const filter_iterator &i) const { return it == i.it; }
+    bool operator!=(const filter_iterator &i) const { return it != i.it; }
+};
+
+/// Applies @p Func to each element of the underlying iterator on dereference.
+template <class Iter, class Func>
+class map_iterator {
+    Iter it;
+    Detail::assignable<Func> func;
+
+ public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef std::decay_t<decltype(std::declval<const Func &>()(*std::declval<Iter>()))>
+        value_type;
+    typedef typename std::iterator_traits<Iter>::difference_type difference_type;
+    typedef const value_type *pointer;
+    typedef value_type reference;
+
+    map_iterator(Iter it, Func func) : it(it), func(func) {}
+    value_type operator*() const { return func(*it); }
+    map_iterator &operator++() { ++it; return *this; }
+    map_iterator operator++(int) { auto copy = *this; ++it; return copy; }
+    bool operator==(const map_iterator &i) const { return it == i.it; }
+    bool operator!=(const map_iterator &i) const { return it != i.it; }
+};
+
+/// Iterates over all elements of [first, firstEnd) followed by [second, secondEnd).
+/// Both iterators must produce values convertible to the value type of @p First.
+template <class First, class Second>
+class concat_iterator {
+    First first, firstEnd;
+    Second second;
+
+ public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef typename std::iterator_traits<First>::value_type value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const value_type *pointer;
+    typedef value_type reference;
+
+    concat_iterator(First first, First firstEnd, Second second)
+            : first(first), firstEnd(firstEnd), second(second) {}
+    value_type operator*() const {
+        if (first != firstEnd) return *first;
+        return *second; }
+    concat_iterator &operator++() {
+        if (first != firstEnd) ++first;
+        else
+            ++second;
+        return *this; }
+    concat_iterator operator++(int) { auto copy = *this; ++*this; return copy; }
+    bool operator==(const concat_iterator &i) const {
+        return first == i.first && second == i.second; }
+    bool operator!=(const concat_iterator &i) const { return !(*this == i); }
+};
+
+/// A pair of iterators with LINQ-style lazy adaptors.
+template <class Iter>
+class iterator_range {
+    Iter b, e;
+
+ public:
+    typedef Iter iterator;
+    typedef typename std::iterator_traits<Iter>::value_type value_type;
+
+    iterator_range(Iter b, Iter e) : b(b), e(e) {}
+    template <class Container>
+    explicit iterator_range(const Container &c) : b(std::begin(c)), e(std::end(c)) {}
+
+    Iter begin() const { return b; }
+    Iter end() const { return e; }
+    bool empty() const { return b == e; }
+
+    /// Elements that satisfy @p pred
+    template <class Pred>
+    iterator_range<filter_iterator<Iter, Pred>> where(Pred pred) const {
+        return { filter_iterator<Iter, Pred>(b, e, pred),
+                 filter_iterator<Iter, Pred>(e, e, pred) }; }
+    /// The result of applying @p func to each element
+    template <class Func>
+    iterator_range<map_iterator<Iter, Func>> map(Func func) const {
+        return { map_iterator<Iter, Func>(b, func), map_iterator<Iter, Func>(e, func) }; }
+    /// Each element cast (with dynamic_cast) to S
+    template <class S>
+    auto as() const {
+        return map([](const value_type &v) { return dynamic_cast<S>(v); }); }
+    /// All elements of this followed by all elements of @p other
+    template <class Other>
+    iterator_range<concat_iterator<Iter, typename Other::iterator>>
+    concat(const Other &other) const {
+        typedef concat_iterator<Iter, typename Other::iterator> It;
+        return { It(b, e, other.begin()), It(e, e, other.end()) }; }
+
+    /// Number of elements; linear for filtered ranges
+    size_t count() const {
+        size_t result = 0;
+        for (auto it = b; it != e; ++it)
+            result++;
+        return result; }
+    bool any() const { return !empty(); }
+    /// First element, or the default value if the range is empty
+    value_type nextOrDefault() const {
+        if (empty()) return value_type{};
+        return *b; }
+    /// The only element; throws if the range does not have exactly 1 element
+    value_type single() const {
+        if (empty())
+            throw std::logic_error("There is no element for `single()'");
+        auto it = b;
+        value_type result = *it;
+        if (++it != e)
+            throw std::logic_error("There are multiple elements when calling `single()'");
+        return result; }
+    std::vector<value_type> toVector() const {
+        return std::vector<value_type>(b, e); }
+};
+
+template <class Iter>
+iterator_range<Iter> make_range(Iter begin, Iter end) {
+    return iterator_range<Iter>(begin, end); }
+
+template <class Container>
+auto make_range(const Container &c) -> iterator_range<decltype(std::begin(c))> {
+    return iterator_range<decltype(std::begin(c))>(std::begin(c), std::end(c)); }
+
+/// Wrap a range into a (heap-allocated) Enumerator.  This is a single
+/// allocation, however long the chain of adaptors in the range is.
+template <class Range>
+Enumerator<typename Range::value_type> *enumerate(const Range &range) {
+    return Enumerator<typename Range::value_type>::createEnumerator(range.begin(), range.end());
+}
+
+}  // namespace Util
+
+#endif /* _LIB_ITERATOR_RANGE_H_ */
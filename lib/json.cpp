@@ -22,6 +22,128 @@ limitations under the License.
 
 namespace Util {
 
+JsonWriter::JsonWriter(std::ostream& out)
+        : out(out), level(indent_t::getindent(out).level()) {}
+
+void JsonWriter::flush() {
+    out.write(buffer.data(), buffer.size());
+    buffer.clear();
+}
+
+void JsonWriter::newline() {
+    if (buffer.size() >= flushSize)
+        flush();
+    buffer += '\n';
+    buffer.append(level * indent_t::tabsz, ' ');
+}
+
+void JsonWriter::prefix() {
+    if (afterKey) {
+        afterKey = false;
+        return;
+    }
+    if (scopes.empty())
+        return;
+    auto& scope = scopes.back();
+    if (scope.object)
+        throw std::logic_error("JSON object member written without a key");
+    if (!scope.first) {
+        buffer += ',';
+        if (scope.small)
+            buffer += ' ';
+    }
+    if (!scope.small)
+        newline();
+    scope.first = false;
+}
+
+JsonWriter& JsonWriter::beginObject() {
+    prefix();
+    buffer += '{';
+    level++;
+    scopes.push_back({ true, false, true });
+    return *this;
+}
+
+JsonWriter& JsonWriter::endObject() {
+    if (scopes.empty() || !scopes.back().object || afterKey)
+        throw std::logic_error("Unbalanced JSON object");
+    scopes.pop_back();
+    level--;
+    newline();
+    buffer += '}';
+    return *this;
+}
+
+JsonWriter& JsonWriter::beginArray(bool small) {
+    prefix();
+    buffer += '[';
+    if (!small)
+        level++;
+    scopes.push_back({ false, small, true });
+    return *this;
+}
+
+JsonWriter& JsonWriter::endArray() {
+    if (scopes.empty() || scopes.back().object)
+        throw std::logic_error("Unbalanced JSON array");
+    bool small = scopes.back().small;
+    scopes.pop_back();
+    if (!small) {
+        level--;
+        newline();
+    }
+    buffer += ']';
+    return *this;
+}
+
+JsonWriter& JsonWriter::key(cstring label) {
+    if (scopes.empty() || !scopes.back().object || afterKey)
+        throw std::logic_error("JSON key written outside of an object");
+    auto& scope = scopes.back();
+    if (!scope.first)
+        buffer += ',';
+    scope.first = false;
+    newline();
+    buffer += '"';
+    buffer += label.c_str();
+    buffer += "\" : ";
+    afterKey = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(cstring s) {
+    prefix();
+    buffer += '"';
+    if (s)
+        buffer += s.c_str();
+    buffer += '"';
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(const IJson* json) {
+    if (json == nullptr)
+        return null();
+    json->serialize(*this);
+    return *this;
+}
+
+JsonWriter& JsonWriter::raw(const std::string& text) {
+    prefix();
+    size_t start = 0;
+    for (size_t nl; (nl = text.find('\n', start)) != std::string::npos; start = nl + 1) {
+        buffer.append(text, start, nl - start);
+        newline();
+    }
+    buffer.append(text, start, std::string::npos);
+    return *this;
+}
+
+void IJson::serialize(std::ostream& out) const {
+    JsonWriter writer(out);
+    serialize(writer);
+}
+
 cstring IJson::toString() const {
     std::stringstream str;
     serialize(str);
@@ -64,22 +186,22 @@ JsonValue::JsonValue(long long v)
 JsonValue::JsonValue(unsigned long long v)
     : tag(Kind::Number), value(makeValue(v)) { }
 
-void JsonValue::serialize(std::ostream& out) const {
+void JsonValue::serialize(JsonWriter& writer) const {
     switch (tag) {
         case Kind::String:
-            out << "\"" << str << "\"";
+            writer.value(str);
             break;
         case Kind::Number:
-            out << value;
+            writer.value(value);
             break;
         case Kind::True:
-            out << "true";
+            writer.value(true);
             break;
         case Kind::False:
-            out << "false";
+            writer.value(false);
             break;
         case Kind::Null:
-            out << "null";
+            writer.null();
             break;
     }
 }
@@ -112,33 +234,16 @@ bool JsonValue::operator==(const JsonValue& other) const {
     }
 }
 
-void JsonArray::serialize(std::ostream& out) const {
+void JsonArray::serialize(JsonWriter& writer) const {
     bool isSmall = true;
     for (auto v : *this) {
         if (!v->is<JsonValue>())
             isSmall = false;
     }
-    out << "[";
-    if (!isSmall)
-        out << IndentCtl::indent;
-    bool first = true;
-    for (auto v : *this) {
-        if (!first) {
-            out << ",";
-            if (isSmall)
-                out << " ";
-        }
-        if (!isSmall)
-            out << IndentCtl::endl;
-        if (v == nullptr)
-            out << "null";
-        else
-            v->serialize(out);
-        first = false;
-    }
-    if (!isSmall)
-        out << IndentCtl::unindent << IndentCtl::endl;
-    out << "]";
+    writer.beginArray(isSmall);
+    for (auto v : *this)
+        writer.value(v);
+    writer.endArray();
 }
 
 bool JsonValue::getBool() const {
@@ -171,21 +276,11 @@ JsonArray* JsonArray::append(IJson* value) {
     return this;
 }
 
-void JsonObject::serialize(std::ostream& out) const {
-    out << "{" << IndentCtl::indent;
-    bool first = true;
-    for (auto &it : *this) {
-        if (!first)
-            out << ",";
-        first = false;
-        out << IndentCtl::endl;
-        out << "\"" << it.first << "\"" << " : ";
-        if (it.second == nullptr)
-            out << "null";
-        else
-            it.second->serialize(out);
-    }
-    out << IndentCtl::unindent << IndentCtl::endl << "}";
+void JsonObject::serialize(JsonWriter& writer) const {
+    writer.beginObject();
+    for (auto &it : *this)
+        writer.key(it.first).value(it.second);
+    writer.endObject();
 }
 
 JsonObject* JsonObject::emplace(cstring label, IJson* value) {
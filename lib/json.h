@@ -19,6 +19,7 @@ limitations under the License.
 
 #include <iostream>
 #include <stdexcept>
+#include <string>
 #include <vector>
 #include <type_traits>
 
@@ -32,10 +33,68 @@ namespace Test { class TestJson; }
 
 namespace Util {
 
+class IJson;
+
+/// Streaming (SAX-style) JSON emitter.  Produces exactly the layout of
+/// IJson::serialize, but needs no JSON objects for the values it writes, and
+/// buffers its output instead of flushing the stream after every line.
+/// Starts at the indentation level of the stream it writes to.
+class JsonWriter {
+    struct Scope {
+        bool object;
+        bool small;  // array printed on a single line
+        bool first;  // nothing written in this scope yet
+    };
+
+    std::ostream& out;
+    std::string buffer;
+    int level;
+    std::vector<Scope> scopes;
+    bool afterKey = false;
+
+    /// Buffered output is flushed to the stream in chunks of this size.
+    static constexpr size_t flushSize = 1 << 16;
+
+    void newline();
+    void prefix();
+    void scalar(const std::string& text) { prefix(); buffer += text; }
+
+ public:
+    explicit JsonWriter(std::ostream& out);
+    ~JsonWriter() { flush(); }
+    JsonWriter(const JsonWriter&) = delete;
+    void flush();
+
+    JsonWriter& beginObject();
+    JsonWriter& endObject();
+    /// A small array is printed on a single line; IJson uses this for arrays
+    /// that contain only scalars.
+    JsonWriter& beginArray(bool small = false);
+    JsonWriter& endArray();
+    /// Label of the next object member.
+    JsonWriter& key(cstring label);
+
+    JsonWriter& null() { scalar("null"); return *this; }
+    JsonWriter& value(bool b) { scalar(b ? "true" : "false"); return *this; }
+    JsonWriter& value(const big_int& v) { scalar(v.str()); return *this; }
+    template<typename T, typename std::enable_if<std::is_integral<T>::value, int>::type = 0>
+    JsonWriter& value(T v) { scalar(std::to_string(v)); return *this; }
+    JsonWriter& value(double v) { return value(big_int(v)); }
+    JsonWriter& value(float v) { return value(big_int(v)); }
+    JsonWriter& value(cstring s);
+    JsonWriter& value(const std::string& s) { return value(cstring(s)); }
+    JsonWriter& value(const char* s) { return value(cstring(s)); }
+    /// Write a JSON tree; null is written as `null`.
+    JsonWriter& value(const IJson* json);
+    /// Write text produced by another JsonWriter at indentation level 0.
+    JsonWriter& raw(const std::string& text);
+};
+
 class IJson : public ICastable {
  public:
     virtual ~IJson() {}
-    virtual void serialize(std::ostream& out) const = 0;
+    virtual void serialize(JsonWriter& writer) const = 0;
+    void serialize(std::ostream& out) const;
     cstring toString() const;
     void dump() const;
 };
@@ -65,7 +124,8 @@ class JsonValue final : public IJson {
     JsonValue(cstring s) : tag(Kind::String), str(s) {}               // NOLINT
     JsonValue(const std::string &s) : tag(Kind::String), str(s) {}    // NOLINT
     JsonValue(const char* s) : tag(Kind::String), str(s) {}           // NOLINT
-    void serialize(std::ostream& out) const;
+    using IJson::serialize;
+    void serialize(JsonWriter& writer) const override;
 
     bool operator==(const big_int& v) const;
     // is_integral is true for bool
@@ -108,7 +168,8 @@ class JsonValue final : public IJson {
 class JsonArray final : public IJson, public std::vector<IJson*> {
     friend class Test::TestJson;
  public:
-    void serialize(std::ostream& out) const;
+    using IJson::serialize;
+    void serialize(JsonWriter& writer) const override;
     JsonArray* clone() const { return new JsonArray(*this); }
     JsonArray* append(IJson* value);
     JsonArray* append(big_int v) { append(new JsonValue(v)); return this; }
@@ -133,7 +194,8 @@ class JsonObject final : public IJson, public ordered_map<cstring, IJson*> {
 
  public:
     JsonObject() = default;
-    void serialize(std::ostream& out) const;
+    using IJson::serialize;
+    void serialize(JsonWriter& writer) const override;
     JsonObject* emplace(cstring label, IJson* value);
     JsonObject* emplace_non_null(cstring label, IJson* value);
     JsonObject* emplace(cstring label, big_int v)
@@ -152,6 +214,21 @@ class JsonObject final : public IJson, public ordered_map<cstring, IJson*> {
     IJson* get(cstring label) const { return ::get(*this, label); }
 };
 
+/// A JSON value that has already been rendered to text.  Large documents
+/// can keep their finished parts in this form instead of as a tree of
+/// JsonObjects; the text is re-indented when the document is written.
+class JsonText final : public IJson {
+    std::string text;
+
+ public:
+    /// @p text must have been produced at indentation level 0, e.g. by a
+    /// JsonWriter on a fresh stream.
+    explicit JsonText(std::string text) : text(std::move(text)) {}
+    explicit JsonText(const IJson* value) : text(value->toString()) {}
+    using IJson::serialize;
+    void serialize(JsonWriter& writer) const override { writer.raw(text); }
+};
+
 }  // namespace Util
 
 #endif  /* _LIB_JSON_H_ */
@@ -0,0 +1,132 @@
+/*
+Copyright 2013-present Barefoot Networks, Inc.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "sourceCodeBuilder.h"
+#include "lib/error.h"
+
+namespace Util {
+
+void SourceCodeBuilder::appendFormat(const char* format, ...) {
+    if (format == nullptr)
+        BUG("Null format string");
+    va_list ap;
+    va_start(ap, format);
+    va_list ap_copy;
+    va_copy(ap_copy, ap);
+    // Most formatted strings are short: format into the last chunk, and
+    // only format again if the text does not fit.
+    const size_t room = 128;
+    auto* chunk = &tail(room);
+    size_t used = chunk->size();
+    chunk->resize(used + room);
+    int size = vsnprintf(&(*chunk)[used], room + 1, format, ap);
+    va_end(ap);
+    if (size < 0) {
+        va_end(ap_copy);
+        chunk->resize(used);
+        BUG("Error in vsnprintf");
+    }
+    if (static_cast<size_t>(size) > room) {
+        chunk->resize(used);
+        chunk = &tail(size);
+        used = chunk->size();
+        chunk->resize(used + size);
+        vsnprintf(&(*chunk)[used], size + 1, format, ap_copy);
+    }
+    va_end(ap_copy);
+    chunk->resize(used + size);
+    if (size > 0)
+        endsInSpace = ::isspace(chunk->back());
+}
+
+size_t SourceCodeBuilder::size() const {
+    size_t size = 0;
+    for (auto& chunk : chunks)
+        size += chunk.size();
+    return size;
+}
+
+std::string SourceCodeBuilder::toString() const {
+    if (chunks.size() == 1)
+        return chunks.front();
+    std::string result;
+    result.reserve(size());
+    for (auto& chunk : chunks)
+        result += chunk;
+    return result;
+}
+
+std::string SourceCodeBuilder::release() {
+    std::string result = chunks.size() == 1 ? std::move(chunks.front()) : toString();
+    chunks.clear();
+    chunks.emplace_back();
+    endsInSpace = false;
+    return result;
+}
+
+void SourceCodeBuilder::writeTo(std::ostream& out) const {
+    for (auto& chunk : chunks)
+        out.write(chunk.data(), chunk.size());
+}
+
+bool SourceCodeBuilder::writeToFile(cstring fileName) const {
+    int fd = ::open(fileName, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+    if (fd < 0) {
+        ::error(ErrorType::ERR_IO, "Error writing output to file %1%: %2%",
+                fileName, strerror(errno));
+        return false;
+    }
+    std::vector<struct iovec> iov;
+    for (auto& chunk : chunks) {
+        if (!chunk.empty())
+            iov.push_back({ const_cast<char*>(chunk.data()), chunk.size() });
+    }
+    size_t next = 0;
+    bool ok = true;
+    while (next < iov.size()) {
+        int count = std::min(iov.size() - next, size_t(IOV_MAX));
+        ssize_t written = ::writev(fd, &iov[next], count);
+        if (written < 0) {
+            if (errno == EINTR)
+                continue;
+            ok = false;
+            break;
+        }
+        // skip what was written; a short write leaves part of a chunk
+        while (next < iov.size() && static_cast<size_t>(written) >= iov[next].iov_len)
+            written -= iov[next++].iov_len;
+        if (written > 0) {
+            iov[next].iov_base = static_cast<char*>(iov[next].iov_base) + written;
+            iov[next].iov_len -= written;
+        }
+    }
+    if (::close(fd) != 0)
+        ok = false;
+    if (!ok)
+        ::error(ErrorType::ERR_IO, "Error writing output to file %1%: %2%",
+                fileName, strerror(errno));
+    return ok;
+}
+
+}  // namespace Util
@@ -18,7 +18,11 @@ limitations under the License.
 #define _LIB_SOURCECODEBUILDER_H_
 
 #include <ctype.h>
-#include <sstream>
+#include <string.h>
+#include <algorithm>
+#include <ostream>
+#include <string>
+#include <vector>
 
 #include "lib/stringify.h"
 #include "lib/cstring.h"
@@ -29,14 +33,35 @@ class SourceCodeBuilder {
     int indentLevel;  // current indent level
     unsigned indentAmount;
 
-    std::stringstream buffer;
-    const std::string nl = "\n";
+    // The text is kept as a list of chunks.  The first chunk grows as a
+    // string; once it is chunkSize bytes long, text goes to new chunks of
+    // that size, so large outputs are never copied to grow the buffer.
+    static constexpr size_t chunkSize = 1 << 16;
+    std::vector<std::string> chunks;
     bool endsInSpace;
 
+    /// @return the chunk to which @size more bytes should be appended.
+    std::string& tail(size_t size) {
+        auto* last = &chunks.back();
+        if (last->size() >= chunkSize && last->size() + size > last->capacity()) {
+            chunks.emplace_back();
+            last = &chunks.back();
+            last->reserve(std::max(chunkSize, size));
+        }
+        return *last;
+    }
+    void write(const char* data, size_t size) {
+        if (size == 0)
+            return;
+        endsInSpace = ::isspace(data[size - 1]);
+        tail(size).append(data, size);
+    }
+
  public:
     SourceCodeBuilder() :
             indentLevel(0),
             indentAmount(4),
+            chunks(1),
             endsInSpace(false)
     {}
 
@@ -46,68 +71,65 @@ class SourceCodeBuilder {
         if (indentLevel < 0)
             BUG("Negative indent");
     }
-    void newline() { buffer << nl; endsInSpace = true; }
+    void newline() { tail(1) += '\n'; endsInSpace = true; }
     void spc() {
         if (!endsInSpace)
-            buffer << " ";
+            tail(1) += ' ';
         endsInSpace = true;
     }
 
-    void append(cstring str) { append(str.c_str()); }
+    void append(cstring str) { write(str.c_str(), str.size()); }
     void appendLine(cstring str) { append(str); newline(); }
-    void append(const std::string &str) {
-        if (str.size() == 0)
-            return;
-        endsInSpace = ::isspace(str.at(str.size() - 1));
-        buffer << str;
-    }
+    void append(const std::string &str) { write(str.data(), str.size()); }
     void append(char c) {
         endsInSpace = ::isspace(c);
-        buffer << c;
+        tail(1) += c;
     }
     void append(const char* str) {
         if (str == nullptr)
             BUG("Null argument to append");
-        if (strlen(str) == 0)
-            return;
-        endsInSpace = ::isspace(str[strlen(str) - 1]);
-        buffer << str;
-    }
-    void appendFormat(const char* format, ...) {
-        va_list ap;
-        va_start(ap, format);
-        cstring str = Util::vprintf_format(format, ap);
-        va_end(ap);
-        append(str);
+        write(str, strlen(str));
     }
-    void append(unsigned u) { appendFormat("%d", u); }
-    void append(int u) { appendFormat("%d", u); }
+    /// Formats directly into the buffer.
+    void appendFormat(const char* format, ...);
+    void append(unsigned u) { append(static_cast<int>(u)); }
+    void append(int u) { append(std::to_string(u)); }
 
     void endOfStatement(bool addNl = false) {
-        append(";");
+        append(';');
         if (addNl) newline(); }
 
     void blockStart() {
-        append("{");
+        append('{');
         newline();
         increaseIndent();
     }
 
     void emitIndent() {
-        buffer << std::string(indentLevel, ' ');
-        if (indentLevel > 0)
+        if (indentLevel > 0) {
+            tail(indentLevel).append(indentLevel, ' ');
             endsInSpace = true;
+        }
     }
 
     void blockEnd(bool nl) {
         decreaseIndent();
         emitIndent();
-        append("}");
+        append('}');
         if (nl)
             newline();
     }
 
-    std::string toString() const { return buffer.str(); }
+    /// @return the length of the text.
+    size_t size() const;
+    std::string toString() const;
+    /// Moves the text out of the builder, which is left empty.
+    std::string release();
+    /// Writes the text to @out, one chunk at a time.
+    void writeTo(std::ostream& out) const;
+    /// Writes the text to the file @fileName with writev; reports an error
+    /// and @return false if the file cannot be written.
+    bool writeToFile(cstring fileName) const;
     void commentStart() { append("/* "); }
     void commentEnd() { append(" */"); }
     bool lastIsSpace() const { return endsInSpace; }
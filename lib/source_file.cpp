@@ -14,6 +14,8 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 
+#include <string.h>
+
 #include <sstream>
 
 #include <algorithm>
@@ -58,7 +60,7 @@ cstring SourceInfo::toDebugString() const {
 
 InputSources::InputSources() : sealed(false) {
     mapLine(nullptr, 1);  // the first line read will be line 1 of stdin
-    contents.push_back("");
+    lineStarts.push_back(0);
 }
 
 void InputSources::addComment(SourceInfo srcInfo, bool singleLine, cstring body) {
@@ -78,8 +80,8 @@ void InputSources::seal() {
 }
 
 unsigned InputSources::lineCount() const {
-    int size = contents.size();
-    if (contents.back().empty()) {
+    int size = lineStarts.size();
+    if (lineStarts.back() == contents.size()) {
         // do not count the last line if it is empty.
         size -= 1;
         if (size < 0)
@@ -93,20 +95,21 @@ void InputSources::appendToLastLine(StringRef text) {
     if (sealed)
         BUG("Appending to sealed InputSources");
     // Text should not contain any newline characters
-    for (size_t i = 0; i < text.len; i++) {
-        char c = text[i];
-        if (c == '\n')
-            BUG("Text contains newlines");
-    }
-    contents.back() += text.toString();
+    if (memchr(text.p, '\n', text.len) != nullptr)
+        BUG("Text contains newlines");
+    contents.append(text.p, text.len);
 }
 
 // Append a newline and start a new line
 void InputSources::appendNewline(StringRef newline) {
     if (sealed)
         BUG("Appending to sealed InputSources");
-    contents.back() += newline.toString();
-    contents.push_back("");  // start a new line
+    contents.append(newline.p, newline.len);
+    lineStarts.push_back(contents.size());  // start a new line
+}
+
+void InputSources::reserve(size_t size) {
+    contents.reserve(contents.size() + size);
 }
 
 void InputSources::appendText(const char* text) {
@@ -149,7 +152,9 @@ cstring InputSources::getLine(unsigned lineNumber) const {
         // don't throw: this code may be called by exceptions
         // reporting on elements that have no source position
     }
-    return contents.at(lineNumber - 1);
+    auto start = lineStarts.at(lineNumber - 1);
+    auto end = lineNumber < lineStarts.size() ? lineStarts[lineNumber] : contents.size();
+    return cstring(contents.data() + start, end - start);
 }
 
 void InputSources::mapLine(cstring file, unsigned originalSourceLineNo) {
@@ -181,12 +186,12 @@ SourceFileLine InputSources::getSourceLine(unsigned line) const {
 }
 
 unsigned InputSources::getCurrentLineNumber() const {
-    return contents.size();
+    return lineStarts.size();
 }
 
 SourcePosition InputSources::getCurrentPosition() const {
     unsigned line = getCurrentLineNumber();
-    unsigned column = contents.back().size();
+    unsigned column = contents.size() - lineStarts.back();
     return SourcePosition(line, column);
 }
 
@@ -267,8 +272,7 @@ cstring InputSources::getBriefSourceFragment(const SourceInfo &position) const {
 
 cstring InputSources::toDebugString() const {
     std::stringstream builder;
-    for (auto line : contents)
-        builder << line;
+    builder << contents;
     builder << "---------------" << std::endl;
     for (auto lf : line_file_map)
         builder << lf.first << ": " << lf.second.toString() << std::endl;
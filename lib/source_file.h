@@ -21,6 +21,7 @@ limitations under the License.
 #ifndef _LIB_SOURCE_FILE_H_
 #define _LIB_SOURCE_FILE_H_
 
+#include <string>
 #include <vector>
 
 #include "gtest/gtest_prod.h"
@@ -289,6 +290,9 @@ class Comment final : IHasDbPrint {
   The mutable part of the API is tailored for interaction with the lexer.
   After the lexer is done this object can be "sealed" and never changes again.
 
+  The text is kept in a single buffer, and lines are offsets into it, so that
+  large programs do not cost one allocation per line.
+
   This class implements a singleton pattern: there is a single instance of this class.
 */
 class InputSources final {
@@ -310,6 +314,9 @@ class InputSources final {
 
     /// Append this text; it is either a newline or a text with no newlines.
     void appendText(const char* text);
+    /// Make room for @size more bytes of text, when the size of the input
+    /// is known in advance.
+    void reserve(size_t size);
 
     /**
         Map the next line in the file to the line with number 'originalSourceLine'
@@ -339,8 +346,10 @@ class InputSources final {
 
     std::map<unsigned, SourceFileLine> line_file_map;
 
-    /// Each line also stores the end-of-line character(s)
-    std::vector<std::string> contents;
+    /// All the text read, including the end-of-line character(s)
+    std::string contents;
+    /// Offset in contents of the start of each line
+    std::vector<size_t> lineStarts;
     /// The commends found in the file.
     std::vector<Comment*> comments;
 };
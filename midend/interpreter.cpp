@@ -187,6 +187,13 @@ bool SymbolicInteger::equals(const SymbolicValue* other) const {
     return true;
 }
 
+size_t SymbolicInteger::hash() const {
+    size_t result = static_cast<size_t>(state);
+    if (isKnown() && constant->fitsLong())
+        result = result * 31 + std::hash<long>()(constant->asLong());
+    return result;
+}
+
 bool SymbolicVarbit::merge(const SymbolicValue* other) {
     BUG_CHECK(other->is<SymbolicVarbit>(), "%1%: expected a varbit", other);
     auto vo = other->to<SymbolicVarbit>();
@@ -236,21 +243,42 @@ bool SymbolicEnum::equals(const SymbolicValue* other) const {
     return true;
 }
 
+size_t SymbolicEnum::hash() const {
+    size_t result = static_cast<size_t>(state);
+    if (isKnown())
+        result = result * 31 + std::hash<cstring>()(value.name);
+    return result;
+}
+
 //////////////////////////////////////////////////////////////////////////////////
 
 SymbolicStruct::SymbolicStruct(const IR::Type_StructLike* type, bool uninitialized,
                                const SymbolicValueFactory* factory) : SymbolicValue(type) {
     CHECK_NULL(type); CHECK_NULL(factory);
+    fieldValue.reserve(type->fields.size());
     for (auto f : type->fields) {
         auto value = factory->create(f->type, uninitialized);
-        fieldValue[f->name.name] = value;
+        fieldValue.push_back(value);
     }
 }
 
+void SymbolicStruct::shareFields(const SymbolicStruct* other) {
+    fieldValue = other->fieldValue;
+    for (auto v : fieldValue)
+        if (v != nullptr)
+            v->share();
+}
+
+size_t SymbolicStruct::matchingField(const SymbolicStruct* other, size_t otherIndex) const {
+    // Values of the same type have the same layout.
+    if (other->type == type)
+        return otherIndex;
+    return fieldIndex(other->fieldName(otherIndex));
+}
+
 SymbolicValue* SymbolicStruct::clone() const {
-    auto result = new SymbolicStruct(type->to<IR::Type_StructLike>());
-    for (auto f : fieldValue)
-        result->fieldValue[f.first] = f.second->clone();
+    auto result = new SymbolicStruct(structType());
+    result->shareFields(this);
     return result;
 }
 
@@ -258,37 +286,49 @@ void SymbolicStruct::assign(const SymbolicValue* other) {
     if (other->is<SymbolicError>()) return;
     BUG_CHECK(other->is<SymbolicStruct>(), "%1%: expected a struct", other);
     auto sv = other->to<SymbolicStruct>();
-    for (auto f : sv->fieldValue)
-        fieldValue[f.first]->assign(f.second);
+    for (size_t i = 0; i < sv->fieldValue.size(); i++)
+        writable(fieldValue.at(matchingField(sv, i)))->assign(sv->fieldValue[i]);
 }
 
 bool SymbolicStruct::merge(const SymbolicValue* other) {
     BUG_CHECK(other->is<SymbolicStruct>(), "%1%: expected a struct", other);
     auto sv = other->to<SymbolicStruct>();
     bool changes = false;
-    for (auto f : sv->fieldValue)
-        changes = changes || fieldValue[f.first]->merge(f.second);
+    for (size_t i = 0; i < sv->fieldValue.size(); i++)
+        changes = changes ||
+                writable(fieldValue.at(matchingField(sv, i)))->merge(sv->fieldValue[i]);
     return changes;
 }
 
 void SymbolicStruct::setAllUnknown() {
-    for (auto f : type->to<IR::Type_StructLike>()->fields)
-        fieldValue[f->name.name]->setAllUnknown();
+    for (auto& f : fieldValue)
+        writable(f)->setAllUnknown();
 }
 
 bool SymbolicStruct::equals(const SymbolicValue* other) const {
     if (!other->is<SymbolicStruct>())
         return false;
     auto sv = other->to<SymbolicStruct>();
-    for (auto f : sv->fieldValue)
-        if (!get(nullptr, f.first)->equals(f.second))
+    for (size_t i = 0; i < sv->fieldValue.size(); i++) {
+        auto mine = fieldValue.at(matchingField(sv, i));
+        if (mine != sv->fieldValue[i] && !mine->equals(sv->fieldValue[i]))
             return false;
+    }
     return true;
 }
 
+size_t SymbolicStruct::hash() const {
+    // Fields are compared by name, so their order does not change the hash.
+    size_t result = 0;
+    for (auto f : fieldValue)
+        if (f != nullptr)
+            result += f->hash();
+    return result;
+}
+
 bool SymbolicStruct::hasUninitializedParts() const {
     for (auto f : fieldValue)
-        if (f.second->hasUninitializedParts())
+        if (f->hasUninitializedParts())
             return true;
     return false;
 }
@@ -296,13 +336,14 @@ bool SymbolicStruct::hasUninitializedParts() const {
 void SymbolicStruct::dbprint(std::ostream& out) const {
     bool first = true;
     out << "{ ";
-    for (auto f : fieldValue) {
-        if (f.second->is<SymbolicHeader>() ||
-            f.second->is<SymbolicStruct>() ||
-            f.second->is<SymbolicArray>()) {
+    for (size_t i = 0; i < fieldValue.size(); i++) {
+        auto f = fieldValue[i];
+        if (f->is<SymbolicHeader>() ||
+            f->is<SymbolicStruct>() ||
+            f->is<SymbolicArray>()) {
             if (!first)
                 out << ", ";
-            out << f.first << "=>" << f.second;
+            out << fieldName(i) << "=>" << f;
             first = false;
         }
     }
@@ -316,16 +357,14 @@ SymbolicHeaderUnion::SymbolicHeaderUnion(const IR::Type_HeaderUnion* type,
 
 SymbolicBool* SymbolicHeaderUnion::isValid() const {
     int validFields = 0;
-    for (auto f : type->to<IR::Type_StructLike>()->fields) {
-         if (fieldValue.count(f->name.name)) {
-             auto fieldValid = fieldValue.at(f->name.name)->checkedTo<SymbolicHeader>()->valid;
-             if (!fieldValid->isKnown() || fieldValid->isUninitialized()) {
-                 return fieldValid;
-             } else if (fieldValid->value) {
-                 validFields +=1;
-             }
-         } else {
-             BUG("The number of fields in %1% is different from HeaderUnion fieldValue", type);
+    BUG_CHECK(fieldValue.size() == structType()->fields.size(),
+              "The number of fields in %1% is different from HeaderUnion fieldValue", type);
+    for (auto f : fieldValue) {
+         auto fieldValid = f->checkedTo<SymbolicHeader>()->valid;
+         if (!fieldValid->isKnown() || fieldValid->isUninitialized()) {
+             return fieldValid;
+         } else if (fieldValid->value) {
+             validFields +=1;
          }
     }
     if (validFields == 1) {
@@ -347,8 +386,7 @@ void SymbolicHeaderUnion::setAllUnknown() {
 
 SymbolicValue* SymbolicHeaderUnion::clone() const {
     auto result = new SymbolicHeaderUnion(type->to<IR::Type_HeaderUnion>());
-    for (auto f : fieldValue)
-        result->fieldValue[f.first] = f.second->clone();
+    result->shareFields(this);
     return result;
 }
 
@@ -356,17 +394,13 @@ void SymbolicHeaderUnion::assign(const SymbolicValue* other) {
     if (other->is<SymbolicError>()) return;
     auto hv = other->to<SymbolicHeaderUnion>();
     BUG_CHECK(hv, "%1%: expected a header union", other);
-    for (auto f : hv->fieldValue)
-        fieldValue[f.first]->assign(f.second);
+    SymbolicStruct::assign(hv);
 }
 
 bool SymbolicHeaderUnion::merge(const SymbolicValue* other) {
     auto hv = other->to<SymbolicHeaderUnion>();
     BUG_CHECK(hv, "%1%: expected a header union", other);
-    bool changes = false;
-    for (auto f : hv->fieldValue)
-        changes = changes || fieldValue[f.first]->merge(f.second);
-    return changes;
+    return SymbolicStruct::merge(hv);
 }
 
 bool SymbolicHeaderUnion::equals(const SymbolicValue* other) const {
@@ -378,9 +412,9 @@ bool SymbolicHeaderUnion::equals(const SymbolicValue* other) const {
 void SymbolicHeaderUnion::dbprint(std::ostream& out) const {
     out << "{ ";
 #if 0
-    for (auto f : fieldValue) {
+    for (size_t i = 0; i < fieldValue.size(); i++) {
         out << ", ";
-        out << f.first << "=>" << f.second;
+        out << fieldName(i) << "=>" << fieldValue[i];
     }
 #endif
     out << " }";
@@ -406,37 +440,33 @@ SymbolicValue* SymbolicHeader::get(const IR::Node* node, cstring field) const {
 
 void SymbolicHeader::setAllUnknown() {
     SymbolicStruct::setAllUnknown();
-    valid->setAllUnknown();
+    writable(valid)->setAllUnknown();
 }
 
 SymbolicValue* SymbolicHeader::clone() const {
     auto result = new SymbolicHeader(type->to<IR::Type_Header>());
-    for (auto f : fieldValue)
-        result->fieldValue[f.first] = f.second->clone();
-    result->valid = valid->clone()->to<SymbolicBool>();
+    result->shareFields(this);
+    valid->share();
+    result->valid = valid;
     return result;
 }
 
 void SymbolicHeader::assign(const SymbolicValue* other) {
     if (other->is<SymbolicError>()) return;
     BUG_CHECK(other->is<SymbolicStruct>() , "%1%: expected a struct", other);
-    if (auto hv = other->to<SymbolicStruct>()) {
-        for (auto f : hv->fieldValue)
-            fieldValue[f.first]->assign(f.second);
-    }
+    if (auto hv = other->to<SymbolicStruct>())
+        SymbolicStruct::assign(hv);
     if (auto hv = other->to<SymbolicHeader>())
-        valid->assign(hv->valid);
+        writable(valid)->assign(hv->valid);
     else
-        valid->assign(new SymbolicBool(true));
+        writable(valid)->assign(new SymbolicBool(true));
 }
 
 bool SymbolicHeader::merge(const SymbolicValue* other) {
     BUG_CHECK(other->is<SymbolicHeader>(), "%1%: expected a header", other);
     auto hv = other->to<SymbolicHeader>();
-    bool changes = false;
-    for (auto f : hv->fieldValue)
-        changes = changes || fieldValue[f.first]->merge(f.second);
-    changes = changes || valid->merge(hv->valid);
+    bool changes = SymbolicStruct::merge(hv);
+    changes = changes || writable(valid)->merge(hv->valid);
     return changes;
 }
 
@@ -452,14 +482,21 @@ bool SymbolicHeader::equals(const SymbolicValue* other) const {
     return SymbolicStruct::equals(other);
 }
 
+size_t SymbolicHeader::hash() const {
+    size_t result = valid->hash();
+    if (valid->isKnown() && !valid->value)
+        return result;
+    return result * 31 + SymbolicStruct::hash();
+}
+
 void SymbolicHeader::dbprint(std::ostream& out) const {
     out << "{ ";
     out << "valid=>";
     valid->dbprint(out);
 #if 0
-    for (auto f : fieldValue) {
+    for (size_t i = 0; i < fieldValue.size(); i++) {
         out << ", ";
-        out << f.first << "=>" << f.second;
+        out << fieldName(i) << "=>" << fieldValue[i];
     }
 #endif
     out << " }";
@@ -485,20 +522,29 @@ SymbolicArray::SymbolicArray(const IR::Type_Stack* type, bool uninitialized,
 }
 
 void SymbolicArray::shift(int amount) {
+    // As for push_front/pop_front, the moved elements keep their values and
+    // the vacated elements become invalid.  A moved element may end up in two
+    // positions, so it is shared, and a vacated element is copied before it
+    // is invalidated: invalidating it in place would also invalidate the
+    // element moved out of that position, which is still in the stack.
     if (amount < 0) {
-        for (unsigned i = 0; i < values.size() + amount; i++)
+        for (unsigned i = 0; i < values.size() + amount; i++) {
             values[i] = values[i - amount];
+            values[i]->share();
+        }
         for (unsigned i = values.size() + amount; i < values.size(); i++) {
             if (values[i]->is<SymbolicHeader>()) {
-                values[i]->to<SymbolicHeader>()->setValid(false);
+                writable(values[i])->to<SymbolicHeader>()->setValid(false);
             }
         }
     } else if (amount > 0) {
-        for (unsigned i = 0; i < values.size() - amount; i++)
+        for (unsigned i = 0; i < values.size() - amount; i++) {
             values[values.size() - i - 1] = values[values.size() - i - amount - 1];
+            values[values.size() - i - 1]->share();
+        }
         for (unsigned i = 0; i < (unsigned)amount; i++){
             if (values[i]->is<SymbolicHeader>()) {
-                values[i]->to<SymbolicHeader>()->setValid(false);
+                writable(values[i])->to<SymbolicHeader>()->setValid(false);
             }
         }
     }
@@ -512,10 +558,10 @@ SymbolicValue* SymbolicArray::next(const IR::Node* node) {
                 v->to<SymbolicHeader>()->valid->isUninitialized())
                 return new AnyElement(this);
             if (!v->to<SymbolicHeader>()->valid->value)
-                return v;
+                return writable(values[i]);
         }
         if (values[i]->is<SymbolicHeaderUnion>()) {
-                return v;
+                return writable(values[i]);
         }
     }
     return new SymbolicException(node, P4::StandardExceptions::StackOutOfBounds);
@@ -549,10 +595,10 @@ SymbolicValue* SymbolicArray::last(const IR::Node* node) {
                 v->to<SymbolicHeader>()->valid->isUninitialized())
                 return new AnyElement(this);
             if (v->to<SymbolicHeader>()->valid->value)
-                return v;
+                return writable(values[index]);
         }
         if (values[i]->is<SymbolicHeaderUnion>()) {
-                return v;
+                return writable(values[index]);
         }
     }
     return new SymbolicException(node, P4::StandardExceptions::StackOutOfBounds);
@@ -560,13 +606,14 @@ SymbolicValue* SymbolicArray::last(const IR::Node* node) {
 
 void SymbolicArray::setAllUnknown() {
     for (unsigned i = 0; i < values.size(); i++)
-        values.at(i)->setAllUnknown();
+        writable(values.at(i))->setAllUnknown();
 }
 
 SymbolicValue* SymbolicArray::clone() const {
     auto result = new SymbolicArray(type->to<IR::Type_Stack>());
-    for (unsigned i=0; i < values.size(); i++)
-        result->values.push_back(get(nullptr, i)->clone()->to<SymbolicStruct>());
+    result->values = values;
+    for (auto v : values)
+        v->share();
     return result;
 }
 
@@ -574,14 +621,15 @@ void SymbolicArray::assign(const SymbolicValue* other) {
     if (other->is<SymbolicError>()) return;
     BUG_CHECK(other->is<SymbolicArray>(), "%1%: expected an array", other);
     for (unsigned i=0; i < values.size(); i++)
-        values.at(i)->assign(other->to<SymbolicArray>()->get(nullptr, i));
+        writable(values.at(i))->assign(other->to<SymbolicArray>()->get(nullptr, i));
 }
 
 bool SymbolicArray::merge(const SymbolicValue* other) {
     BUG_CHECK(other->is<SymbolicArray>(), "%1%: expected an array", other);
     bool changes = false;
     for (unsigned i=0; i < values.size(); i++)
-        changes = changes || values.at(i)->merge(other->to<SymbolicArray>()->get(nullptr, i));
+        changes = changes ||
+                writable(values.at(i))->merge(other->to<SymbolicArray>()->get(nullptr, i));
     return changes;
 }
 
@@ -590,12 +638,21 @@ bool SymbolicArray::equals(const SymbolicValue* other) const {
         return false;
     auto sa = other->to<SymbolicArray>();
     for (unsigned i=0; i < values.size(); i++) {
-        if (!values.at(i)->equals(sa->get(nullptr, i)))
+        auto v = values.at(i);
+        auto o = sa->get(nullptr, i);
+        if (v != o && !v->equals(o))
             return false;
     }
     return true;
 }
 
+size_t SymbolicArray::hash() const {
+    size_t result = 0;
+    for (auto v : values)
+        result = result * 31 + v->hash();
+    return result;
+}
+
 bool SymbolicArray::hasUninitializedParts() const {
     for (unsigned i=0; i < values.size(); i++)
         if (values.at(i)->hasUninitializedParts())
@@ -646,13 +703,13 @@ SymbolicTuple::SymbolicTuple(const IR::Type_Tuple* type, bool uninitialized,
 
 void SymbolicTuple::setAllUnknown() {
     for (unsigned i = 0; i < values.size(); i++)
-        values.at(i)->setAllUnknown();
+        writable(values.at(i))->setAllUnknown();
 }
 
 SymbolicValue* SymbolicTuple::clone() const {
     auto result = new SymbolicTuple(type->to<IR::Type_Tuple>());
     for (unsigned i=0; i < values.size(); i++)
-        result->values.push_back(get(i)->clone());
+        result->add(get(i));
     return result;
 }
 
@@ -662,7 +719,7 @@ bool SymbolicTuple::merge(const SymbolicValue* other) {
     BUG_CHECK(values.size() == tpl->values.size(), "merging tuples with different sizes");
     bool changes = false;
     for (unsigned i=0; i < values.size(); i++)
-        changes = changes || values.at(i)->merge(tpl->get(i));
+        changes = changes || writable(values.at(i))->merge(tpl->get(i));
     return changes;
 }
 
@@ -676,6 +733,13 @@ bool SymbolicTuple::equals(const SymbolicValue* other) const {
     return true;
 }
 
+size_t SymbolicTuple::hash() const {
+    size_t result = 0;
+    for (auto v : values)
+        result = result * 31 + v->hash();
+    return result;
+}
+
 bool SymbolicTuple::hasUninitializedParts() const {
     for (unsigned i=0; i < values.size(); i++)
         if (values.at(i)->hasUninitializedParts())
@@ -1020,11 +1084,11 @@ void ExpressionEvaluator::postorder(const IR::Member* expression) {
         set(expression, v);
     } else if (basetype->is<IR::Type_HeaderUnion>()) {
         BUG_CHECK(l->is<SymbolicHeaderUnion>(), "%1%: expected a header union", l);
-        auto v = l->to<SymbolicHeaderUnion>()->get(expression, expression->member.name);
+        auto v = l->to<SymbolicHeaderUnion>()->getWritable(expression, expression->member.name);
         set(expression, v);
     } else {
         BUG_CHECK(l->is<SymbolicStruct>(), "%1%: expected a struct", l);
-        auto v = l->to<SymbolicStruct>()->get(expression, expression->member.name);
+        auto v = l->to<SymbolicStruct>()->getWritable(expression, expression->member.name);
         set(expression, v);
     }
 }
@@ -1069,7 +1133,7 @@ void ExpressionEvaluator::postorder(const IR::ArrayIndex* expression) {
     CHECK_NULL(lv);
     auto ix = r->to<SymbolicInteger>();
     CHECK_NULL(ix);
-    auto result = lv->get(expression, ix->constant->asInt());
+    auto result = lv->getWritable(expression, ix->constant->asInt());
     set(expression, result);
 }
 
@@ -1080,7 +1144,9 @@ void ExpressionEvaluator::postorder(const IR::PathExpression* expression) {
     if (type->is<IR::Type_Error>())
         result = new SymbolicEnum(type, decl->getName());
     else
-        result = valueMap->get(decl);
+        // The evaluation may modify the value (e.g., through method calls),
+        // so it must not be shared with other valuations.
+        result = valueMap->getWritable(decl);
     set(expression, result);
 }
 
@@ -1193,7 +1259,7 @@ void ExpressionEvaluator::postorder(const IR::MethodCallExpression* expression)
                 }
 
                 auto decl = em->object;
-                auto obj = valueMap->get(decl);
+                auto obj = valueMap->getWritable(decl);
                 CHECK_NULL(obj);
                 if (obj->is<SymbolicError>()) {
                     set(expression, obj);
@@ -1233,7 +1299,7 @@ void ExpressionEvaluator::postorder(const IR::MethodCallExpression* expression)
 
     // For all other methods we act conservatively:
     // in arguments are unchanged, and the out arguments have an unknown value.
-    for (auto p : *mi->substitution.getParametersInArgumentOrder()) {
+    for (auto p : mi->substitution.getParametersInArgumentOrder()) {
         if (p->direction == IR::Direction::Out || p->direction == IR::Direction::InOut) {
             auto arg = mi->substitution.lookup(p);
             auto val = get(arg->expression);
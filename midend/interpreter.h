@@ -27,12 +27,26 @@ namespace P4 {
 
 class SymbolicValueFactory;
 
-// Base class for all abstract values
+// Base class for all abstract values.
+// Values are copy-on-write: cloning an aggregate value only copies the
+// pointers to its components, which become shared.  A shared value is never
+// modified in place; the aggregate (or ValueMap) holding it replaces it with
+// a private copy before modifying it.
 class SymbolicValue : public IHasDbPrint {
     static unsigned crtid;
+    // Set when the value may be reachable from more than one place.
+    mutable bool shared = false;
 
  protected:
     explicit SymbolicValue(const IR::Type* type) : id(crtid++), type(type) {}
+    SymbolicValue(const SymbolicValue& other) : id(crtid++), type(other.type) {}
+
+    // Replaces 'value' with a private copy if it is shared.
+    template<typename T> static T* writable(T*& value) {
+        if (value->shared)
+            value = value->clone()->template to<T>();
+        return value;
+    }
 
  public:
     const unsigned id;
@@ -48,6 +62,10 @@ class SymbolicValue : public IHasDbPrint {
         auto result = dynamic_cast<const T*>(this);
         return result; }
     template<typename T> bool is() const { return dynamic_cast<const T*>(this) != nullptr; }
+    void share() const { shared = true; }
+    bool isShared() const { return shared; }
+    // Returns a copy of this value; the components of aggregate values
+    // are shared with the original.
     virtual SymbolicValue* clone() const = 0;
     virtual void setAllUnknown() = 0;
     virtual void assign(const SymbolicValue* other) = 0;
@@ -55,6 +73,8 @@ class SymbolicValue : public IHasDbPrint {
     // Returns 'true' if merging changed the current value.
     virtual bool merge(const SymbolicValue* other) = 0;
     virtual bool equals(const SymbolicValue* other) const = 0;
+    // Values which are equal have the same hash.
+    virtual size_t hash() const { return 0; }
     // True if some parts of this value are definitely uninitialized
     virtual bool hasUninitializedParts() const = 0;
 };
@@ -77,10 +97,14 @@ class SymbolicValueFactory {
 class ValueMap final : public IHasDbPrint {
  public:
     std::map<const IR::IDeclaration*, SymbolicValue*> map;
+    // The values are shared between the original and the clone,
+    // and copied when they are modified through getWritable.
     ValueMap* clone() const {
         auto result = new ValueMap();
-        for (auto v : map)
-            result->map.emplace(v.first, v.second->clone());
+        for (auto v : map) {
+            v.second->share();
+            result->map.emplace_hint(result->map.end(), v.first, v.second);
+        }
         return result;
     }
     ValueMap* filter(std::function<bool(const IR::IDeclaration*, const SymbolicValue*)> filter) {
@@ -94,6 +118,17 @@ class ValueMap final : public IHasDbPrint {
     { CHECK_NULL(left); CHECK_NULL(right); map[left] = right; }
     SymbolicValue* get(const IR::IDeclaration* left) const
     { CHECK_NULL(left); return ::get(map, left); }
+    // Returns the value of 'left', which can be modified without
+    // affecting other valuations.
+    SymbolicValue* getWritable(const IR::IDeclaration* left) {
+        CHECK_NULL(left);
+        auto it = map.find(left);
+        if (it == map.end())
+            return nullptr;
+        if (it->second->isShared())
+            it->second = it->second->clone();
+        return it->second;
+    }
 
     void dbprint(std::ostream& out) const {
         bool first = true;
@@ -110,10 +145,16 @@ class ValueMap final : public IHasDbPrint {
         for (auto d : map) {
             auto v = other->get(d.first);
             CHECK_NULL(v);
-            change = change || d.second->merge(v);
+            change = change || getWritable(d.first)->merge(v);
         }
         return change;
     }
+    size_t hash() const {
+        size_t result = 0;
+        for (auto v : map)
+            result = result * 31 + v.second->hash();
+        return result;
+    }
     bool equals(const ValueMap* other) const {
         BUG_CHECK(map.size() == other->map.size(), "Incompatible maps compared");
         for (auto v : map) {
@@ -306,6 +347,8 @@ class SymbolicBool final : public ScalarValue {
     void assign(const SymbolicValue* other) override;
     bool merge(const SymbolicValue* other) override;
     bool equals(const SymbolicValue* other) const override;
+    size_t hash() const override
+    { return static_cast<size_t>(state) * 2 + (isKnown() && value); }
 };
 
 class SymbolicInteger final : public ScalarValue {
@@ -332,6 +375,7 @@ class SymbolicInteger final : public ScalarValue {
     void assign(const SymbolicValue* other) override;
     bool merge(const SymbolicValue* other) override;
     bool equals(const SymbolicValue* other) const override;
+    size_t hash() const override;
 };
 
 class SymbolicVarbit final : public ScalarValue {
@@ -348,6 +392,8 @@ class SymbolicVarbit final : public ScalarValue {
     void assign(const SymbolicValue* other) override;
     bool merge(const SymbolicValue* other) override;
     bool equals(const SymbolicValue* other) const override;
+    size_t hash() const override
+    { return static_cast<size_t>(state); }
 };
 
 // represents enum, error, and match_kind
@@ -370,23 +416,54 @@ class SymbolicEnum final : public ScalarValue {
     void assign(const SymbolicValue* other) override;
     bool merge(const SymbolicValue* other) override;
     bool equals(const SymbolicValue* other) const override;
+    size_t hash() const override;
 };
 
 class SymbolicStruct : public SymbolicValue {
+ protected:
+    // Copies the field values of 'other', which become shared.
+    void shareFields(const SymbolicStruct* other);
+    // Index in fieldValue of the field of 'other' with the given index.
+    size_t matchingField(const SymbolicStruct* other, size_t otherIndex) const;
+
  public:
     explicit SymbolicStruct(const IR::Type_StructLike* type) :
             SymbolicValue(type) { CHECK_NULL(type); }
-    std::map<cstring, SymbolicValue*> fieldValue;
+    // Field values, indexed by the position of the field in the type;
+    // may be empty for values which do not hold fields (see AnyElement).
+    std::vector<SymbolicValue*> fieldValue;
     SymbolicStruct(const IR::Type_StructLike* type, bool uninitialized,
                    const SymbolicValueFactory* factory);
+    const IR::Type_StructLike* structType() const
+    { return type->to<IR::Type_StructLike>(); }
+    size_t fieldIndex(cstring field) const {
+        int index = structType()->getFieldIndex(field);
+        BUG_CHECK(index >= 0, "%1%: no field %2%", type, field);
+        return static_cast<size_t>(index);
+    }
+    cstring fieldName(size_t index) const
+    { return structType()->fields.at(index)->name.name; }
     virtual SymbolicValue* get(const IR::Node*, cstring field) const {
-        auto r = ::get(fieldValue, field);
+        auto index = fieldIndex(field);
+        auto r = index < fieldValue.size() ? fieldValue[index] : nullptr;
         CHECK_NULL(r);
         return r;
     }
+    // Like get, but the result can be modified without affecting other values.
+    SymbolicValue* getWritable(const IR::Node* node, cstring field) {
+        auto r = get(node, field);
+        auto& slot = fieldValue.at(fieldIndex(field));
+        if (slot == r)
+            r = writable(slot);
+        return r;
+    }
     void set(cstring field, SymbolicValue* value) {
         CHECK_NULL(value);
-        fieldValue[field] = value;
+        if (fieldValue.size() != structType()->fields.size())
+            fieldValue.resize(structType()->fields.size());
+        // The value may also be held elsewhere.
+        value->share();
+        fieldValue[fieldIndex(field)] = value;
     }
     void dbprint(std::ostream& out) const override;
     bool isScalar() const override { return false; }
@@ -395,6 +472,7 @@ class SymbolicStruct : public SymbolicValue {
     void assign(const SymbolicValue* other) override;
     bool merge(const SymbolicValue* other) override;
     bool equals(const SymbolicValue* other) const override;
+    size_t hash() const override;
     bool hasUninitializedParts() const override;
 };
 
@@ -412,6 +490,7 @@ class SymbolicHeader : public SymbolicStruct {
     void dbprint(std::ostream& out) const override;
     bool merge(const SymbolicValue* other) override;
     bool equals(const SymbolicValue* other) const override;
+    size_t hash() const override;
 };
 
 class SymbolicHeaderUnion : public SymbolicStruct {
@@ -446,9 +525,16 @@ class SymbolicArray final : public SymbolicValue {
             return new SymbolicException(node, P4::StandardExceptions::StackOutOfBounds);
         return values.at(index);
     }
+    // Like get, but the result can be modified without affecting other values.
+    SymbolicValue* getWritable(const IR::Node* node, size_t index) {
+        if (index >= values.size())
+            return new SymbolicException(node, P4::StandardExceptions::StackOutOfBounds);
+        return writable(values.at(index));
+    }
     void shift(int amount);  // negative = shift left
     void set(size_t index, SymbolicHeader* value) {
         CHECK_NULL(value);
+        value->share();
         values[index] = value;
     }
     void dbprint(std::ostream& out) const override;
@@ -461,6 +547,7 @@ class SymbolicArray final : public SymbolicValue {
     void assign(const SymbolicValue* other) override;
     bool merge(const SymbolicValue* other) override;
     bool equals(const SymbolicValue* other) const override;
+    size_t hash() const override;
     bool hasUninitializedParts() const override;
 };
 
@@ -496,6 +583,7 @@ class SymbolicTuple final : public SymbolicValue {
     SymbolicTuple(const IR::Type_Tuple* type,
                bool uninitialized, const SymbolicValueFactory* factory);
     SymbolicValue* get(size_t index) const { return values.at(index); }
+    SymbolicValue* getWritable(size_t index) { return writable(values.at(index)); }
     void dbprint(std::ostream& out) const override {
         bool first = true;
         for (auto f : values) {
@@ -511,9 +599,10 @@ class SymbolicTuple final : public SymbolicValue {
     void assign(const SymbolicValue*) override
     { BUG("%1%: tuples are read-only", this); }
     void add(SymbolicValue* value)
-    { values.push_back(value); }
+    { value->share(); values.push_back(value); }
     bool merge(const SymbolicValue* other) override;
     bool equals(const SymbolicValue* other) const override;
+    size_t hash() const override;
     bool hasUninitializedParts() const override;
 };
 
@@ -569,6 +658,8 @@ class SymbolicPacketIn final : public SymbolicExtern {
     { minimumStreamOffset += width; }
     bool merge(const SymbolicValue* other) override;
     bool equals(const SymbolicValue* other) const override;
+    size_t hash() const override
+    { return minimumStreamOffset; }
 };
 
 }  // namespace P4
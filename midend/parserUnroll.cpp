@@ -308,6 +308,10 @@ class ParserSymbolicInterpreter {
     bool                unroll;
     StatesVisitedMap    visitedStates;
     bool&               wasError;
+    /// Distinct valuations produced after the evaluation of each state, by
+    /// their hash; an equal valuation computed later is replaced by the one
+    /// stored here.
+    std::map<VisitedKey, std::unordered_map<size_t, std::vector<ValueMap*>>> valuations;
 
     ValueMap* initializeVariables() {
         wasError = false;
@@ -356,8 +360,8 @@ class ParserSymbolicInterpreter {
             stateName == IR::ParserState::reject)
             return nullptr;
         auto state = structure->get(stateName);
-        auto pi = new ParserStateInfo(stateName, parser, state, predecessor, values->clone(),
-                                      index);
+        // The valuation is shared with the predecessor; evaluateState does not modify it.
+        auto pi = new ParserStateInfo(stateName, parser, state, predecessor, values, index);
         synthesizedParser->add(pi);
         return pi;
     }
@@ -557,6 +561,9 @@ class ParserSymbolicInterpreter {
 
     static bool headerValidityChanged(const SymbolicValue* first, const SymbolicValue* second) {
         CHECK_NULL(first); CHECK_NULL(second);
+        // Values shared between valuations are unchanged.
+        if (first == second)
+            return false;
         if (first->is<SymbolicHeader>()) {
             auto fhdr = first->to<SymbolicHeader>();
             auto shdr = second->to<SymbolicHeader>();
@@ -576,9 +583,9 @@ class ParserSymbolicInterpreter {
             auto fstruct = first->to<SymbolicStruct>();
             auto sstruct = second->to<SymbolicStruct>();
             CHECK_NULL(sstruct);
-            for (auto f : fstruct->fieldValue) {
-                auto ffield = fstruct->get(nullptr, f.first);
-                auto sfield = sstruct->get(nullptr, f.first);
+            for (size_t i = 0; i < fstruct->fieldValue.size(); i++) {
+                auto ffield = fstruct->fieldValue[i];
+                auto sfield = sstruct->fieldValue.at(i);
                 if (headerValidityChanged(ffield, sfield))
                     return true;
             }
@@ -610,6 +617,23 @@ class ParserSymbolicInterpreter {
         return true;
     }
 
+    /// Returns a valuation equal to @p values which was produced before for a
+    /// state with the same key, or stores @p values if there is none.
+    ValueMap* shareValuation(const ParserStateInfo* state, ValueMap* values) {
+        // Only valuations with the same hash are compared.
+        auto& known = valuations[VisitedKey(state)][values->hash()];
+        for (auto v : known) {
+            if (v == values || v->equals(values)) {
+                if (v != values)
+                    structure->statistics.sharedValuations++;
+                return v;
+            }
+        }
+        known.push_back(values);
+        structure->statistics.distinctValuations++;
+        return values;
+    }
+
     /// Return true if we have detected a loop we cannot unroll
     bool checkLoops(ParserStateInfo* state) const {
         const ParserStateInfo* crt = state;
@@ -620,11 +644,12 @@ class ParserSymbolicInterpreter {
             if (crt->state == state->state) {
                 // Loop detected.
                 // Check if any packet in the valueMap has changed
+                // Shared valuations are known to be equal.
+                bool sameValues = crt->before == state->before;
                 auto filter = [](const IR::IDeclaration*, const SymbolicValue* value)
                         { return value->is<SymbolicPacketIn>(); };
-                auto packets = state->before->filter(filter);
-                auto prevPackets = crt->before->filter(filter);
-                if (packets->equals(prevPackets)) {
+                if (sameValues ||
+                    state->before->filter(filter)->equals(crt->before->filter(filter))) {
                     for (auto p : state->before->map) {
                         if (p.second->is<SymbolicPacketIn>()) {
                             auto pkt = p.second->to<SymbolicPacketIn>();
@@ -685,6 +710,7 @@ class ParserSymbolicInterpreter {
                 return EvaluationStateResult(nullptr, false);
             newStates.insert(newName);
         }
+        structure->statistics.evaluatedStates++;
         for (auto s : state->state->components) {
             auto* newComponent = executeStatement(state, s, valueMap);
             if (!newComponent)
@@ -694,6 +720,13 @@ class ParserSymbolicInterpreter {
         }
         state->after = valueMap;
         auto result = evaluateSelect(state, valueMap);
+        auto shared = shareValuation(state, valueMap);
+        if (shared != valueMap) {
+            state->after = shared;
+            if (result.first != nullptr)
+                for (auto next : *result.first)
+                    next->before = shared;
+        }
         if (unroll) {
             if (result.second == nullptr) {
                 return EvaluationStateResult(nullptr, true);
@@ -706,6 +739,7 @@ class ParserSymbolicInterpreter {
                 state->newState =
                     new IR::ParserState(state->state->srcInfo, newName, components, result.second);
             }
+            structure->statistics.generatedStates++;
         }
         return EvaluationStateResult(result.first, true);
     }
@@ -755,6 +789,19 @@ class ParserSymbolicInterpreter {
         while (!toRun.empty()) {
             auto stateInfo = toRun.back();
             toRun.pop_back();
+            auto& statistics = structure->statistics;
+            if (structure->maxEvaluatedStates != 0 &&
+                statistics.evaluatedStates >= structure->maxEvaluatedStates) {
+                ::warning(ErrorType::WARN_IGNORE,
+                          "%1%: parser unrolling stopped after evaluating %2% states",
+                          parser, statistics.evaluatedStates);
+                wasError = true;
+                break;
+            }
+            statistics.visitedStates++;
+            if (statistics.visitedStates % 1000 == 0)
+                LOG2("Unrolling " << parser->name << ": " << statistics
+                     << ", " << toRun.size() << " states to visit");
             LOG1("Symbolic evaluation of " << stateChain(stateInfo));
             // checking visited state, loop state, and the reachable states with needed header stack
             // operators.
@@ -814,17 +861,10 @@ bool ParserStructure::analyze(ReferenceMap* refMap, TypeMap* typeMap, bool unrol
 bool ParserStructure::reachableHSUsage(IR::ID id, const ParserStateInfo* state) const {
     if (!state->scenarioHS.size())
         return false;
-    CHECK_NULL(callGraph);
     const IR::IDeclaration* declaration = parser->states.getDeclaration(id.name);
     BUG_CHECK(declaration && declaration->is<IR::ParserState>(), "Invalid declaration %1%", id);
-    std::set<const IR::ParserState*> reachableStates;
-    callGraph->reachable(declaration->to<IR::ParserState>(), reachableStates);
-    std::set<cstring> reachebleHSoperators;
-    for (auto i : reachableStates) {
-        auto iHSNames = statesWithHeaderStacks.find(i->name);
-        if (iHSNames != statesWithHeaderStacks.end())
-            reachebleHSoperators.insert(iHSNames->second.begin(), iHSNames->second.end());
-    }
+    const auto& reachebleHSoperators =
+        reachableHSOperators(declaration->to<IR::ParserState>());
     std::set<cstring> intersectionHSOperators;
     std::set_intersection(state->scenarioHS.begin(), state->scenarioHS.end(),
                             reachebleHSoperators.begin(), reachebleHSoperators.end(),
@@ -833,6 +873,27 @@ bool ParserStructure::reachableHSUsage(IR::ID id, const ParserStateInfo* state)
     return intersectionHSOperators.size() > 0;
 }
 
+const std::set<cstring>&
+ParserStructure::reachableHSOperators(const IR::ParserState* state) const {
+    // The call graph and the header stack usage do not change during the
+    // symbolic evaluation, so the result is computed once per state.
+    auto it = reachableHSCache.find(state);
+    if (it != reachableHSCache.end()) {
+        statistics.reachabilityCacheHits++;
+        return it->second;
+    }
+    CHECK_NULL(callGraph);
+    std::set<const IR::ParserState*> reachableStates;
+    callGraph->reachable(state, reachableStates);
+    auto& result = reachableHSCache[state];
+    for (auto i : reachableStates) {
+        auto iHSNames = statesWithHeaderStacks.find(i->name);
+        if (iHSNames != statesWithHeaderStacks.end())
+            result.insert(iHSNames->second.begin(), iHSNames->second.end());
+    }
+    return result;
+}
+
 void ParserStructure::addStateHSUsage(const IR::ParserState* state,
                                       const IR::Expression* expression) {
     if (state == nullptr || expression == nullptr || !expression->type->is<IR::Type_Stack>())
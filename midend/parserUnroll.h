@@ -67,6 +67,30 @@ class StackVariableHash {
 
 typedef std::unordered_map<StackVariable, size_t, StackVariableHash> StackVariableMap;
 
+/// Counters collected while symbolically evaluating the states of a parser.
+struct ParserUnrollStatistics {
+    /// Number of parser state instances taken from the worklist.
+    size_t visitedStates = 0;
+    /// Number of state instances whose statements were symbolically executed.
+    size_t evaluatedStates = 0;
+    /// Number of state instances produced by the unrolling.
+    size_t generatedStates = 0;
+    /// Number of valuations replaced by an equal valuation computed earlier.
+    size_t sharedValuations = 0;
+    /// Number of distinct valuations kept.
+    size_t distinctValuations = 0;
+    /// Number of reachability queries answered from the cache.
+    size_t reachabilityCacheHits = 0;
+
+    void dbprint(std::ostream& out) const {
+        out << "visited " << visitedStates << ", evaluated " << evaluatedStates
+            << ", generated " << generatedStates << " states; "
+            << distinctValuations << " distinct valuations, "
+            << sharedValuations << " shared; "
+            << reachabilityCacheHits << " reachability cache hits";
+    }
+};
+
 /// Information produced for a parser state by the symbolic evaluator
 struct ParserStateInfo {
     friend class ParserStateRewriter;
@@ -74,6 +98,8 @@ struct ParserStateInfo {
     const IR::P4Parser*             parser;
     const IR::ParserState*          state;  // original state this is produced from
     const ParserStateInfo*          predecessor;     // how we got here in the symbolic evaluation
+    /// Valuations are shared between states and must not be mutated:
+    /// 'before' is the 'after' valuation of the predecessor.
     ValueMap*                       before;
     ValueMap*                       after;
     IR::ParserState*                newState;        // pointer to a new state
@@ -137,6 +163,9 @@ class ParserStructure {
     StateCallGraph*        callGraph;
     std::map<cstring, std::set<cstring> > statesWithHeaderStacks;
     std::map<cstring, size_t>  callsIndexes;  // map for curent calls of state insite current one
+    /// Maximum number of state instances to evaluate symbolically; 0 means no limit.
+    size_t maxEvaluatedStates = 0;
+    mutable ParserUnrollStatistics statistics;
     void setParser(const IR::P4Parser* parser) {
         CHECK_NULL(parser);
         callGraph = new StateCallGraph(parser->name);
@@ -159,6 +188,11 @@ class ParserStructure {
     void evaluateReachability();
     /// add HS name which is used in a current state.
     void addStateHSUsage(const IR::ParserState* state, const IR::Expression* expression);
+    /// HS names used in the states reachable from @p state; computed once per state.
+    const std::set<cstring>& reachableHSOperators(const IR::ParserState* state) const;
+
+ private:
+    mutable std::map<const IR::ParserState*, std::set<cstring>> reachableHSCache;
 };
 
 class AnalyzeParser : public Inspector {
@@ -192,14 +226,16 @@ class ParserRewriter : public PassManager {
     bool hasOutOfboundState;
     bool wasError;
     ParserRewriter(ReferenceMap* refMap,
-                   TypeMap* typeMap, bool unroll) {
+                   TypeMap* typeMap, bool unroll, size_t maxEvaluatedStates = 0) {
         CHECK_NULL(refMap); CHECK_NULL(typeMap);
         wasError = false;
+        current.maxEvaluatedStates = maxEvaluatedStates;
         setName("ParserRewriter");
         addPasses({
             new AnalyzeParser(refMap, &current),
             [this, refMap, typeMap, unroll](void) {
-                hasOutOfboundState = current.analyze(refMap, typeMap, unroll, wasError); },
+                hasOutOfboundState = current.analyze(refMap, typeMap, unroll, wasError);
+                LOG1("Unrolling " << current.parser->name << ": " << current.statistics); },
         });
     }
 };
@@ -211,17 +247,20 @@ class RewriteAllParsers : public Transform {
     ReferenceMap*           refMap;
     TypeMap*                typeMap;
     bool                    unroll;
+    size_t                  maxEvaluatedStates;
 
  public:
-    RewriteAllParsers(ReferenceMap* refMap, TypeMap* typeMap, bool unroll) :
-            refMap(refMap), typeMap(typeMap), unroll(unroll) {
+    RewriteAllParsers(ReferenceMap* refMap, TypeMap* typeMap, bool unroll,
+                      size_t maxEvaluatedStates = 0) :
+            refMap(refMap), typeMap(typeMap), unroll(unroll),
+            maxEvaluatedStates(maxEvaluatedStates) {
         CHECK_NULL(refMap); CHECK_NULL(typeMap); setName("RewriteAllParsers");
     }
 
     // start generation of a code
     const IR::Node* postorder(IR::P4Parser* parser) override {
         // making rewriting
-        auto rewriter = new ParserRewriter(refMap, typeMap, unroll);
+        auto rewriter = new ParserRewriter(refMap, typeMap, unroll, maxEvaluatedStates);
         rewriter->setCalledBy(this);
         parser->apply(*rewriter);
         if (rewriter->wasError) {
@@ -277,13 +316,17 @@ class RewriteAllParsers : public Transform {
     }
 };
 
+/// Unrolls the loops of all parsers.  If @p maxEvaluatedStates is not 0, a
+/// parser whose unrolling needs to evaluate more state instances is left
+/// unchanged and a warning is reported.
 class ParsersUnroll : public PassManager {
  public:
-    ParsersUnroll(bool unroll, ReferenceMap* refMap, TypeMap* typeMap) {
+    ParsersUnroll(bool unroll, ReferenceMap* refMap, TypeMap* typeMap,
+                  size_t maxEvaluatedStates = 0) {
         // remove block statements
         passes.push_back(new SimplifyControlFlow(refMap, typeMap));
         passes.push_back(new TypeChecking(refMap, typeMap));
-        passes.push_back(new RewriteAllParsers(refMap, typeMap, unroll));
+        passes.push_back(new RewriteAllParsers(refMap, typeMap, unroll, maxEvaluatedStates));
         setName("ParsersUnroll");
     }
 };
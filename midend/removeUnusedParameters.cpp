@@ -17,7 +17,7 @@ limitations under the License.
 #include "removeUnusedParameters.h"
 
 #include <algorithm>
-#include "lib/enumerator.h"
+#include "lib/iterator_range.h"
 
 namespace P4 {
 
@@ -30,7 +30,7 @@ const IR::Node* RemoveUnusedActionParameters::postorder(IR::P4Action* action) {
 
     // Some parameters are unused; filter them out.
     auto newParams = new IR::ParameterList;
-    for (auto param : *params->getEnumerator()->where(isUsed))
+    for (auto param : Util::make_range(*params).where(isUsed))
         newParams->push_back(param);
 
     action->parameters = newParams;
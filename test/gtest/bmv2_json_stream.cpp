@@ -0,0 +1,57 @@
+/*
+Copyright 2013-present Barefoot Networks, Inc.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdlib.h>
+
+#include <string>
+
+#include "gtest/gtest.h"
+#include "helpers.h"
+
+namespace Test {
+
+class Bmv2JsonStream : public P4CTest { };
+
+namespace {
+
+/// Compiles @p program with @p compiler, rendering the parts of the JSON
+/// output as they are converted and keeping them all as a tree, and checks
+/// that both outputs are the same.
+void compareOutputs(const std::string& compiler, const std::string& program) {
+    std::string source = "../testdata/p4_16_samples/" + program;
+    int exitCode = system((compiler + " -o streamed.json " + source).c_str());
+    ASSERT_FALSE(exitCode);
+    exitCode = system((compiler + " --json-tree -o tree.json " + source).c_str());
+    ASSERT_FALSE(exitCode);
+    exitCode = system("cmp streamed.json tree.json");
+    EXPECT_FALSE(exitCode);
+    exitCode = system("rm -f streamed.json tree.json");
+    ASSERT_FALSE(exitCode);
+}
+
+}  // namespace
+
+TEST_F(Bmv2JsonStream, simpleSwitch) {
+    compareOutputs("./p4c-bm2-ss", "basic_routing-bmv2.p4");
+    compareOutputs("./p4c-bm2-ss", "action_profile-bmv2.p4");
+    compareOutputs("./p4c-bm2-ss", "table-entries-exact-ternary-bmv2.p4");
+}
+
+TEST_F(Bmv2JsonStream, psaSwitch) {
+    compareOutputs("./p4c-bm2-psa", "psa-basic-counter-bmv2.p4");
+}
+
+}  // namespace Test
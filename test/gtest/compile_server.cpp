@@ -0,0 +1,177 @@
+/*
+Copyright 2013-present Barefoot Networks, Inc.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <fcntl.h>
+#include <limits.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "helpers.h"
+
+namespace Test {
+
+namespace {
+
+const char* compiler = "./p4c-bm2-ss";
+const char* socketPath = "compile_server_test.sock";
+
+int connectToServer() {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, socketPath, sizeof(addr.sun_path) - 1);
+    int sock = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (sock < 0) return -1;
+    if (connect(sock, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0) {
+        close(sock);
+        return -1;
+    }
+    return sock;
+}
+
+/// Sends the command line @args to the server connected on @sock, with
+/// @out and @err as the standard output and error of the compilation, as
+/// tools/driver/p4c_src/util.py does.
+bool sendRequest(int sock, const std::vector<std::string>& args, int out, int err) {
+    char cwd[PATH_MAX];
+    if (!getcwd(cwd, sizeof(cwd))) return false;
+    std::string payload = std::string(cwd) + '\0';
+    for (auto& arg : args)
+        payload += arg + '\0';
+
+    uint32_t size = payload.size();
+    union {
+        char buffer[CMSG_SPACE(2 * sizeof(int))];
+        struct cmsghdr align;
+    } control;
+    memset(&control, 0, sizeof(control));
+    struct iovec iov = { &size, sizeof(size) };
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.buffer;
+    msg.msg_controllen = sizeof(control.buffer);
+    auto cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(2 * sizeof(int));
+    int fds[2] = { out, err };
+    memcpy(CMSG_DATA(cmsg), fds, sizeof(fds));
+    if (sendmsg(sock, &msg, 0) != sizeof(size)) return false;
+    return write(sock, payload.data(), payload.size()) == ssize_t(payload.size());
+}
+
+/// Compiles @args on the server; returns the exit code, or -1 if the server
+/// did not reply.
+int compileOnServer(const std::vector<std::string>& args) {
+    int sock = connectToServer();
+    if (sock < 0) return -1;
+    int out = open("served.out", O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    int32_t rc = -1;
+    if (out >= 0 && sendRequest(sock, args, out, out)) {
+        if (read(sock, &rc, sizeof(rc)) != sizeof(rc))
+            rc = -1;
+    }
+    if (out >= 0) close(out);
+    close(sock);
+    return rc;
+}
+
+/// True if the server closed the connection @sock.
+bool closedByServer(int sock) {
+    struct pollfd fd = { sock, POLLIN, 0 };
+    return poll(&fd, 1, 0) > 0 && (fd.revents & (POLLIN | POLLHUP));
+}
+
+}  // namespace
+
+class P4CCompileServer : public P4CTest {
+ protected:
+    pid_t server = -1;
+
+    void SetUp() override {
+        unlink(socketPath);
+        server = fork();
+        ASSERT_LE(0, server);
+        if (server == 0) {
+            execl(compiler, compiler, "--server", socketPath, nullptr);
+            _exit(127);
+        }
+        // The server parses the include files before listening.
+        for (int i = 0; i < 600; i++) {
+            int sock = connectToServer();
+            if (sock >= 0) {
+                close(sock);
+                return;
+            }
+            ASSERT_EQ(0, waitpid(server, nullptr, WNOHANG)) << "The server exited";
+            usleep(100000);
+        }
+        FAIL() << "The server did not start";
+    }
+
+    void TearDown() override {
+        if (server > 0) {
+            kill(server, SIGTERM);
+            waitpid(server, nullptr, 0);
+        }
+        unlink(socketPath);
+    }
+};
+
+TEST_F(P4CCompileServer, sameOutput) {
+    std::string source = "../testdata/p4_16_samples/basic_routing-bmv2.p4";
+    int exitCode = system((std::string(compiler) + " -o direct.json " + source).c_str());
+    ASSERT_FALSE(exitCode);
+    EXPECT_EQ(0, compileOnServer({ "-o", "served.json", source }));
+    exitCode = system("cmp direct.json served.json");
+    EXPECT_FALSE(exitCode);
+
+    // Errors are reported to the client, with the exit code.
+    EXPECT_NE(0, compileOnServer({ "-o", "served.json", "missing.p4" }));
+    exitCode = system("grep -q missing.p4 served.out");
+    EXPECT_FALSE(exitCode);
+
+    exitCode = system("rm -f direct.json served.json served.out");
+    ASSERT_FALSE(exitCode);
+}
+
+TEST_F(P4CCompileServer, slowClient) {
+    // A client which has not sent its request yet does not hold up others.
+    int slow = connectToServer();
+    ASSERT_LE(0, slow);
+    std::string source = "../testdata/p4_16_samples/basic_routing-bmv2.p4";
+    EXPECT_EQ(0, compileOnServer({ "-o", "served.json", source }));
+    EXPECT_FALSE(closedByServer(slow));
+    close(slow);
+
+    int exitCode = system("rm -f served.json served.out");
+    ASSERT_FALSE(exitCode);
+}
+
+}  // namespace Test
@@ -0,0 +1,64 @@
+/*
+Copyright 2013-present Barefoot Networks, Inc.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <sstream>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "helpers.h"
+#include "ir/ir.h"
+
+#include "frontends/common/parseInput.h"
+#include "frontends/p4/toP4/diffDump.h"
+
+using namespace P4;
+
+namespace Test {
+
+class P4CDiffDump : public P4CTest { };
+
+TEST_F(P4CDiffDump, onlyNewDeclarations) {
+    auto program = parseP4String(R"(
+        const bit<8> a = 1;
+        const bit<8> b = 2;
+        control c() { apply {} }
+    )", CompilerOptions::FrontendVersion::P4_16);
+    ASSERT_TRUE(program);
+
+    auto stream = new std::stringstream;
+    DiffDump diff(stream, nullptr);
+    diff.dump("first", program);
+    EXPECT_EQ(3u, diff.stats.printed);
+
+    // The same program again, without b and with a new node for c.
+    IR::Vector<IR::Node> objects;
+    objects.push_back(program->objects[0]);
+    objects.push_back(program->objects[2]->clone());
+    diff.dump("second", new IR::P4Program(program->srcInfo, objects));
+    EXPECT_EQ(2u, diff.stats.dumps);
+    EXPECT_EQ(5u, diff.stats.declarations);
+    EXPECT_EQ(4u, diff.stats.printed);
+
+    auto text = stream->str();
+    auto second = text.find("#@pass second\n");
+    ASSERT_NE(std::string::npos, second);
+    EXPECT_EQ(std::string::npos, text.find("#@item 0", second));
+    EXPECT_NE(std::string::npos, text.find("#@item 3 decl", second));
+    EXPECT_NE(std::string::npos, text.find("#@order 0 1 2\n"));
+    EXPECT_NE(std::string::npos, text.find("#@order 0 3\n", second));
+}
+
+}  // namespace Test
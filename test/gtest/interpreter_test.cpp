@@ -0,0 +1,150 @@
+/*
+Copyright 2013-present Barefoot Networks, Inc.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "gtest/gtest.h"
+#include "helpers.h"
+#include "ir/ir.h"
+
+#include "frontends/common/parseInput.h"
+#include "frontends/common/resolveReferences/referenceMap.h"
+#include "frontends/p4/typeChecking/typeChecker.h"
+#include "frontends/p4/typeMap.h"
+#include "midend/interpreter.h"
+
+using namespace P4;
+
+namespace Test {
+
+/// Creates symbolic values of the struct S declared in a type checked program.
+class P4CInterpreter : public P4CTest {
+ protected:
+    ReferenceMap refMap;
+    TypeMap typeMap;
+    const IR::Type_Struct* structType = nullptr;
+
+    void SetUp() override {
+        auto program = parseP4String(R"(
+            header H { bit<8> f; }
+            struct S { H h; H[3] hs; bit<8> x; }
+        )", CompilerOptions::FrontendVersion::P4_16);
+        ASSERT_TRUE(program);
+        program = program->apply(TypeChecking(&refMap, &typeMap));
+        ASSERT_TRUE(program);
+        ASSERT_EQ(0u, ::errorCount());
+        structType = program->objects.at(1)->to<IR::Type_Struct>();
+        ASSERT_TRUE(structType);
+    }
+
+    SymbolicStruct* create() {
+        SymbolicValueFactory factory(&typeMap);
+        return factory.create(structType, false)->to<SymbolicStruct>();
+    }
+
+    static SymbolicInteger* constant(int value) {
+        return new SymbolicInteger(new IR::Constant(IR::Type_Bits::get(8), value));
+    }
+
+    static bool isValid(const SymbolicValue* value) {
+        auto header = value->to<SymbolicHeader>();
+        return header != nullptr && header->valid->isKnown() && header->valid->value;
+    }
+};
+
+TEST_F(P4CInterpreter, copyStruct) {
+    auto original = create();
+    ASSERT_TRUE(original);
+    auto copy = original->clone()->to<SymbolicStruct>();
+    ASSERT_TRUE(copy);
+    EXPECT_TRUE(copy->equals(original));
+
+    copy->getWritable(nullptr, "x")->assign(constant(5));
+    EXPECT_TRUE(copy->get(nullptr, "x")->to<SymbolicInteger>()->isKnown());
+    EXPECT_TRUE(original->get(nullptr, "x")->to<SymbolicInteger>()->isUnknown());
+    EXPECT_FALSE(copy->equals(original));
+
+    // Assigning a whole struct does not make the two values share mutations.
+    original->assign(copy);
+    EXPECT_TRUE(original->equals(copy));
+    original->getWritable(nullptr, "x")->assign(constant(6));
+    EXPECT_EQ(5, copy->get(nullptr, "x")->to<SymbolicInteger>()->constant->asInt());
+}
+
+TEST_F(P4CInterpreter, copyHeader) {
+    auto original = create();
+    ASSERT_TRUE(original);
+    auto copy = original->clone()->to<SymbolicStruct>();
+    ASSERT_TRUE(copy);
+
+    auto header = copy->getWritable(nullptr, "h")->to<SymbolicHeader>();
+    ASSERT_TRUE(header);
+    header->setValid(true);
+    header->getWritable(nullptr, "f")->assign(constant(1));
+    EXPECT_TRUE(isValid(copy->get(nullptr, "h")));
+    EXPECT_FALSE(isValid(original->get(nullptr, "h")));
+
+    // Copying the header again and changing the copy leaves both others unchanged.
+    auto second = header->clone()->to<SymbolicHeader>();
+    second->getWritable(nullptr, "f")->assign(constant(2));
+    EXPECT_EQ(1, header->get(nullptr, "f")->to<SymbolicInteger>()->constant->asInt());
+    EXPECT_EQ(2, second->get(nullptr, "f")->to<SymbolicInteger>()->constant->asInt());
+    second->setValid(false);
+    EXPECT_TRUE(isValid(header));
+}
+
+TEST_F(P4CInterpreter, copyStack) {
+    auto original = create();
+    ASSERT_TRUE(original);
+    auto stack = original->getWritable(nullptr, "hs")->to<SymbolicArray>();
+    ASSERT_TRUE(stack);
+    for (size_t i = 0; i < stack->size; i++) {
+        auto element = stack->getWritable(nullptr, i)->to<SymbolicHeader>();
+        element->setValid(true);
+        element->getWritable(nullptr, "f")->assign(constant(i));
+    }
+
+    auto copy = original->clone()->to<SymbolicStruct>();
+    auto copyStack = copy->getWritable(nullptr, "hs")->to<SymbolicArray>();
+    ASSERT_TRUE(copyStack);
+    copyStack->getWritable(nullptr, 1)->to<SymbolicHeader>()->setValid(false);
+    EXPECT_FALSE(isValid(copyStack->get(nullptr, 1)));
+    EXPECT_TRUE(isValid(stack->get(nullptr, 1)));
+
+    // pop_front(1): the elements move down and the last one becomes invalid,
+    // without invalidating the element which was moved out of it.
+    copy = original->clone()->to<SymbolicStruct>();
+    copyStack = copy->getWritable(nullptr, "hs")->to<SymbolicArray>();
+    copyStack->shift(-1);
+    EXPECT_TRUE(isValid(copyStack->get(nullptr, 0)));
+    EXPECT_TRUE(isValid(copyStack->get(nullptr, 1)));
+    EXPECT_FALSE(isValid(copyStack->get(nullptr, 2)));
+    auto f = copyStack->get(nullptr, 1)->to<SymbolicHeader>()->get(nullptr, "f");
+    EXPECT_EQ(2, f->to<SymbolicInteger>()->constant->asInt());
+    // Changing a moved element does not change the original stack.
+    copyStack->getWritable(nullptr, 0)->to<SymbolicHeader>()
+            ->getWritable(nullptr, "f")->assign(constant(7));
+    f = stack->get(nullptr, 1)->to<SymbolicHeader>()->get(nullptr, "f");
+    EXPECT_EQ(1, f->to<SymbolicInteger>()->constant->asInt());
+
+    // push_front(1): the first element becomes invalid.
+    copyStack->shift(1);
+    EXPECT_FALSE(isValid(copyStack->get(nullptr, 0)));
+    EXPECT_TRUE(isValid(copyStack->get(nullptr, 1)));
+    EXPECT_TRUE(isValid(copyStack->get(nullptr, 2)));
+    for (size_t i = 0; i < stack->size; i++)
+        EXPECT_TRUE(isValid(stack->get(nullptr, i)));
+}
+
+}  // namespace Test
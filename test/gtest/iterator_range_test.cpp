@@ -0,0 +1,158 @@
+/*
+Copyright 2013-present Barefoot Networks, Inc.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "helpers.h"
+#include "ir/ir.h"
+#include "lib/iterator_range.h"
+
+#include "frontends/common/parseInput.h"
+#include "frontends/common/resolveReferences/referenceMap.h"
+#include "frontends/common/resolveReferences/resolveReferences.h"
+
+namespace Test {
+
+class UtilIteratorRange : public ::testing::Test {
+ protected:
+    class A {
+     public:
+        int a;
+        explicit A(int a) : a(a) {}
+        virtual ~A() {}
+    };
+
+    class B : public A {
+     public:
+        explicit B(int b) : A(b) {}
+    };
+
+    std::vector<int> vec{ 1, 2, 3 };
+};
+
+TEST_F(UtilIteratorRange, Linq) {
+    auto isOdd = [](int x) { return x % 2 == 1; };
+    auto odd = Util::make_range(vec).where(isOdd);
+    EXPECT_EQ(2u, odd.count());
+    EXPECT_EQ(1, odd.nextOrDefault());
+    EXPECT_THROW(odd.single(), std::logic_error);
+
+    auto squares = odd.map([](int x) { return x * x; }).toVector();
+    EXPECT_EQ((std::vector<int>{ 1, 9 }), squares);
+
+    auto even = Util::make_range(vec).where([](int x) { return x % 2 == 0; });
+    EXPECT_EQ(2, even.single());
+    auto none = even.where([](int x) { return x > 2; });
+    EXPECT_FALSE(none.any());
+    EXPECT_EQ(0, none.nextOrDefault());
+
+    int sum = 0;
+    for (auto a : Util::make_range(vec).concat(odd))
+        sum += a;
+    EXPECT_EQ(10, sum);
+}
+
+TEST_F(UtilIteratorRange, CastAndEnumerate) {
+    std::vector<A*> vec{ new A(1), new B(2), new A(3), new B(4) };
+    auto bs = Util::make_range(vec).as<B*>().where([](B* b) { return b != nullptr; });
+    EXPECT_EQ(2u, bs.count());
+    EXPECT_EQ(2, (*bs.begin())->a);
+
+    // An enumerator over a whole chain of adaptors
+    auto enumerator = Util::enumerate(bs);
+    EXPECT_EQ(2u, enumerator->count());
+    enumerator->reset();
+    EXPECT_EQ(2, enumerator->next()->a);
+    EXPECT_EQ(4, enumerator->next()->a);
+    EXPECT_FALSE(enumerator->moveNext());
+}
+
+class IteratorRangeDeclarations : public P4CTest { };
+
+TEST_F(IteratorRangeDeclarations, ProgramLookups) {
+    std::string program = P4_SOURCE(P4Headers::NONE, R"(
+        match_kind { exact }
+        const bit<8> a = 1;
+        const bit<8> b = 2;
+        extern void f();
+        extern void f(in bit<8> x);
+        control c() { apply {} }
+    )");
+    auto pgm = P4::parseP4String(program, CompilerOptions::FrontendVersion::P4_16);
+    ASSERT_TRUE(pgm != nullptr && ::errorCount() == 0);
+
+    // match_kind is not a declaration
+    EXPECT_EQ(5u, pgm->getDeclarations()->count());
+    EXPECT_EQ(2u, pgm->getDeclsByName("f")->count());
+    EXPECT_EQ("b", pgm->getDeclsByName("b")->single()->getName().name);
+    EXPECT_EQ(nullptr, pgm->getDeclsByName("d")->nextOrDefault());
+    EXPECT_EQ(1u, pgm->objects.only<IR::P4Control>()->count());
+    EXPECT_EQ(1u, pgm->objects.onlyRange<IR::P4Control>().count());
+    EXPECT_EQ(2u, pgm->objects.only<IR::Declaration_Constant>()->count());
+    auto constants = pgm->objects.onlyRange<IR::Declaration_Constant>().toVector();
+    ASSERT_EQ(2u, constants.size());
+    EXPECT_EQ("a", constants.at(0)->name.name);
+    EXPECT_EQ("b", constants.at(1)->name.name);
+}
+
+TEST_F(IteratorRangeDeclarations, ManyDeclarations) {
+    const int declarations = 500;
+    std::stringstream source;
+    for (int i = 0; i < declarations; i++)
+        source << "const bit<32> c" << i << " = " << i << ";\n";
+    source << "control ctrl(out bit<32> x) { apply {\n";
+    for (int i = 0; i < declarations; i += 10)
+        source << "    x = c" << i << ";\n";
+    source << "} }\n";
+    auto pgm = P4::parseP4String(source.str(), CompilerOptions::FrontendVersion::P4_16);
+    ASSERT_TRUE(pgm != nullptr && ::errorCount() == 0);
+
+    // Lookups find the same declarations as the Enumerator chain
+    // IR::P4Program used to build.
+    for (int i = 0; i < declarations; i += 7) {
+        cstring name = "c" + std::to_string(i);
+        auto expected = pgm->objects.getEnumerator()
+                ->as<const IR::IDeclaration*>()
+                ->where([](const IR::IDeclaration* d) { return d != nullptr; })
+                ->where([name](const IR::IDeclaration* d) { return d->getName().name == name; })
+                ->toVector();
+        auto found = pgm->getDeclsByName(name)->toVector();
+        EXPECT_EQ(*expected, *found);
+        ASSERT_EQ(1u, found->size());
+        EXPECT_EQ(pgm->objects.at(i), found->at(0)->getNode());
+    }
+
+    // Every path in the control resolves to its constant.
+    P4::ReferenceMap refMap;
+    pgm->apply(P4::ResolveReferences(&refMap));
+    ASSERT_EQ(0u, ::errorCount());
+    unsigned resolved = 0;
+    forAllMatching<IR::PathExpression>(pgm, [&](const IR::PathExpression* path) {
+        auto decl = refMap.getDeclaration(path->path);
+        ASSERT_NE(nullptr, decl);
+        if (path->path->name.name == "x")
+            return;
+        EXPECT_EQ(path->path->name.name, decl->getName().name);
+        EXPECT_TRUE(decl->is<IR::Declaration_Constant>());
+        resolved++;
+    });
+    EXPECT_EQ(static_cast<unsigned>(declarations / 10), resolved);
+}
+
+}  // namespace Test
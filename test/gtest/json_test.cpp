@@ -71,4 +71,39 @@ TEST(Util, Json) {
               obj->toString());
 }
 
+TEST(Util, JsonWriter) {
+    std::ostringstream out;
+    {
+        JsonWriter writer(out);
+        writer.beginObject()
+              .key("x").value("x")
+              .key("y").beginArray()
+                  .value(5).value("5")
+                  .beginArray(true).value(true).endArray()
+              .endArray()
+              .key("z").beginObject().endObject()
+              .endObject();
+    }
+    EXPECT_EQ("{\n  \"x\" : \"x\",\n  \"y\" : [\n    5,\n    \"5\",\n    [true]\n  ],"
+              "\n  \"z\" : {\n  }\n}", out.str());
+
+    // Pre-rendered text is indented to the level where it is inserted.
+    auto inner = new JsonObject();
+    inner->emplace("a", 1);
+    auto arr = new JsonArray();
+    arr->append(new JsonText(inner));
+    auto obj = new JsonObject();
+    obj->emplace("t", arr);
+    EXPECT_EQ("{\n  \"t\" : [\n    {\n      \"a\" : 1\n    }\n  ]\n}", obj->toString());
+    arr->clear();
+    arr->append(inner);
+    EXPECT_EQ(obj->toString(), JsonText(obj).toString());
+
+    std::ostringstream bad;
+    JsonWriter writer(bad);
+    writer.beginObject();
+    EXPECT_THROW(writer.value(1), std::logic_error);
+    EXPECT_THROW(writer.endArray(), std::logic_error);
+}
+
 }  // namespace Util
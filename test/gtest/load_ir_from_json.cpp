@@ -20,14 +20,20 @@ limitations under the License.
 #include <string>
 #include <iostream>
 #include <fstream>
+#include <sstream>
 #include <thread>
 #include <cstdlib>
 
 #include "gtest/gtest.h"
 #include "ir/ir.h"
+#include "ir/json_generator.h"
+#include "ir/json_loader.h"
+#include "ir/json_snapshot.h"
 #include "helpers.h"
 #include "lib/log.h"
 
+#include "frontends/common/parseInput.h"
+
 using namespace P4;
 using namespace std;
 
@@ -53,4 +59,139 @@ TEST_F(FromJSONTest, load_ir_from_json) {
     ASSERT_FALSE(exitCode);
 }
 
+TEST_F(FromJSONTest, load_ir_from_snapshot) {
+    int exitCode = system("./p4c-bm2-ss -o outputTO.json ../test/test_fromJSON.p4 "
+                          "--toIRSnapshot snapshotFile.p4ir");
+    ASSERT_FALSE(exitCode);
+    exitCode = system("./p4c-bm2-ss -o outputFROM.json --fromJSON snapshotFile.p4ir");
+    ASSERT_FALSE(exitCode);
+    exitCode = system("grep -v program outputTO.json > outputTO.json.tmp; "
+                      "mv outputTO.json.tmp outputTO.json");
+    ASSERT_FALSE(exitCode);
+    exitCode = system("grep -v program outputFROM.json > outputFROM.json.tmp; "
+                      "mv outputFROM.json.tmp outputFROM.json");
+    ASSERT_FALSE(exitCode);
+    exitCode = system("diff outputTO.json outputFROM.json");
+    ASSERT_FALSE(exitCode);
+    exitCode = system("rm -f outputFROM.json outputTO.json snapshotFile.p4ir");
+    ASSERT_FALSE(exitCode);
+}
+
+namespace {
+
+std::string toText(JsonData *json) {
+    std::stringstream ss;
+    ss << json;
+    return ss.str();
+}
+
+std::string toSnapshot(JsonData *json) {
+    std::stringstream ss;
+    writeJsonSnapshot(ss, json);
+    return ss.str();
+}
+
+}  // namespace
+
+TEST_F(FromJSONTest, snapshot_values) {
+    std::stringstream text(R"({
+        "a" : [1, -2, 0, true, false, null, "s", "s", "\"q\""],
+        "b" : {"c" : 123456789012345678901234567890, "d" : -9223372036854775808},
+        "e" : [],
+        "f" : {}
+    })");
+    JsonData *json = nullptr;
+    text >> json;
+    ASSERT_NE(nullptr, json);
+
+    auto snapshot = toSnapshot(json);
+    ASSERT_TRUE(isJsonSnapshot(snapshot.data(), snapshot.size()));
+    auto loaded = readJsonSnapshot(snapshot.data(), snapshot.size());
+    ASSERT_NE(nullptr, loaded);
+    EXPECT_EQ(toText(json), toText(loaded));
+
+    // Repeated strings are shared
+    auto a = loaded->to<JsonObject>()->at("a")->to<JsonVector>();
+    EXPECT_EQ(a->at(6), a->at(7));
+
+    // Truncated or trailing data is rejected
+    EXPECT_EQ(nullptr, readJsonSnapshot(snapshot.data(), snapshot.size() - 1));
+    EXPECT_EQ(nullptr, readJsonSnapshot((snapshot + "x").data(), snapshot.size() + 1));
+    EXPECT_FALSE(isJsonSnapshot("{}", 2));
+}
+
+TEST_F(FromJSONTest, snapshot_round_trip) {
+    std::string program = P4_SOURCE(P4Headers::CORE, R"(
+        header H { bit<8> f; bit<16> g; }
+        struct S { H h; }
+        parser p(packet_in pkt, out S s) {
+            state start { pkt.extract(s.h); transition accept; }
+        }
+        control c(inout S s) {
+            action a(bit<8> v) { s.h.f = v; }
+            table t { key = { s.h.g : exact; } actions = { a; } }
+            apply { if (s.h.isValid()) t.apply(); }
+        }
+    )");
+    auto pgm = P4::parseP4String(program, CompilerOptions::FrontendVersion::P4_16);
+    ASSERT_TRUE(pgm != nullptr && ::errorCount() == 0);
+
+    std::stringstream text;
+    JSONGenerator(text, true) << pgm << std::endl;
+    std::stringstream snapshot;
+    writeIRSnapshot(snapshot, pgm);
+    EXPECT_LT(snapshot.str().size(), text.str().size());
+
+    // Both forms load into the same JsonData, and into equivalent programs
+    JSONLoader fromText(text);
+    JSONLoader fromSnapshot(snapshot);
+    ASSERT_NE(nullptr, fromText.json);
+    ASSERT_NE(nullptr, fromSnapshot.json);
+    EXPECT_EQ(toText(fromText.json), toText(fromSnapshot.json));
+
+    const IR::Node *textNode = nullptr, *snapshotNode = nullptr;
+    fromText >> textNode;
+    fromSnapshot >> snapshotNode;
+    ASSERT_TRUE(textNode && textNode->is<IR::P4Program>());
+    ASSERT_TRUE(snapshotNode && snapshotNode->is<IR::P4Program>());
+    EXPECT_TRUE(textNode->equiv(*snapshotNode));
+}
+
+TEST_F(FromJSONTest, snapshot_large_round_trip) {
+    const int actions = 200;
+    std::stringstream body;
+    body << "control c(inout bit<32> x) {\n";
+    for (int i = 0; i < actions; i++)
+        body << "    action a" << i << "(bit<32> v) { x = x + v + " << i << "; }\n";
+    body << "    apply {\n";
+    for (int i = 0; i < actions; i++)
+        body << "        a" << i << "(x);\n";
+    body << "    }\n}\n";
+    std::string program = P4_SOURCE(P4Headers::CORE, body.str().c_str());
+    auto pgm = P4::parseP4String(program, CompilerOptions::FrontendVersion::P4_16);
+    ASSERT_TRUE(pgm != nullptr && ::errorCount() == 0);
+
+    std::stringstream text;
+    JSONGenerator(text, true) << pgm << std::endl;
+    std::stringstream snapshotStream;
+    writeIRSnapshot(snapshotStream, pgm);
+    std::string snapshot = snapshotStream.str();
+
+    JSONLoader textLoader(text);
+    auto snapshotJson = readJsonSnapshot(snapshot.data(), snapshot.size());
+    ASSERT_NE(nullptr, snapshotJson);
+    EXPECT_EQ(toText(textLoader.json), toText(snapshotJson));
+    // Re-encoding the decoded data gives the same snapshot.
+    EXPECT_EQ(snapshot, toSnapshot(snapshotJson));
+
+    JSONLoader snapshotLoader(snapshotJson);
+    auto textProgram = new IR::P4Program(textLoader);
+    auto snapshotProgram = new IR::P4Program(snapshotLoader);
+    EXPECT_TRUE(textProgram->equiv(*snapshotProgram));
+    auto control = snapshotProgram->getDeclsByName("c")->single()->to<IR::P4Control>();
+    ASSERT_NE(nullptr, control);
+    EXPECT_EQ(static_cast<size_t>(actions), control->controlLocals.size());
+    EXPECT_EQ(static_cast<size_t>(actions), control->body->components.size());
+}
+
 }  // namespace Test
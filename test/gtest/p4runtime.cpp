@@ -19,6 +19,7 @@ limitations under the License.
 #include <google/protobuf/util/message_differencer.h>
 
 #include <iterator>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -32,6 +33,7 @@ limitations under the License.
 #pragma GCC diagnostic pop
 
 #include "control-plane/p4RuntimeSerializer.h"
+#include "control-plane/p4RuntimeSymbolTable.h"
 #include "control-plane/typeSpecConverter.h"
 #include "frontends/common/parseInput.h"
 #include "frontends/common/resolveReferences/referenceMap.h"
@@ -42,6 +44,7 @@ limitations under the License.
 #include "helpers.h"
 #include "ir/ir.h"
 #include "lib/cstring.h"
+#include "lib/stringify.h"
 
 namespace p4v1 = ::p4::v1;
 namespace p4configv1 = ::p4::config::v1;
@@ -1468,6 +1471,57 @@ TEST_F(P4Runtime, Documentation) {
     }
 }
 
+TEST_F(P4Runtime, SymbolTableAliases) {
+    using P4::ControlPlaneAPI::P4RuntimeSymbolTable;
+    using P4::ControlPlaneAPI::P4RuntimeSymbolType;
+    auto* symbols = P4RuntimeSymbolTable::create([](P4RuntimeSymbolTable& symbols) {
+        for (auto name : { "a.b.c", "b.c", "a.d.c", "e.f", "x.y.f" })
+            symbols.add(P4RuntimeSymbolType::TABLE(), name);
+        // The same name for another type of symbol gets the same alias.
+        symbols.add(P4RuntimeSymbolType::ACTION(), "a.b.c");
+    });
+    EXPECT_EQ("a.b.c", symbols->getAlias("a.b.c"));
+    EXPECT_EQ("b.c", symbols->getAlias("b.c"));
+    EXPECT_EQ("d.c", symbols->getAlias("a.d.c"));
+    EXPECT_EQ("e.f", symbols->getAlias("e.f"));
+    EXPECT_EQ("y.f", symbols->getAlias("x.y.f"));
+    EXPECT_NE(symbols->getId(P4RuntimeSymbolType::TABLE(), "a.b.c"),
+              symbols->getId(P4RuntimeSymbolType::ACTION(), "a.b.c"));
+}
+
+TEST_F(P4Runtime, SymbolTableManySymbols) {
+    using P4::ControlPlaneAPI::P4RuntimeSymbolTable;
+    using P4::ControlPlaneAPI::P4RuntimeSymbolType;
+    using P4::ControlPlaneAPI::p4rt_id_t;
+    // A generated program with many tables, actions and value sets, each
+    // name ending in a component that other names share.
+    const int controls = 100, perControl = 100;
+    std::vector<cstring> names;
+    for (int c = 0; c < controls; c++)
+        for (int i = 0; i < perControl; i++)
+            names.push_back(cstring("ingress.c") + Util::toString(c) + ".s" +
+                            Util::toString(i) + ".obj");
+    const std::vector<P4RuntimeSymbolType> types = {
+        P4RuntimeSymbolType::TABLE(), P4RuntimeSymbolType::ACTION(),
+        P4RuntimeSymbolType::VALUE_SET() };
+
+    auto* symbols = P4RuntimeSymbolTable::create([&](P4RuntimeSymbolTable& symbols) {
+        for (auto& type : types)
+            for (auto name : names)
+                symbols.add(type, name);
+    });
+    std::set<p4rt_id_t> ids;
+    for (auto& type : types)
+        for (auto name : names)
+            ids.insert(symbols->getId(type, name));
+    for (auto name : names)
+        EXPECT_EQ(name, cstring("ingress.") + symbols->getAlias(name));
+
+    EXPECT_EQ(types.size() * names.size(), ids.size());
+    EXPECT_EQ("c7.s3.obj", symbols->getAlias("ingress.c7.s3.obj"));
+    EXPECT_EQ(0u, ::errorCount());
+}
+
 class P4RuntimePkgInfo : public P4CTest {
  protected:
     static boost::optional<P4::P4RuntimeAPI> createTestCase(const char* annotations);
@@ -0,0 +1,83 @@
+/*
+Copyright 2013-present Barefoot Networks, Inc.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "gtest/gtest.h"
+#include "helpers.h"
+#include "ir/ir.h"
+
+#include "frontends/common/parseInput.h"
+#include "frontends/p4/parseAnnotations.h"
+
+using namespace P4;
+
+namespace Test {
+
+class P4CParseAnnotations : public P4CTest {
+ protected:
+    void TearDown() override { IR::Annotation::parseBody = nullptr; }
+};
+
+TEST_F(P4CParseAnnotations, OnDemand) {
+    auto program = parseP4String(R"(
+        const bit<8> N = 4;
+        @name("top") @brief("never parsed") @length(N + 4)
+        control c() { apply {} }
+    )", CompilerOptions::FrontendVersion::P4_16);
+    ASSERT_TRUE(program);
+
+    ParseAnnotations parseAnnotations;
+    parseAnnotations.setOnDemand(true);
+    program = program->apply(parseAnnotations);
+    ASSERT_TRUE(program);
+    ASSERT_EQ(0u, ::errorCount());
+    auto& stats = parseAnnotations.getStats();
+
+    // Bodies with names or operators are parsed by the pass, so that the
+    // front end type checks and folds them.
+    auto control = program->getDeclsByName("c")->single()->to<IR::P4Control>();
+    ASSERT_TRUE(control);
+    for (auto annotation : control->annotations->annotations)
+        EXPECT_EQ(annotation->name.name != IR::Annotation::lengthAnnotation,
+                  annotation->needsParsing) << annotation;
+    EXPECT_EQ(1u, stats.parsed);
+    EXPECT_EQ(1u, stats.deferred);
+
+    // The body is parsed when a pass asks for the annotation, only once.
+    auto name = control->getAnnotation(IR::Annotation::nameAnnotation);
+    ASSERT_TRUE(name);
+    EXPECT_FALSE(name->needsParsing);
+    EXPECT_EQ("top", name->getName());
+    EXPECT_EQ(name, control->getAnnotation(IR::Annotation::nameAnnotation));
+    EXPECT_EQ(2u, stats.parsed);
+    EXPECT_EQ(1u, stats.onDemand);
+
+    // Unknown annotations are left as they are.
+    auto brief = control->getAnnotation("brief");
+    ASSERT_TRUE(brief);
+    EXPECT_TRUE(brief->needsParsing);
+    EXPECT_EQ(2u, stats.parsed);
+
+    // Another application starts with new statistics and parsed bodies.
+    program = program->apply(parseAnnotations);
+    ASSERT_TRUE(program);
+    EXPECT_EQ(0u, parseAnnotations.getStats().parsed);
+    EXPECT_EQ(1u, parseAnnotations.getStats().deferred);
+    control = program->getDeclsByName("c")->single()->to<IR::P4Control>();
+    EXPECT_NE(name, control->getAnnotation(IR::Annotation::nameAnnotation));
+    EXPECT_EQ(1u, parseAnnotations.getStats().onDemand);
+}
+
+}  // namespace Test
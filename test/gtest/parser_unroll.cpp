@@ -160,7 +160,9 @@ class MidEnd : public PassManager {
                 return root; },
             new P4::SynthesizeActions(&refMap, &typeMap, new SkipControls(v1controls)),
             new P4::MoveActionsToTables(&refMap, &typeMap),
-            options.loopsUnrolling ? new ParsersUnroll(true, &refMap, &typeMap) : nullptr,
+            options.loopsUnrolling
+                ? new ParsersUnroll(true, &refMap, &typeMap, options.loopsUnrollingMaxStates)
+                : nullptr,
             evaluator,
             [this, evaluator]() {
                 toplevel = evaluator->getToplevelBlock();
@@ -255,6 +257,52 @@ std::pair<const IR::P4Parser*, const IR::P4Parser*> loadExample(const char *file
     return rewriteParser(program, options);
 }
 
+/// Rewrites the parser of a v1model program with the parser states @p states.
+/// The caller provides the compilation context.
+std::pair<const IR::P4Parser*, const IR::P4Parser*> loadStates(const char* states,
+                                                               size_t maxStates = 0) {
+    auto& options = P4TestContext::get().options();
+    const char* argv = "./gtestp4c";
+    options.process(1, (char* const*)&argv);
+    options.langVersion = CompilerOptions::FrontendVersion::P4_16;
+    options.loopsUnrolling = true;
+    options.loopsUnrollingMaxStates = maxStates;
+    std::string source = R"(
+        header h_t { bit<8> f; }
+        struct headers { h_t[4] s; }
+        struct metadata { }
+        parser p(packet_in pkt, out headers hdr, inout metadata meta,
+                 inout standard_metadata_t sm) {
+    )";
+    source += states;
+    source += R"(
+        }
+        control vc(inout headers hdr, inout metadata meta) { apply {} }
+        control ig(inout headers hdr, inout metadata meta, inout standard_metadata_t sm) {
+            apply {}
+        }
+        control eg(inout headers hdr, inout metadata meta, inout standard_metadata_t sm) {
+            apply {}
+        }
+        control cc(inout headers hdr, inout metadata meta) { apply {} }
+        control dp(packet_out pkt, in headers hdr) { apply { pkt.emit(hdr); } }
+        V1Switch(p(), vc(), ig(), eg(), cc(), dp()) main;
+    )";
+    auto program = P4::parseP4String(P4_SOURCE(P4Headers::V1MODEL, source.c_str()),
+                                     options.langVersion);
+    if (!program)
+        return std::make_pair(nullptr, nullptr);
+    return rewriteParser(program, options);
+}
+
+/// Extracts the stack elements until one has f == 0.
+static const char* stackLoop = R"(
+    state start {
+        pkt.extract(hdr.s.next);
+        transition select(hdr.s.last.f) { 0: accept; default: start; }
+    }
+)";
+
 TEST_F(P4CParserUnroll, test1) {
     auto parsers = loadExample("parser-unroll-test1.p4");
     ASSERT_TRUE(parsers.first);
@@ -314,4 +362,48 @@ TEST_F(P4CParserUnroll, header_union) {
     ASSERT_EQ(parsers.first->states.size(), parsers.second->states.size());
 }
 
+TEST_F(P4CParserUnroll, loopWithSameValuation) {
+    // The state 'loop' does not change any value: it is reached again with
+    // the (shared) valuation it was evaluated with, which ends the unrolling.
+    AutoCompileContext autoP4TestContext(new P4TestContext);
+    auto parsers = loadStates(R"(
+        state start { transition loop; }
+        state loop {
+            transition select(pkt.lookahead<bit<8>>()) { 0: stack; default: loop; }
+        }
+        state stack {
+            pkt.extract(hdr.s.next);
+            transition select(hdr.s.last.f) { 0: accept; default: stack; }
+        }
+    )");
+    ASSERT_TRUE(parsers.first);
+    ASSERT_TRUE(parsers.second);
+    EXPECT_EQ(0u, ::errorCount());
+    EXPECT_NE(0u, ::diagnosticCount());
+    // The parser is left unchanged.
+    EXPECT_EQ(parsers.first->states.size(), parsers.second->states.size());
+}
+
+TEST_F(P4CParserUnroll, maxEvaluatedStates) {
+    {
+        // Without a limit, the loop is unrolled once per stack element.
+        AutoCompileContext autoP4TestContext(new P4TestContext);
+        auto parsers = loadStates(stackLoop);
+        ASSERT_TRUE(parsers.first);
+        ASSERT_TRUE(parsers.second);
+        EXPECT_EQ(0u, ::errorCount());
+        EXPECT_LT(parsers.first->states.size(), parsers.second->states.size());
+    }
+    {
+        // With a lower limit, the parser is left unchanged with a warning.
+        AutoCompileContext autoP4TestContext(new P4TestContext);
+        auto parsers = loadStates(stackLoop, 2);
+        ASSERT_TRUE(parsers.first);
+        ASSERT_TRUE(parsers.second);
+        EXPECT_EQ(0u, ::errorCount());
+        EXPECT_NE(0u, ::diagnosticCount());
+        EXPECT_EQ(parsers.first->states.size(), parsers.second->states.size());
+    }
+}
+
 }  // namespace Test
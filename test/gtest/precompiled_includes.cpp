@@ -0,0 +1,245 @@
+/*
+Copyright 2013-present Barefoot Networks, Inc.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdlib.h>
+
+#include <sstream>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "helpers.h"
+#include "ir/ir.h"
+
+#include "frontends/common/parser_options.h"
+#include "frontends/common/precompiledIncludes.h"
+#include "frontends/common/resolveReferences/referenceMap.h"
+#include "frontends/common/resolveReferences/resolveReferences.h"
+#include "frontends/p4/toP4/toP4.h"
+#include "frontends/p4/typeChecking/typeChecker.h"
+#include "frontends/p4/typeMap.h"
+#include "frontends/parsers/parserDriver.h"
+
+using namespace P4;
+
+namespace Test {
+
+class P4CPrecompiledIncludes : public P4CTest { };
+
+namespace {
+
+const char* includeDir = "/p4c-test/p4include";
+
+/// What the preprocessor makes of a program that starts with a license
+/// comment and includes core.p4 from @dir.
+std::string preprocessed(const char* body, const char* dir = includeDir) {
+    std::stringstream input;
+    input << "# 1 \"prog.p4\"\n"
+          << "/* Copyright\n   (license) */\n"
+          << "# 1 \"" << dir << "/core.p4\" 1\n"
+          << P4CTestEnvironment::get()->coreP4()
+          << "\n# 4 \"prog.p4\" 2\n"
+          << body;
+    return input.str();
+}
+
+const IR::P4Program* parseWithoutCache(const std::string& input) {
+    std::istringstream stream(input);
+    return P4ParserDriver::parse(stream, "prog.p4");
+}
+
+const char* program1 = R"(
+header H { bit<8> f; }
+error { Custom }
+parser p(packet_in pkt, out H h) {
+    state start { pkt.extract<H>(h); transition accept; }
+}
+)";
+
+const char* program2 = R"(
+control c(inout bit<8> x) {
+    action a() { x = 1; }
+    apply { a(); }
+}
+)";
+
+size_t errorMembers(const IR::P4Program* program) {
+    for (auto node : program->objects)
+        if (auto error = node->to<IR::Type_Error>())
+            return error->members.size();
+    return 0;
+}
+
+}  // namespace
+
+TEST_F(P4CPrecompiledIncludes, reuseInMemory) {
+    PrecompiledIncludes::clear();
+    auto before = PrecompiledIncludes::stats;
+    auto pgm1 = PrecompiledIncludes::parse(preprocessed(program1), "prog.p4",
+                                           includeDir, nullptr, "test");
+    auto pgm2 = PrecompiledIncludes::parse(preprocessed(program2), "prog.p4",
+                                           includeDir, nullptr, "test");
+    ASSERT_TRUE(pgm1 != nullptr && pgm2 != nullptr && ::errorCount() == 0);
+    EXPECT_EQ(before.misses + 1, PrecompiledIncludes::stats.misses);
+    EXPECT_EQ(before.memoryHits + 1, PrecompiledIncludes::stats.memoryHits);
+
+    // Same programs as without the cache
+    auto ref1 = parseWithoutCache(preprocessed(program1));
+    auto ref2 = parseWithoutCache(preprocessed(program2));
+    ASSERT_TRUE(ref1 != nullptr && ref2 != nullptr);
+    EXPECT_TRUE(pgm1->equiv(*ref1));
+    EXPECT_TRUE(pgm2->equiv(*ref2));
+
+    // The error declared by the first program is not seen by the second
+    EXPECT_EQ(errorMembers(ref1), errorMembers(pgm1));
+    EXPECT_EQ(errorMembers(ref2), errorMembers(pgm2));
+    EXPECT_EQ(errorMembers(pgm1), errorMembers(pgm2) + 1);
+
+    // Declarations from the prelude come before the program
+    ReferenceMap refMap;
+    pgm1->apply(ResolveReferences(&refMap));
+    EXPECT_EQ(0u, ::errorCount());
+}
+
+TEST_F(P4CPrecompiledIncludes, noPrelude) {
+    auto before = PrecompiledIncludes::stats;
+    std::string input = std::string("# 1 \"prog.p4\"\n// no includes\n") + program2;
+    auto pgm = PrecompiledIncludes::parse(input, "prog.p4", includeDir, nullptr, "test");
+    ASSERT_TRUE(pgm != nullptr && ::errorCount() == 0);
+    EXPECT_EQ(before.misses, PrecompiledIncludes::stats.misses);
+    EXPECT_EQ(before.memoryHits, PrecompiledIncludes::stats.memoryHits);
+    EXPECT_EQ(1u, pgm->objects.size());
+}
+
+TEST_F(P4CPrecompiledIncludes, sharedAcrossPrograms) {
+    // Two programs with different names and headers, including core.p4 and
+    // an architecture file; the preprocessor returns to each program between
+    // the two includes.
+    auto preprocessedWithArch = [](const char* file, const char* header, const char* body) {
+        std::stringstream input;
+        input << "# 1 \"" << file << "\"\n" << header
+              << "# 1 \"" << includeDir << "/core.p4\" 1\n"
+              << P4CTestEnvironment::get()->coreP4()
+              << "\n# 2 \"" << file << "\" 2\n"
+              << "# 1 \"" << includeDir << "/arch.p4\" 1\n"
+              << "extern E { E(); void f(); }\n"
+              << "\n# 3 \"" << file << "\" 2\n"
+              << body;
+        return input.str();
+    };
+
+    PrecompiledIncludes::clear();
+    auto before = PrecompiledIncludes::stats;
+    auto input1 = preprocessedWithArch("a.p4", "// A\n", program1);
+    auto input2 = preprocessedWithArch("b.p4", "/* B */\n", program2);
+    auto pgm1 = PrecompiledIncludes::parse(input1, "a.p4", includeDir, nullptr, "test");
+    auto pgm2 = PrecompiledIncludes::parse(input2, "b.p4", includeDir, nullptr, "test");
+    ASSERT_TRUE(pgm1 != nullptr && pgm2 != nullptr && ::errorCount() == 0);
+    EXPECT_EQ(before.misses + 1, PrecompiledIncludes::stats.misses);
+    EXPECT_EQ(before.memoryHits + 1, PrecompiledIncludes::stats.memoryHits);
+    EXPECT_TRUE(pgm2->equiv(*parseWithoutCache(input2)));
+}
+
+TEST_F(P4CPrecompiledIncludes, reuseFromDisk) {
+    char dir[] = "/tmp/p4c-includes-XXXXXX";
+    ASSERT_NE(nullptr, mkdtemp(dir));
+
+    PrecompiledIncludes::clear();
+    auto before = PrecompiledIncludes::stats;
+    auto pgm1 = PrecompiledIncludes::parse(preprocessed(program1), "prog.p4",
+                                           includeDir, dir, "test");
+    // Another compiler run, as far as the cache is concerned
+    PrecompiledIncludes::clear();
+    auto pgm2 = PrecompiledIncludes::parse(preprocessed(program1), "prog.p4",
+                                           includeDir, dir, "test");
+    // Another compiler version does not use the same file
+    PrecompiledIncludes::clear();
+    auto pgm3 = PrecompiledIncludes::parse(preprocessed(program1), "prog.p4",
+                                           includeDir, dir, "other");
+    ASSERT_TRUE(pgm1 && pgm2 && pgm3 && ::errorCount() == 0);
+    EXPECT_EQ(before.misses + 2, PrecompiledIncludes::stats.misses);
+    EXPECT_EQ(before.diskHits + 1, PrecompiledIncludes::stats.diskHits);
+    EXPECT_TRUE(pgm1->equiv(*pgm2));
+    EXPECT_TRUE(pgm1->equiv(*pgm3));
+
+    std::string cmd = std::string("rm -rf ") + dir;
+    EXPECT_EQ(0, system(cmd.c_str()));
+}
+
+TEST_F(P4CPrecompiledIncludes, coldThenWarm) {
+    // The same program compiled without and with a parsed prelude in the
+    // cache directory prints the same, and reports the same diagnostics.
+    char dir[] = "/tmp/p4c-includes-XXXXXX";
+    ASSERT_NE(nullptr, mkdtemp(dir));
+    auto input = preprocessed(R"(
+header H { bit<8> f; }
+control c(inout H h) {
+    apply { h.f = true; }
+}
+)", p4includePath);
+
+    auto compile = [&](std::string& pp, std::string& diagnostics) {
+        PrecompiledIncludes::clear();
+        auto program = PrecompiledIncludes::parse(input, "prog.p4", p4includePath, dir, "test");
+        ASSERT_TRUE(program);
+
+        std::stringstream out;
+        program->apply(ToP4(&out, false));
+        pp = out.str();
+
+        std::stringstream errors;
+        auto& reporter = BaseCompileContext::get().errorReporter();
+        auto saved = reporter.getOutputStream();
+        reporter.setOutputStream(&errors);
+        for (auto node : program->objects)
+            if (auto decl = node->to<IR::Type_Extern>())
+                if (decl->name == "packet_in")
+                    ::warning(ErrorType::WARN_UNSUPPORTED, "%1%: declared here", decl);
+        ReferenceMap refMap;
+        TypeMap typeMap;
+        program->apply(TypeChecking(&refMap, &typeMap));
+        reporter.setOutputStream(saved);
+        diagnostics = errors.str();
+    };
+
+    auto before = PrecompiledIncludes::stats;
+    std::string coldPP, coldDiagnostics, warmPP, warmDiagnostics;
+    compile(coldPP, coldDiagnostics);
+    EXPECT_EQ(before.misses + 1, PrecompiledIncludes::stats.misses);
+    EXPECT_EQ(before.diskHits, PrecompiledIncludes::stats.diskHits);
+    compile(warmPP, warmDiagnostics);
+    EXPECT_EQ(before.misses + 1, PrecompiledIncludes::stats.misses);
+    EXPECT_EQ(before.diskHits + 1, PrecompiledIncludes::stats.diskHits);
+    EXPECT_EQ(before.memoryHits, PrecompiledIncludes::stats.memoryHits);
+
+    // The declarations of core.p4 are printed as an include.
+    EXPECT_NE(std::string::npos, coldPP.find("#include <core.p4>"));
+    EXPECT_EQ(std::string::npos, coldPP.find("extern packet_in"));
+    EXPECT_EQ(coldPP, warmPP);
+
+    EXPECT_NE(std::string::npos, coldDiagnostics.find("core.p4"));
+    EXPECT_NE(std::string::npos, coldDiagnostics.find("prog.p4"));
+    EXPECT_EQ(coldDiagnostics, warmDiagnostics);
+
+    // Once in memory, the prelude is used again without the cache directory.
+    auto program = PrecompiledIncludes::parse(input, "prog.p4", p4includePath, nullptr, "test");
+    ASSERT_TRUE(program);
+    EXPECT_EQ(before.memoryHits + 1, PrecompiledIncludes::stats.memoryHits);
+
+    std::string cmd = std::string("rm -rf ") + dir;
+    EXPECT_EQ(0, system(cmd.c_str()));
+}
+
+}  // namespace Test
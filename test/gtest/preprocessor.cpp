@@ -0,0 +1,220 @@
+/*
+Copyright 2013-present Barefoot Networks, Inc.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <fstream>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "helpers.h"
+
+#include "frontends/common/preprocessor.h"
+
+using namespace P4;
+
+namespace Test {
+
+class P4CPreprocessor : public P4CTest {
+ protected:
+    std::string dir;
+
+    void SetUp() override {
+        char name[] = "/tmp/p4c-cpp-XXXXXX";
+        ASSERT_NE(nullptr, mkdtemp(name));
+        dir = name;
+        ASSERT_EQ(0, system(("mkdir " + dir + "/include").c_str()));
+        Preprocessor::clearCache();
+    }
+    void TearDown() override {
+        EXPECT_EQ(0, system(("rm -rf " + dir).c_str()));
+    }
+
+    std::string write(const std::string& name, const std::string& contents) {
+        auto path = dir + "/" + name;
+        std::ofstream(path) << contents;
+        return path;
+    }
+
+    /// Preprocesses @file with the include directory of the test; @return
+    /// the output, or the reason why the external preprocessor is needed,
+    /// prefixed with "unsupported: ".
+    std::string preprocess(const std::string& file, const std::string& options = "") {
+        Preprocessor cpp;
+        std::string output, reason;
+        if (!cpp.setOptions(options + " -I" + dir + "/include", reason) ||
+            !cpp.run(file, output, reason))
+            return "unsupported: " + reason;
+        return output;
+    }
+
+    /// Preprocesses @file as ParserOptions runs the external preprocessor,
+    /// without the markers for <built-in> and <command-line> at the start.
+    std::string externalCpp(const std::string& file) {
+        auto cmd = "cpp -C -undef -nostdinc -x assembler-with-cpp -I" + dir + "/include " + file;
+        auto in = popen(cmd.c_str(), "r");
+        if (in == nullptr) return "";
+        std::string result;
+        char* line = nullptr;
+        size_t size = 0;
+        while (getline(&line, &size, in) != -1) {
+            std::string text(line);
+            if (text.compare(0, 4, "# 0 ") == 0 || text.find("<built-in>") != std::string::npos ||
+                text.find("<command-line>") != std::string::npos)
+                continue;
+            result += text;
+        }
+        free(line);
+        pclose(in);
+        return result;
+    }
+
+    /// Preprocesses @contents with the options @options; @return the output
+    /// without blank lines, or the reason why the external preprocessor is
+    /// needed, prefixed with "unsupported: ".
+    std::string run(const std::string& contents, const std::string& options = "") {
+        auto output = preprocess(write("prog.p4", contents), options);
+        if (output.compare(0, 13, "unsupported: ") == 0) return output;
+        std::string result;
+        size_t pos = 0;
+        while (pos < output.size()) {
+            auto eol = output.find('\n', pos);
+            auto line = output.substr(pos, eol - pos);
+            if (!line.empty()) result += line + "\n";
+            pos = eol + 1;
+        }
+        return result;
+    }
+};
+
+TEST_F(P4CPreprocessor, macros) {
+    auto output = run(
+        "#define MAX(a, b) ((a) > (b) ? (a) : (b))\n"
+        "#define W 16\n"
+        "#define NEG -1\n"
+        "#define SELF SELF + 1\n"
+        "const bit<W> m = MAX(W,   8w3 + 1); // W\n"
+        "x = SELF; z = -NEG; s = \"W\";\n",
+        "-DN=2 -DF(x)=x+N");
+    auto file = dir + "/prog.p4";
+    EXPECT_EQ("# 1 \"" + file + "\"\n"
+              "const bit<16> m = ((16) > (8w3 + 1) ? (16) : (8w3 + 1)); // W\n"
+              "x = SELF + 1; z = - -1; s = \"W\";\n", output);
+    EXPECT_EQ("# 1 \"" + file + "\"\ny = 3+2;\n", run("y = F(3);\n", "-DN=2 -DF(x)=x+N"));
+}
+
+TEST_F(P4CPreprocessor, conditionals) {
+    auto output = run(
+        "#if defined(W) && W * 2 == 32 && !defined X\n"
+        "a\n"
+        "#elif 1\n"
+        "b\n"
+        "#else\n"
+        "c\n"
+        "#endif\n"
+        "#ifdef Y\n"
+        "#if Y\n"
+        "d\n"
+        "#endif\n"
+        "#endif\n",
+        "-DW=16 -DY=1 -UY");
+    EXPECT_EQ("# 1 \"" + dir + "/prog.p4\"\na\n", output);
+}
+
+TEST_F(P4CPreprocessor, includes) {
+    write("include/lib.p4",
+          "/* lib */\n"
+          "#ifndef LIB_P4\n"
+          "#define LIB_P4\n"
+          "const bit<8> lib = 1;\n"
+          "#endif\n");
+    auto before = Preprocessor::stats;
+    auto output = run("#include <lib.p4>\n#include <lib.p4>\nx\n");
+    auto lib = dir + "/include/lib.p4";
+    auto file = dir + "/prog.p4";
+    EXPECT_EQ("# 1 \"" + file + "\"\n"
+              "# 1 \"" + lib + "\" 1\n"
+              "/* lib */\n"
+              "const bit<8> lib = 1;\n"
+              "# 2 \"" + file + "\" 2\n"
+              "# 1 \"" + lib + "\" 1\n"
+              "/* lib */\n"
+              "# 3 \"" + file + "\" 2\n"
+              "x\n", output);
+    EXPECT_EQ(before.fileMisses + 1, Preprocessor::stats.fileMisses);
+    EXPECT_EQ(before.fileHits, Preprocessor::stats.fileHits);
+
+    // Another compilation in the same process uses the same text
+    run("#include <lib.p4>\n");
+    EXPECT_EQ(before.fileMisses + 1, Preprocessor::stats.fileMisses);
+    EXPECT_EQ(before.fileHits + 1, Preprocessor::stats.fileHits);
+}
+
+TEST_F(P4CPreprocessor, sameAsCpp) {
+    // Nested includes and the include guards that cpp skips or not: a file
+    // is only skipped if it has nothing but its guard, and if it was found
+    // from the same directory.
+    write("include/lib.p4",
+          "#ifndef LIB_P4\n"
+          "#define LIB_P4\n"
+          "#include \"types.p4\"\n"
+          "const bit<8> lib = 1;\n"
+          "#endif  // LIB_P4\n");
+    write("include/types.p4",
+          "\n"
+          "#if !defined(TYPES_P4)\n"
+          "#define TYPES_P4\n"
+          "typedef bit<8> T;\n"
+          "#endif\n");
+    write("include/commented.p4",
+          "/* commented */\n"
+          "#ifndef COMMENTED_P4\n"
+          "#define COMMENTED_P4\n"
+          "const bit<8> c = 2;\n"
+          "#endif\n");
+    auto file = write("prog.p4",
+          "#include <lib.p4>\n"
+          "#include <types.p4>\n"
+          "#include \"include/lib.p4\"\n"
+          "#include <commented.p4>\n"
+          "#include <commented.p4>\n"
+          "#include <lib.p4>\n"
+          "#define EMPTY\n"
+          "  EMPTY\n"
+          "x /* a\n"
+          "\n"
+          "b */\n"
+          "\n\n\n\n\n\n\n\n"
+          "#include <types.p4>\n"
+          "y\n");
+    auto expected = externalCpp(file);
+    ASSERT_NE("", expected);
+    EXPECT_EQ(expected, preprocess(file));
+}
+
+TEST_F(P4CPreprocessor, unsupported) {
+    EXPECT_EQ("unsupported: #pragma directive", run("#pragma once\n"));
+    EXPECT_EQ("unsupported: # or ## in macro CAT", run("#define CAT(a, b) a ## b\n"));
+    EXPECT_EQ("unsupported: arguments of macro F span lines",
+              run("#define F(a) a\nF(1,\n2)\n"));
+    EXPECT_EQ("unsupported: built-in macro __LINE__", run("x = __LINE__;\n"));
+    EXPECT_EQ("unsupported: cannot find include file missing.p4",
+              run("#include <missing.p4>\n"));
+    EXPECT_EQ("unsupported: option -M", run("x\n", "-M"));
+}
+
+}  // namespace Test
@@ -0,0 +1,163 @@
+/*
+Copyright 2013-present Barefoot Networks, Inc.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <sstream>
+
+#include "gtest/gtest.h"
+#include "helpers.h"
+#include "ir/ir.h"
+
+#include "frontends/common/parseInput.h"
+#include "frontends/common/resolveReferences/referenceMap.h"
+#include "frontends/common/resolveReferences/resolveReferences.h"
+
+using namespace P4;
+
+namespace Test {
+
+class P4CResolveReferences : public P4CTest { };
+
+namespace {
+
+/// Collects the declaration of every path expression named @p name.
+class FindReferences : public Inspector {
+    const ReferenceMap *refMap;
+    cstring name;
+
+ public:
+    std::vector<const IR::IDeclaration*> found;
+    FindReferences(const ReferenceMap *refMap, cstring name) : refMap(refMap), name(name) {}
+    void postorder(const IR::PathExpression *path) override {
+        if (path->path->name == name)
+            found.push_back(refMap->getDeclaration(path->path, true)); }
+};
+
+}  // namespace
+
+TEST_F(P4CResolveReferences, indexedLookups) {
+    std::string program = P4_SOURCE(P4Headers::NONE, R"(
+        match_kind { exact }
+        match_kind { ternary }
+        const bit<8> a = 1;
+        extern void f(in bit<8> x);
+        extern void f(in bit<8> x, in bit<8> y);
+        control c(inout bit<8> b) {
+            action g() { f(b); f(b, a); }
+            table t { key = { b : ternary; } actions = { g; } }
+            apply { t.apply(); }
+        }
+    )");
+    auto pgm = P4::parseP4String(program, CompilerOptions::FrontendVersion::P4_16);
+    ASSERT_TRUE(pgm != nullptr && ::errorCount() == 0);
+
+    ReferenceMap refMap;
+    ResolveReferences resolve(&refMap);
+    pgm->apply(resolve);
+    ASSERT_EQ(0u, ::errorCount());
+
+    FindReferences calls(&refMap, "f");
+    pgm->apply(calls);
+    ASSERT_EQ(2u, calls.found.size());
+    EXPECT_NE(calls.found[0], calls.found[1]);
+
+    // Applying the same pass again to a modified program must not reuse
+    // the index of the old program.
+    auto modified = pgm->clone();
+    modified->objects.erase(modified->objects.begin() + 2);
+    refMap.clear();
+    modified->apply(resolve);
+    EXPECT_NE(0u, ::errorCount());
+}
+
+TEST_F(P4CResolveReferences, shadowing) {
+    std::string program = P4_SOURCE(P4Headers::NONE, R"(
+        const bit<8> a = 1;
+        const bit<8> b = 2;
+        control c(inout bit<8> a) {
+            apply {
+                bit<8> b = 3;
+                a = b;
+            }
+        }
+        control d(inout bit<8> x) { apply { x = a + b; } }
+    )");
+    auto pgm = P4::parseP4String(program, CompilerOptions::FrontendVersion::P4_16);
+    ASSERT_TRUE(pgm != nullptr && ::errorCount() == 0);
+
+    ReferenceMap refMap;
+    pgm->apply(ResolveReferences(&refMap));
+    ASSERT_EQ(0u, ::errorCount());
+
+    // The local declarations hide the constants in c, but not in d.
+    FindReferences as(&refMap, "a");
+    pgm->apply(as);
+    ASSERT_EQ(2u, as.found.size());
+    EXPECT_TRUE(as.found[0]->is<IR::Parameter>());
+    EXPECT_TRUE(as.found[1]->is<IR::Declaration_Constant>());
+    EXPECT_EQ(pgm->objects.at(0), as.found[1]->getNode());
+
+    FindReferences bs(&refMap, "b");
+    pgm->apply(bs);
+    ASSERT_EQ(2u, bs.found.size());
+    EXPECT_TRUE(bs.found[0]->is<IR::Declaration_Variable>());
+    EXPECT_EQ(pgm->objects.at(1), bs.found[1]->getNode());
+}
+
+TEST_F(P4CResolveReferences, redeclaration) {
+    std::string program = P4_SOURCE(P4Headers::NONE, R"(
+        const bit<8> a = 1;
+        const bit<8> a = 2;
+        control c(out bit<8> x) { apply { x = a; } }
+    )");
+    auto pgm = P4::parseP4String(program, CompilerOptions::FrontendVersion::P4_16);
+    ASSERT_TRUE(pgm != nullptr && ::errorCount() == 0);
+
+    // Both declarations are in the index, so the reference is ambiguous.
+    ReferenceMap refMap;
+    pgm->apply(ResolveReferences(&refMap));
+    EXPECT_NE(0u, ::errorCount());
+}
+
+TEST_F(P4CResolveReferences, largeProgram) {
+    // Every reference to a constant is resolved in the program scope,
+    // which holds all the declarations.
+    const int declarations = 2000;
+    std::stringstream source;
+    for (int i = 0; i < declarations; i++)
+        source << "const bit<32> c" << i << " = " << i << ";\n";
+    source << "control ctrl(out bit<32> x) { apply {\n";
+    for (int i = declarations - 1; i >= 0; i--)
+        source << "    x = c" << i << ";\n";
+    source << "} }\n";
+    auto pgm = P4::parseP4String(source.str(), CompilerOptions::FrontendVersion::P4_16);
+    ASSERT_TRUE(pgm != nullptr && ::errorCount() == 0);
+
+    ReferenceMap refMap;
+    pgm->apply(ResolveReferences(&refMap));
+    ASSERT_EQ(0u, ::errorCount());
+
+    int next = declarations - 1;
+    forAllMatching<IR::PathExpression>(pgm, [&](const IR::PathExpression* path) {
+        if (path->path->name == "x")
+            return;
+        ASSERT_LE(0, next);
+        EXPECT_EQ(pgm->objects.at(next), refMap.getDeclaration(path->path, true)->getNode());
+        next--;
+    });
+    EXPECT_EQ(-1, next);
+}
+
+}  // namespace Test
@@ -0,0 +1,120 @@
+/*
+Copyright 2013-present Barefoot Networks, Inc.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "helpers.h"
+#include "ir/ir.h"
+#include "lib/sourceCodeBuilder.h"
+
+#include "frontends/common/parseInput.h"
+#include "frontends/p4/toP4/toP4.h"
+
+using namespace P4;
+
+namespace Test {
+
+static std::string readFile(const std::string& name) {
+    std::ifstream file(name);
+    std::stringstream contents;
+    contents << file.rdbuf();
+    return contents.str();
+}
+
+TEST(UtilSourceCodeBuilder, chunks) {
+    Util::SourceCodeBuilder builder;
+    std::string expected;
+    builder.increaseIndent();
+    // enough text for several chunks, with some appends longer than a chunk
+    for (int i = 0; i < 20000; i++) {
+        builder.emitIndent();
+        builder.appendFormat("x%d = %s;", i, i % 1000 ? "y" : std::string(70000, 'z').c_str());
+        builder.newline();
+        expected += "    x" + std::to_string(i) + " = " +
+                    (i % 1000 ? "y" : std::string(70000, 'z')) + ";\n";
+    }
+    EXPECT_TRUE(builder.lastIsSpace());
+    EXPECT_EQ(expected.size(), builder.size());
+    EXPECT_EQ(expected, builder.toString());
+
+    std::stringstream stream;
+    builder.writeTo(stream);
+    EXPECT_EQ(expected, stream.str());
+
+    char name[] = "/tmp/p4c-scb-XXXXXX";
+    int fd = mkstemp(name);
+    ASSERT_LE(0, fd);
+    close(fd);
+    EXPECT_TRUE(builder.writeToFile(name));
+    EXPECT_EQ(expected, readFile(name));
+    unlink(name);
+
+    EXPECT_EQ(expected, builder.release());
+    EXPECT_EQ(0u, builder.size());
+    builder.appendFormat("%s", "a");
+    EXPECT_FALSE(builder.lastIsSpace());
+    EXPECT_EQ("a", builder.toString());
+}
+
+class P4CToP4 : public P4CTest { };
+
+TEST_F(P4CToP4, largeProgram) {
+    // A large program: many controls, each with actions and a table
+    const int controls = 400;
+    std::stringstream source;
+    source << "header h_t { bit<8> f; bit<16> g; }\n";
+    for (int i = 0; i < controls; i++) {
+        source << "control c" << i << "(inout h_t h) {\n"
+               << "    action a(bit<8> v) { h.f = v + " << i << "; h.g = h.g << 1; }\n"
+               << "    action b() { h.setInvalid(); }\n"
+               << "    table t { key = { h.f : exact; h.g : ternary; }\n"
+               << "              actions = { a; b; } default_action = b(); }\n"
+               << "    apply { if (h.isValid()) { t.apply(); } else { h.f = h.f - 1; } }\n"
+               << "}\n";
+    }
+    auto program = parseP4String(source.str(), CompilerOptions::FrontendVersion::P4_16);
+    ASSERT_TRUE(program);
+    ASSERT_EQ(0u, ::errorCount());
+
+    char name[] = "/tmp/p4c-top4-XXXXXX";
+    int fd = mkstemp(name);
+    ASSERT_LE(0, fd);
+    close(fd);
+
+    {
+        std::ofstream stream(name);
+        ToP4 toP4(&stream, false);
+        program->apply(toP4);
+    }
+    auto streamed = readFile(name);
+
+    // The same text written directly from a builder
+    Util::SourceCodeBuilder builder;
+    ToP4 toP4(builder, false);
+    program->apply(toP4);
+    ASSERT_TRUE(builder.writeToFile(name));
+    EXPECT_EQ(streamed, readFile(name));
+    EXPECT_EQ(streamed.size(), builder.size());
+    unlink(name);
+}
+
+}  // namespace Test
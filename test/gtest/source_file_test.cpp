@@ -14,7 +14,10 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 
+#include <string>
+
 #include "gtest/gtest.h"
+#include "lib/bufferstream.h"
 #include "lib/cstring.h"
 #include "lib/exceptions.h"
 #include "lib/source_file.h"
@@ -97,4 +100,18 @@ TEST(UtilSourceFile, SourceInfo) {
     EXPECT_FALSE(invalid.isValid());
 }
 
+TEST(UtilSourceFile, BufferInputStream) {
+    std::string first = "control c";
+    std::string second = "() {}\n";
+    BufferInputStream stream({ first, std::string_view(), second });
+    EXPECT_EQ(15, stream.rdbuf()->in_avail());
+
+    std::string word, rest;
+    stream >> word;
+    EXPECT_EQ("control", word);
+    std::getline(stream, rest);
+    EXPECT_EQ(" c() {}", rest);
+    EXPECT_EQ(std::char_traits<char>::eof(), stream.get());
+}
+
 }  // namespace Util
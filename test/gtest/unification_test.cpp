@@ -0,0 +1,159 @@
+/*
+Copyright 2013-present Barefoot Networks, Inc.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <sstream>
+
+#include "gtest/gtest.h"
+#include "ir/ir.h"
+#include "helpers.h"
+#include "lib/log.h"
+
+#include "frontends/common/parseInput.h"
+#include "frontends/common/resolveReferences/referenceMap.h"
+#include "frontends/p4/typeChecking/typeChecker.h"
+#include "frontends/p4/typeChecking/typeSubstitution.h"
+#include "frontends/p4/typeMap.h"
+
+using namespace P4;
+
+namespace Test {
+
+class P4CUnification : public P4CTest { };
+
+TEST_F(P4CUnification, chainsOfVariables) {
+    auto t0 = new IR::Type_Var(IR::ID("T0"));
+    auto t1 = new IR::Type_Var(IR::ID("T1"));
+    auto t2 = new IR::Type_Var(IR::ID("T2"));
+    auto bit8 = IR::Type_Bits::get(8);
+    auto tuple = new IR::Type_Tuple(IR::Vector<IR::Type>({ t1, t2 }));
+
+    TypeVariableSubstitution tvs;
+    EXPECT_EQ("", tvs.compose(t0, tuple));
+    EXPECT_EQ("", tvs.compose(t1, t2));
+    EXPECT_EQ("", tvs.compose(t2, bit8));
+    EXPECT_EQ(bit8, tvs.lookup(t1));
+    EXPECT_EQ(bit8, tvs.lookup(t2));
+
+    auto resolved = tvs.lookup(t0)->to<IR::Type_Tuple>();
+    ASSERT_NE(nullptr, resolved);
+    EXPECT_EQ(bit8, resolved->components.at(0));
+    EXPECT_EQ(bit8, resolved->components.at(1));
+
+    // Binding a variable to a type that contains it after substitution fails.
+    auto t3 = new IR::Type_Var(IR::ID("T3"));
+    auto t4 = new IR::Type_Var(IR::ID("T4"));
+    EXPECT_EQ("", tvs.compose(t3, new IR::Type_Tuple(IR::Vector<IR::Type>({ t4 }))));
+    EXPECT_NE("", tvs.compose(t4, new IR::Type_Tuple(IR::Vector<IR::Type>({ t3 }))));
+}
+
+TEST_F(P4CUnification, explainError) {
+    std::string program = P4_SOURCE(P4Headers::CORE, R"(
+        extern E<T> { E(); void set(in T data); }
+        control c() {
+            E<bit<8>>() e;
+            apply { e.set(true); }
+        }
+    )");
+    auto pgm = P4::parseP4String(program, CompilerOptions::FrontendVersion::P4_16);
+    ASSERT_TRUE(pgm != nullptr && ::errorCount() == 0);
+
+    std::stringstream errors;
+    auto& reporter = BaseCompileContext::get().errorReporter();
+    auto saved = reporter.getOutputStream();
+    reporter.setOutputStream(&errors);
+    ReferenceMap refMap;
+    TypeMap typeMap;
+    pgm->apply(TypeChecking(&refMap, &typeMap));
+    reporter.setOutputStream(saved);
+
+    EXPECT_NE(0u, ::errorCount());
+    EXPECT_NE(std::string::npos, errors.str().find("---- Actual error"));
+}
+
+TEST_F(P4CUnification, composedThroughBase) {
+    auto t0 = new IR::Type_Var(IR::ID("T0"));
+    auto t1 = new IR::Type_Var(IR::ID("T1"));
+    auto t2 = new IR::Type_Var(IR::ID("T2"));
+    auto bit8 = IR::Type_Bits::get(8);
+
+    TypeVariableSubstitution tvs;
+    EXPECT_EQ("", tvs.compose(t0, new IR::Type_Tuple(IR::Vector<IR::Type>({ t1 }))));
+    EXPECT_EQ("", tvs.compose(t1, t2));
+    EXPECT_EQ("", tvs.compose(t2, bit8));
+
+    // Accesses through the base class see the resolved bindings.
+    const TypeSubstitution<const IR::ITypeVar*>& base = tvs;
+    EXPECT_EQ(bit8, base.lookup(t1));
+    EXPECT_EQ(bit8, base.get(t2));
+    auto tuple = base.get(t0)->to<IR::Type_Tuple>();
+    ASSERT_NE(nullptr, tuple);
+    EXPECT_EQ(bit8, tuple->components.at(0));
+
+    // Copies are resolved the same way.
+    TypeVariableSubstitution other;
+    other.simpleCompose(&tvs);
+    EXPECT_EQ(bit8, other.lookup(t1));
+    tuple = other.lookup(t0)->to<IR::Type_Tuple>();
+    ASSERT_NE(nullptr, tuple);
+    EXPECT_EQ(bit8, tuple->components.at(0));
+
+    TypeSubstitution<const IR::ITypeVar*>& mutableBase = tvs;
+    mutableBase.clear();
+    EXPECT_TRUE(tvs.isIdentity());
+    EXPECT_EQ(nullptr, tvs.lookup(t0));
+    // New bindings are not mixed with values resolved before clearing.
+    EXPECT_EQ("", tvs.compose(t1, IR::Type_Bits::get(16)));
+    EXPECT_EQ(IR::Type_Bits::get(16), tvs.lookup(t1));
+}
+
+TEST_F(P4CUnification, genericExternCalls) {
+    // Each call of a generic extern method is a unification problem
+    // with several type variables bound to each other.
+    std::string program = P4_SOURCE(P4Headers::CORE, R"(
+        struct S<T> { T f; tuple<T, bit<8>> g; }
+        extern R<K, V> { R(bit<32> size); V read<I>(in K key, in I index); }
+        control c(inout bit<16> x, out bit<8> y) {
+            R<bit<16>, S<bit<16>>>(1) r0;
+            R<bit<8>, S<bit<8>>>(2) r1;
+            apply {
+                x = r0.read(x, 0w32).f;
+                y = r1.read(y, 1w1).g[1];
+            }
+        }
+    )");
+    auto pgm = P4::parseP4String(program, CompilerOptions::FrontendVersion::P4_16);
+    ASSERT_TRUE(pgm != nullptr && ::errorCount() == 0);
+
+    ReferenceMap refMap;
+    TypeMap typeMap;
+    pgm = pgm->apply(TypeChecking(&refMap, &typeMap));
+    ASSERT_TRUE(pgm != nullptr && ::errorCount() == 0);
+
+    unsigned calls = 0;
+    forAllMatching<IR::MethodCallExpression>(pgm, [&](const IR::MethodCallExpression* call) {
+        auto type = typeMap.getType(call)->to<IR::Type_StructLike>();
+        ASSERT_NE(nullptr, type);
+        auto f = type->getField("f");
+        ASSERT_NE(nullptr, f);
+        auto bits = f->type->to<IR::Type_Bits>();
+        ASSERT_NE(nullptr, bits);
+        EXPECT_EQ(calls == 0 ? 16 : 8, bits->size);
+        calls++;
+    });
+    EXPECT_EQ(2u, calls);
+}
+
+}  // namespace Test
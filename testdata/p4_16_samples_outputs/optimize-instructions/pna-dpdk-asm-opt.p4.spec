@@ -0,0 +1,83 @@
+
+struct ethernet_t {
+	bit<48> dstAddr
+	bit<48> srcAddr
+	bit<16> etherType
+}
+
+struct ipv4_t {
+	bit<8> version_ihl
+	bit<8> diffserv
+	bit<16> totalLen
+	bit<16> identification
+	bit<16> flags_fragOffset
+	bit<8> ttl
+	bit<8> protocol
+	bit<16> hdrChecksum
+	bit<32> srcAddr
+	bit<32> dstAddr
+}
+
+struct set_src_arg_t {
+	bit<32> v
+}
+
+struct main_metadata_t {
+	bit<32> pna_main_input_metadata_input_port
+	bit<32> local_metadata_b
+	bit<32> local_metadata_c
+	bit<32> pna_main_output_metadata_output_port
+}
+metadata instanceof main_metadata_t
+
+header ethernet instanceof ethernet_t
+header ipv4 instanceof ipv4_t
+
+regarray direction size 0x100 initval 0
+
+action set_src args instanceof set_src_arg_t {
+	mov m.local_metadata_b t.v
+	mov m.local_metadata_c t.v
+	mov h.ipv4.srcAddr t.v
+	return
+}
+
+action drop args none {
+	drop
+	return
+}
+
+table src {
+	key {
+		h.ipv4.dstAddr exact
+	}
+	actions {
+		set_src
+		drop
+	}
+	default_action drop args none const
+	size 0x10000
+}
+
+
+apply {
+	rx m.pna_main_input_metadata_input_port
+	extract h.ethernet
+	jmpneq MAINPARSERIMPL_ACCEPT h.ethernet.etherType 0x800
+	extract h.ipv4
+	MAINPARSERIMPL_ACCEPT :	mov m.local_metadata_c 0x0
+	jmpnv LABEL_END h.ipv4
+	jmpneq LABEL_FALSE_0 h.ipv4.dstAddr 0xa000001
+	mov m.local_metadata_c h.ipv4.dstAddr
+	jmp LABEL_END
+	LABEL_FALSE_0 :	jmpneq LABEL_FALSE_1 h.ipv4.ttl 0x0
+	drop
+	jmp LABEL_END
+	LABEL_FALSE_1 :	table src
+	LABEL_END :	mov h.ipv4.dstAddr m.local_metadata_c
+	emit h.ethernet
+	emit h.ipv4
+	tx m.pna_main_output_metadata_output_port
+}
+
+
@@ -42,6 +42,7 @@ export P4C_RUNTIME_DEPS="cpp \
 
 # use scapy 2.4.5, which is the version on which ptf depends
 export P4C_PIP_PACKAGES="ipaddr \
+                          jsonschema \
                           pyroute2 \
                           ply==3.8 \
                           scapy==2.4.5"
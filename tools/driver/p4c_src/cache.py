@@ -0,0 +1,317 @@
+# Copyright 2013-present Barefoot Networks, Inc.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#    http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""
+A cache of compiler results, in the manner of ccache.
+
+The key of an entry is a hash of the preprocessed program, of the compiler
+binary (path, size and modification time) and of the full command line of
+the compiler.  An entry holds the files that the compiler wrote (e.g. the
+bmv2 JSON, the DPDK spec and context JSON, the P4Info files, the eBPF C
+sources) and what it printed, so that a hit restores the outputs without
+running the compiler.  Only successful compilations are stored.
+
+Entries are directories under <cache dir>/objects; the least recently used
+ones are evicted when the cache grows over its size limit.  Several
+drivers may share a cache directory: entries are created atomically and
+the statistics are updated under a lock.
+"""
+
+import fcntl
+import hashlib
+import json
+import os
+import shlex
+import shutil
+import sys
+import tempfile
+import time
+
+CACHE_VERSION = "1"
+
+# Compiler options whose value names an output file (or a comma-separated
+# list of output files).  Files written in the output directory are found
+# without them.
+OUTPUT_OPTIONS = ("-o", "--p4runtime-file", "--p4runtime-files", "--bf-rt-schema",
+                  "--context", "--toJSON", "--pp")
+
+# Compiler options whose outputs cannot be stored: dump folders and logs.
+UNCACHEABLE_OPTIONS = ("--dump", "--top4", "-v", "-vv", "-vvv")
+
+SIZE_SUFFIXES = {"K": 1 << 10, "M": 1 << 20, "G": 1 << 30, "T": 1 << 40}
+
+
+def parse_size(text):
+    """Parses a size such as 500M or 5G; returns the number of bytes."""
+    text = text.strip().upper()
+    if text and text[-1] in SIZE_SUFFIXES:
+        return int(float(text[:-1]) * SIZE_SUFFIXES[text[-1]])
+    return int(text)
+
+
+def format_size(size):
+    for suffix in ("T", "G", "M", "K"):
+        if size >= SIZE_SUFFIXES[suffix]:
+            return "{:.1f}{}".format(size / SIZE_SUFFIXES[suffix], suffix)
+    return str(size)
+
+
+def _file_state(path):
+    try:
+        st = os.stat(path)
+    except OSError:
+        return None
+    return (st.st_size, st.st_mtime_ns)
+
+
+def _dir_size(path):
+    size = 0
+    for root, dirs, files in os.walk(path):
+        for f in files:
+            try:
+                size += os.lstat(os.path.join(root, f)).st_size
+            except OSError:
+                pass
+    return size
+
+
+class CompileCache:
+    def __init__(self, directory, max_size, verbose=False):
+        self._dir = directory
+        self._objects = os.path.join(directory, "objects")
+        self._max_size = max_size
+        self._verbose = verbose
+        os.makedirs(self._objects, exist_ok=True)
+
+    # statistics, kept in <cache dir>/stats.json
+
+    def _locked(self):
+        """Returns a file object holding the lock of the cache directory."""
+        lock = open(os.path.join(self._dir, "lock"), "a")
+        fcntl.flock(lock, fcntl.LOCK_EX)
+        return lock
+
+    def _read_stats(self):
+        stats = {"hits": 0, "misses": 0, "stored": 0, "evicted": 0, "size": 0}
+        try:
+            with open(os.path.join(self._dir, "stats.json")) as f:
+                stats.update(json.load(f))
+        except (OSError, ValueError):
+            pass
+        return stats
+
+    def _write_stats(self, stats):
+        path = os.path.join(self._dir, "stats.json")
+        with open(path + ".tmp", "w") as f:
+            json.dump(stats, f)
+        os.replace(path + ".tmp", path)
+
+    def _update_stats(self, **deltas):
+        with self._locked():
+            stats = self._read_stats()
+            for name, delta in deltas.items():
+                stats[name] += delta
+            self._write_stats(stats)
+            return stats
+
+    def _entries(self):
+        """Yields (path, last use, size) for every entry."""
+        for prefix in os.listdir(self._objects):
+            prefix_dir = os.path.join(self._objects, prefix)
+            for key in os.listdir(prefix_dir):
+                entry = os.path.join(prefix_dir, key)
+                manifest = _file_state(os.path.join(entry, "manifest.json"))
+                if manifest is not None:
+                    yield entry, manifest[1], _dir_size(entry)
+
+    def print_stats(self):
+        stats = self._read_stats()
+        entries = list(self._entries())
+        size = sum(e[2] for e in entries)
+        lookups = stats["hits"] + stats["misses"]
+        print("cache directory        {}".format(self._dir))
+        print("cache hits             {}".format(stats["hits"]))
+        print("cache misses           {}".format(stats["misses"]))
+        if lookups > 0:
+            print("hit rate               {:.1f}%".format(100.0 * stats["hits"] / lookups))
+        print("results stored         {}".format(stats["stored"]))
+        print("results evicted        {}".format(stats["evicted"]))
+        print("entries                {}".format(len(entries)))
+        print("cache size             {} of {}".format(format_size(size),
+                                                       format_size(self._max_size)))
+
+    def clear(self):
+        with self._locked():
+            shutil.rmtree(self._objects, ignore_errors=True)
+            os.makedirs(self._objects, exist_ok=True)
+            self._write_stats({"hits": 0, "misses": 0, "stored": 0, "evicted": 0,
+                               "size": 0})
+
+    def _evict(self):
+        """Removes the least recently used entries until the cache fits in
+        its size limit."""
+        with self._locked():
+            entries = sorted(self._entries(), key=lambda e: e[1])
+            size = sum(e[2] for e in entries)
+            evicted = 0
+            while entries and size > self._max_size:
+                path, _, entry_size = entries.pop(0)
+                shutil.rmtree(path, ignore_errors=True)
+                size -= entry_size
+                evicted += 1
+            stats = self._read_stats()
+            stats["evicted"] += evicted
+            stats["size"] = size
+            self._write_stats(stats)
+        if self._verbose and evicted:
+            print("cache: evicted {} entries".format(evicted))
+
+    # lookups
+
+    def key(self, args, inputs):
+        """The key of compiling inputs (the preprocessed program) with the
+        command line args; None if the result cannot be cached."""
+        if any(a in UNCACHEABLE_OPTIONS or a.split("=")[0] in UNCACHEABLE_OPTIONS
+               for a in args[1:]):
+            return None
+        compiler = shutil.which(args[0]) or args[0]
+        compiler = os.path.realpath(compiler)
+        state = _file_state(compiler)
+        if state is None:
+            return None
+        h = hashlib.sha256()
+        h.update("p4c-cache-{}\0{}\0{}\0".format(CACHE_VERSION, compiler, state).encode())
+        for a in args[1:]:
+            h.update(os.fsencode(a) + b"\0")
+        for path in inputs:
+            h.update(os.fsencode(path) + b"\0")
+            try:
+                with open(path, "rb") as f:
+                    for block in iter(lambda: f.read(1 << 20), b""):
+                        h.update(block)
+            except OSError:
+                return None
+        return h.hexdigest()
+
+    def _entry(self, key):
+        return os.path.join(self._objects, key[:2], key)
+
+    def _restore(self, key):
+        """Writes the outputs of the entry key; returns False if there is
+        no such entry."""
+        entry = self._entry(key)
+        manifest_path = os.path.join(entry, "manifest.json")
+        try:
+            with open(manifest_path) as f:
+                manifest = json.load(f)
+            for index, path in enumerate(manifest["outputs"]):
+                directory = os.path.dirname(path)
+                if directory:
+                    os.makedirs(directory, exist_ok=True)
+                shutil.copyfile(os.path.join(entry, str(index)), path)
+            os.utime(manifest_path)  # for the LRU order
+        except (OSError, ValueError, KeyError):
+            return False
+        sys.stdout.write(manifest.get("stdout", ""))
+        sys.stderr.write(manifest.get("stderr", ""))
+        return True
+
+    def _store(self, key, outputs, stdout, stderr):
+        entry = self._entry(key)
+        os.makedirs(os.path.dirname(entry), exist_ok=True)
+        tmp = tempfile.mkdtemp(dir=os.path.dirname(entry))
+        try:
+            for index, path in enumerate(outputs):
+                shutil.copyfile(path, os.path.join(tmp, str(index)))
+            with open(os.path.join(tmp, "manifest.json"), "w") as f:
+                json.dump({"outputs": outputs, "stdout": stdout, "stderr": stderr,
+                           "time": time.time()}, f)
+            os.rename(tmp, entry)
+        except OSError:
+            # another driver stored the same entry first
+            shutil.rmtree(tmp, ignore_errors=True)
+            return False
+        return True
+
+    def _candidate_outputs(self, args, output_directory):
+        """The files that the compiler may write."""
+        candidates = set()
+        if os.path.isdir(output_directory):
+            for f in os.listdir(output_directory):
+                candidates.add(os.path.join(output_directory, f))
+        for i, a in enumerate(args[1:], 1):
+            name, eq, value = a.partition("=")
+            if name not in OUTPUT_OPTIONS:
+                continue
+            if not eq:
+                if i + 1 >= len(args):
+                    continue
+                value = args[i + 1]
+            candidates.update(v for v in value.split(",") if v)
+        return candidates
+
+    def run(self, driver, step, cmd, inputs, output_directory):
+        """Runs the compiler command cmd of driver, or restores its outputs
+        from the cache; returns the exit code."""
+        args = shlex.split(" ".join(cmd))
+        key = self.key(args, inputs)
+        if key is None:
+            return driver.runCmd(step, cmd)
+        if self._restore(key):
+            self._update_stats(hits=1)
+            if self._verbose:
+                print("cache: hit {}".format(key))
+            return 0
+        self._update_stats(misses=1)
+        if self._verbose:
+            print("cache: miss {}".format(key))
+
+        candidates = self._candidate_outputs(args, output_directory)
+        before = {c: _file_state(c) for c in candidates}
+        # Run with the standard output and error redirected to files, so
+        # that the messages are stored with the outputs; this also captures
+        # the output of a compile server, which writes to our descriptors.
+        with tempfile.TemporaryFile() as out, tempfile.TemporaryFile() as err:
+            sys.stdout.flush()
+            sys.stderr.flush()
+            saved = (os.dup(1), os.dup(2))
+            os.dup2(out.fileno(), 1)
+            os.dup2(err.fileno(), 2)
+            try:
+                rc = driver.runCmd(step, cmd)
+            finally:
+                sys.stdout.flush()
+                sys.stderr.flush()
+                os.dup2(saved[0], 1)
+                os.dup2(saved[1], 2)
+                os.close(saved[0])
+                os.close(saved[1])
+            out.seek(0)
+            err.seek(0)
+            stdout = out.read().decode(errors="replace")
+            stderr = err.read().decode(errors="replace")
+        sys.stdout.write(stdout)
+        sys.stderr.write(stderr)
+        if rc != 0:
+            return rc
+
+        inputs = set(os.path.realpath(i) for i in inputs)
+        outputs = sorted(c for c in candidates
+                         if os.path.isfile(c) and os.path.realpath(c) not in inputs
+                         and _file_state(c) != before[c])
+        if self._store(key, outputs, stdout, stderr):
+            stats = self._update_stats(stored=1, size=_dir_size(self._entry(key)))
+            if stats["size"] > self._max_size:
+                self._evict()
+        return rc
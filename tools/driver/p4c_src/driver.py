@@ -19,6 +19,7 @@ import sys
 import traceback
 
 import p4c_src.util as util
+from p4c_src.cache import CompileCache
 
 class BackendDriver:
     """A class that has a list of passes that need to be run.  Each
@@ -50,6 +51,7 @@ class BackendDriver:
         self._source_basename = None
         self._verbose = False
         self._run_preprocessor_only = False
+        self._cache = None
 
     def __str__(self):
         return self._backend
@@ -89,6 +91,8 @@ class BackendDriver:
         self._source_filename = opts.source_file
         self._source_basename = os.path.splitext(os.path.basename(opts.source_file))[0]
         self._run_preprocessor_only = opts.run_preprocessor_only
+        if opts.cache_dir and not opts.dry_run:
+            self._cache = CompileCache(opts.cache_dir, opts.cache_max_size, opts.debug)
 
         # set preprocessor options
         if 'preprocessor' in self._commands:
@@ -245,6 +249,17 @@ class BackendDriver:
             return 0
 
         args = shlex.split(" ".join(cmd))
+        server = util.find_compile_server(args[0])
+        if server is not None:
+            if self._verbose: print('running {} on {}'.format(' '.join(cmd), server))
+            # Closing the connection on CTRL+C interrupts the compilation
+            try:
+                rc = util.run_on_compile_server(server, args)
+            except KeyboardInterrupt:
+                return 130
+            if rc is not None:
+                return rc
+
         try:
             p = subprocess.Popen(args)
         except:
@@ -280,6 +295,32 @@ class BackendDriver:
         return p.returncode
 
 
+    def preprocessed_files(self, cmd_name):
+        """
+        Returns the files written by the preprocessor that cmd_name reads,
+        or None if cmd_name does not run after the preprocessor.
+        The compiler results are cached only in that case: otherwise the
+        compiler reads include files which are not part of the cache key.
+        """
+        if 'preprocessor' not in self._commandsEnabled or \
+           self._commandsEnabled.index('preprocessor') > self._commandsEnabled.index(cmd_name):
+            return None
+        args = shlex.split(" ".join(self._commands['preprocessor']))
+        if '-o' not in args[:-1]:
+            return None
+        return [args[args.index('-o') + 1]]
+
+    def runCmdCached(self, cmd_name, cmd):
+        """
+        Runs the compiler through the compile cache, if there is one
+        """
+        if self._cache is None or cmd_name != 'compiler':
+            return self.runCmd(cmd_name, cmd)
+        inputs = self.preprocessed_files(cmd_name)
+        if inputs is None:
+            return self.runCmd(cmd_name, cmd)
+        return self._cache.run(self, cmd_name, cmd, inputs, self._output_directory)
+
     def preRun(self, cmd_name):
         """
         Preamble to a command to setup anything needed
@@ -328,7 +369,7 @@ class BackendDriver:
                 print("{}: command not found".format(cmd[0]), file=sys.stderr)
                 sys.exit(1)
 
-            rc = self.runCmd(c, cmd)
+            rc = self.runCmdCached(c, cmd)
 
             # run the cleanup whether the command succeeded or failed
             postrc = self.postRun(c)
@@ -25,7 +25,9 @@ import os
 import sys
 import re
 
+import p4c_src.cache as cache
 import p4c_src.config as config
+import p4c_src.multi as multi
 import p4c_src
 
 # \TODO: let the backends set their versions ...
@@ -41,6 +43,15 @@ def get_version():
     return p4c_version
 
 
+def find_backend(cfg, target, arch):
+    for backend in cfg.target:
+        regex = backend._backend.replace('*', '[a-zA-Z0-9*]*')
+        pattern = re.compile(regex)
+        if (pattern.match(target + '-' + arch)):
+            return backend
+    return None
+
+
 def display_supported_targets(cfg):
     ret = "Supported targets in \"target, arch\" tuple:\n"
     for target in cfg.target:
@@ -240,6 +251,39 @@ def main():
                              "invocations of the same subparser instance.",
                         action="store_true", default=False)
 
+    parser.add_argument("--multi-target", dest="multi_target",
+                        metavar="TARGET-ARCH[,TARGET-ARCH...]",
+                        help="Compile for several backends in one invocation,"
+                             " e.g. bmv2-v1model,ebpf-v1model; the outputs of"
+                             " each backend are written in a subdirectory"
+                             " of the output path named after it.  The front"
+                             " end runs once for the backends that share a"
+                             " preprocessed program, and the backends run in"
+                             " parallel.",
+                        action="store", default=None)
+    parser.add_argument("--cache-dir", dest="cache_dir",
+                        help="Cache the compiler outputs in the given"
+                             " directory and reuse them when the same"
+                             " preprocessed program is compiled again with"
+                             " the same compiler and options (default:"
+                             " $P4C_CACHE_DIR; no cache if unset).",
+                        action="store",
+                        default=os.environ.get('P4C_CACHE_DIR'))
+    parser.add_argument("--cache-max-size", dest="cache_max_size",
+                        help="Size limit of the compile cache, e.g. 500M or"
+                             " 5G; least recently used results are evicted"
+                             " (default: $P4C_CACHE_MAX_SIZE or 5G).",
+                        action="store",
+                        default=os.environ.get('P4C_CACHE_MAX_SIZE', "5G"))
+    parser.add_argument("--cache-stats", dest="show_cache_stats",
+                        help="Show the statistics of the compile cache"
+                             " and exit.",
+                        action="store_true", default=False)
+    parser.add_argument("--clear-cache", dest="clear_cache",
+                        help="Remove all results from the compile cache"
+                             " and exit.",
+                        action="store_true", default=False)
+
     ### DRYified “env_indicates_developer_build”
     env_indicates_developer_build = os.environ['P4C_BUILD_TYPE'] == "DEVELOPER"
     if env_indicates_developer_build:
@@ -334,6 +378,20 @@ def main():
         print(display_supported_targets(cfg))
         sys.exit(0)
 
+    try:
+        opts.cache_max_size = cache.parse_size(opts.cache_max_size)
+    except ValueError:
+        parser.error("Invalid cache size: {}".format(opts.cache_max_size))
+    if opts.show_cache_stats or opts.clear_cache:
+        if not opts.cache_dir:
+            parser.error("no cache directory: use --cache-dir or set P4C_CACHE_DIR")
+        compile_cache = cache.CompileCache(opts.cache_dir, opts.cache_max_size)
+        if opts.clear_cache:
+            compile_cache.clear()
+        if opts.show_cache_stats:
+            compile_cache.print_stats()
+        sys.exit(0)
+
     # check that the tuple value is correct
     backend = (opts.target, opts.arch)
     if (len(backend) != 2):
@@ -341,16 +399,23 @@ def main():
                      format(backend, display_supported_targets(cfg)))
 
     # find the backend
-    backend = None
-    for target in cfg.target:
-        regex = target._backend.replace('*', '[a-zA-Z0-9*]*')
-        pattern = re.compile(regex)
-        if (pattern.match(opts.target + '-' + opts.arch)):
-            backend = target
-            break
+    backend = find_backend(cfg, opts.target, opts.arch)
     if backend is None:
         parser.error("Unknown backend: {}-{}".format(str(opts.target),
                                                      str(opts.arch)))
+
+    # find the backends of a multi-target compilation
+    multi_backends = []
+    if opts.multi_target:
+        for pair in opts.multi_target.split(','):
+            target, _, arch = pair.partition('-')
+            b = find_backend(cfg, target, arch) if arch else None
+            if b is None:
+                parser.error("Unknown backend: {}\n{}".
+                             format(pair, display_supported_targets(cfg)))
+            if b not in multi_backends:
+                multi_backends.append(b)
+        backend = multi_backends[0]
     error_count = 0
 
     JSON_input_specified = env_indicates_developer_build and opts.json_source
@@ -495,6 +560,9 @@ def main():
 
 
 
+    if multi_backends:
+        sys.exit(multi.run(multi_backends, opts))
+
     # set all configuration and command line options for backend
     backend.process_command_line_options(opts)
 
@@ -0,0 +1,191 @@
+# Copyright 2013-present Barefoot Networks, Inc.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#    http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""
+Compiles a program for several backends in one invocation (--multi-target).
+
+Every backend preprocesses the program into its own output directory.  The
+backends whose preprocessed programs and front end options are identical
+share one front end run: p4test runs the front end once and writes an IR
+snapshot (--toIRSnapshot), and each of these backends then starts from the
+snapshot (--fromJSON) instead of the preprocessed program, running only its
+mid end and emitter.  The backends run in parallel, in separate processes:
+the compiler is not thread safe, and each backend sees the front end
+output as its own.
+"""
+
+import copy
+import hashlib
+import os
+import shlex
+import sys
+import time
+
+# Compiler options that change the front end output, with their number of
+# arguments; these are passed to the front end run.
+FRONTEND_OPTIONS = {"-I": 1, "-D": 1, "-U": 1, "--p4v": 1, "--std": 1,
+                    "--disable-annotations": 1, "--parser-inline-opt": 0,
+                    "--parse-annotations-on-demand": 0, "--Wdisable": 1, "--Wwarn": 1,
+                    "--Werror": 1, "--maxErrorCount": 1, "--excludeFrontendPasses": 1}
+
+# Compiler options that name a file which all the backends would write; only
+# the first backend of a group writes it.
+SHARED_OUTPUT_OPTIONS = ("--p4runtime-file", "--p4runtime-files", "--p4runtime-format",
+                         "--p4runtime-entries-file", "--p4runtime-entries-files")
+
+
+def _split(cmd):
+    return shlex.split(" ".join(cmd))
+
+
+def _options(args, known):
+    """Returns the options of args that are in known (a dict from option to
+    its number of arguments), with their arguments."""
+    selected = []
+    i = 1
+    while i < len(args):
+        name, eq, _ = args[i].partition("=")
+        count = 0 if eq else known.get(name, 0)
+        if name in known:
+            selected += args[i:i + 1 + count]
+        i += 1 + count
+    return selected
+
+
+def _without_options(args, options):
+    rest = []
+    i = 0
+    while i < len(args):
+        name, eq, _ = args[i].partition("=")
+        if name in options:
+            i += 1 if eq else 2
+            continue
+        rest.append(args[i])
+        i += 1
+    return rest
+
+
+class Member:
+    """A backend compiling the program as part of a multi-target run."""
+
+    def __init__(self, backend):
+        self.backend = backend
+        self.preprocessed = None  # the file written by its preprocessor
+        self.time = None
+
+
+def run(backends, opts):
+    """Compiles the program for each backend in backends, with the command
+    line options opts; returns the exit code."""
+    members = []
+    output_directory = opts.output_directory
+    for backend in backends:
+        member_opts = copy.copy(opts)
+        member_opts.output_directory = os.path.join(output_directory, str(backend))
+        backend.process_command_line_options(member_opts)
+        if not os.path.exists(backend._output_directory) and not opts.dry_run:
+            os.makedirs(backend._output_directory)
+        members.append(Member(backend))
+
+    # Preprocess for every backend, and group the backends whose front end
+    # input is the same.
+    groups = {}
+    for m in members:
+        enabled = m.backend._commandsEnabled
+        if enabled[:2] != ['preprocessor', 'compiler'] or opts.dry_run:
+            groups[id(m)] = [m]
+            continue
+        m.preprocessed = m.backend.preprocessed_files('compiler')
+        if m.preprocessed is None:
+            groups[id(m)] = [m]
+            continue
+        rc = m.backend.runCmd('preprocessor', m.backend._commands['preprocessor'])
+        if rc != 0:
+            return rc
+        m.backend.disable_commands(['preprocessor'])
+        args = _split(m.backend._commands['compiler'])
+        h = hashlib.sha256()
+        for a in _options(args, FRONTEND_OPTIONS):
+            h.update(os.fsencode(a) + b"\0")
+        with open(m.preprocessed[0], "rb") as f:
+            h.update(f.read())
+        groups.setdefault(h.hexdigest(), []).append(m)
+
+    frontend = os.path.join(os.environ['P4C_BIN_DIR'], 'p4test')
+    for group in groups.values():
+        if len(group) < 2 or group[0].preprocessed is None:
+            continue
+        if not os.access(frontend, os.X_OK):
+            break
+        rc = _run_frontend(frontend, group)
+        if rc != 0:
+            return rc
+
+    # Run the backends in parallel, one process each.
+    start = time.time()
+    children = {}
+    for m in members:
+        sys.stdout.flush()
+        sys.stderr.flush()
+        pid = os.fork()
+        if pid == 0:
+            rc = 1
+            try:
+                rc = m.backend.run()
+            finally:
+                sys.stdout.flush()
+                sys.stderr.flush()
+                os._exit(min(rc, 255))
+        children[pid] = m
+    rc = 0
+    while children:
+        pid, status = os.wait()
+        m = children.pop(pid)
+        m.time = time.time() - start
+        code = os.WEXITSTATUS(status) if os.WIFEXITED(status) else 128 + os.WTERMSIG(status)
+        if code != 0:
+            print("{}: failed with exit code {}".format(m.backend, code), file=sys.stderr)
+            rc = rc or code
+
+    for m in members:
+        print("{}: {:.2f}s".format(m.backend, m.time))
+    return rc
+
+
+def _run_frontend(frontend, group):
+    """Runs the front end once for the backends in group, and makes them
+    start from its output; returns the exit code."""
+    first = group[0]
+    preprocessed = first.preprocessed[0]
+    snapshot = os.path.splitext(preprocessed)[0] + ".frontend.ir"
+    args = _split(first.backend._commands['compiler'])
+    cmd = [shlex.quote(frontend), "--validate", "--toIRSnapshot", shlex.quote(snapshot)]
+    cmd += [shlex.quote(a) for a in _options(args, FRONTEND_OPTIONS)]
+    cmd.append(shlex.quote(preprocessed))
+
+    start = time.time()
+    rc = first.backend.runCmd('frontend', cmd)
+    print("front end for {}: {:.2f}s".format(", ".join(str(m.backend) for m in group),
+                                              time.time() - start))
+    if rc != 0:
+        return rc
+
+    for index, m in enumerate(group):
+        args = _split(m.backend._commands['compiler'])
+        args = [a for a in args if os.path.realpath(a) != os.path.realpath(m.preprocessed[0])]
+        if index > 0:
+            args = _without_options(args, SHARED_OUTPUT_OPTIONS)
+        args += ["--fromJSON", snapshot]
+        m.backend._commands['compiler'] = [shlex.quote(a) for a in args]
+    return 0
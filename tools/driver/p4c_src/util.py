@@ -12,8 +12,11 @@
 # See the License for the specific language governing permissions and
 # limitations under the License.
 
+import array
 import inspect
 import os
+import socket
+import struct
 import sys
 
 # get the directory the python program is running from
@@ -94,3 +97,53 @@ def find_file(directory, filename, binary=True):
         dir = os.path.dirname(dir)
     print('File {} not found'.format(filename))
     sys.exit(1)
+
+# compile servers, see frontends/common/compileServer.h
+def find_compile_server(exe):
+    """
+    Returns the socket of a compile server for exe, if one was started in
+    the directory named by P4C_SERVER_DIR as <exe basename>.sock
+    """
+    server_dir = os.environ.get('P4C_SERVER_DIR')
+    if not server_dir:
+        return None
+    path = os.path.join(server_dir, os.path.basename(exe) + '.sock')
+    if os.path.exists(path):
+        return path
+    return None
+
+def run_on_compile_server(path, args):
+    """
+    Runs the command args on the compile server listening on path, with the
+    working directory, standard output and standard error of this process.
+    Returns the exit code of the command, or None if the server cannot be
+    reached and the command should be run directly.
+    """
+    sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+    try:
+        sock.connect(path)
+    except OSError:
+        sock.close()
+        return None
+    with sock:
+        sys.stdout.flush()
+        sys.stderr.flush()
+        payload = b''.join(os.fsencode(a) + b'\0' for a in [os.getcwd()] + list(args[1:]))
+        fds = array.array('i', [sys.stdout.fileno(), sys.stderr.fileno()])
+        try:
+            sock.sendmsg([struct.pack('=I', len(payload))],
+                         [(socket.SOL_SOCKET, socket.SCM_RIGHTS, fds)])
+            sock.sendall(payload)
+            reply = b''
+            while len(reply) < 4:
+                data = sock.recv(4 - len(reply))
+                if not data:
+                    break
+                reply += data
+        except OSError:
+            return None
+        # the server went away during the compilation
+        if len(reply) < 4:
+            print("{}: compile server exited".format(path), file=sys.stderr)
+            return 1
+        return struct.unpack('=i', reply)[0]
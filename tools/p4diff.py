@@ -0,0 +1,98 @@
+#!/usr/bin/env python3
+# Copyright 2013-present Barefoot Networks, Inc.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+""" Prints the program after a pass from the dumps written by the compiler
+    with --top4 <passes> --top4-diff (see frontends/p4/toP4/diffDump.h)."""
+
+import argparse
+import re
+import sys
+
+
+class Pass:
+    def __init__(self, name):
+        self.name = name
+        self.order = []
+        self.new_items = 0
+
+
+def read_stream(path):
+    """Returns the items (id -> (kind, text)) and the passes of a stream."""
+    with open(path, "rb") as f:
+        data = f.read()
+    items = {}
+    passes = []
+    pos = 0
+    while pos < len(data):
+        eol = data.index(b"\n", pos)
+        line = data[pos:eol].decode()
+        pos = eol + 1
+        if line.startswith("#@pass "):
+            passes.append(Pass(line[len("#@pass "):]))
+        elif line.startswith("#@item "):
+            _, ident, kind, length = line.split(" ")
+            end = pos + int(length)
+            items[int(ident)] = (kind, data[pos:end])
+            passes[-1].new_items += 1
+            pos = end + 1
+        elif line.startswith("#@order"):
+            passes[-1].order = [int(i) for i in line.split(" ")[1:]]
+        else:
+            raise ValueError("{}: unexpected line '{}'".format(path, line))
+    return items, passes
+
+
+def program_text(items, p):
+    """The text that ToP4 printed for the program after the pass p."""
+    text = b""
+    first = True
+    for ident in p.order:
+        kind, item = items[ident]
+        if kind == "decl" and not first:
+            text += b"\n"
+        text += item
+        first = False
+    if p.order and items[p.order[0]][0] != "node":
+        text += b"\n"
+    return text
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("stream", help="the .p4diff file written by the compiler")
+    parser.add_argument("--list", action="store_true",
+                        help="list the dumped passes and their number of new declarations")
+    parser.add_argument("--pass", dest="pass_regex", default=None,
+                        help="print the program after the first pass whose name matches "
+                             "this regular expression (default: the last pass)")
+    args = parser.parse_args()
+
+    items, passes = read_stream(args.stream)
+    if args.list:
+        for p in passes:
+            print("{} ({} new)".format(p.name, p.new_items))
+        return 0
+    selected = passes[-1:]
+    if args.pass_regex is not None:
+        selected = [p for p in passes if re.search(args.pass_regex, p.name)]
+    if not selected:
+        print("{}: no matching pass".format(args.stream), file=sys.stderr)
+        return 1
+    sys.stdout.buffer.write(program_text(items, selected[0]))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())